@@ -37,6 +37,7 @@
 #include "machuart.h"
 #include "mpexception.h"
 #include "moduos.h"
+#include "moduselect.h"
 #include "machpin.h"
 #include "pins.h"
 
@@ -207,11 +208,13 @@ STATIC IRAM_ATTR void UARTGenericIntHandler(uint32_t uart_id, uint32_t status) {
             }
             // clear the interrupt
             WRITE_PERI_REG(UART_INT_CLR_REG(uart_id), UART_RXFIFO_TOUT_INT_CLR | UART_RXFIFO_FULL_INT_ST);
+            select_notify_from_isr();
         } else if (UART_TXFIFO_EMPTY_INT_ST == (status & UART_TXFIFO_EMPTY_INT_ST)) {
             // Tx FIFO empty
             WRITE_PERI_REG(UART_INT_CLR_REG(uart_id), UART_TXFIFO_EMPTY_INT_CLR);
             // this one needs to be re-enabled every time we send
             CLEAR_PERI_REG_MASK(UART_INT_ENA_REG(uart_id), UART_TXFIFO_EMPTY_INT_ENA);
+            select_notify_from_isr();
         } else if (UART_RXFIFO_OVF_INT_ST == (status & UART_RXFIFO_OVF_INT_ST)) {
             WRITE_PERI_REG(UART_INT_CLR_REG(uart_id), UART_RXFIFO_OVF_INT_CLR);
         }
@@ -599,6 +602,9 @@ STATIC mp_uint_t mach_uart_ioctl(mp_obj_t self_in, mp_uint_t request, mp_uint_t
         if ((flags & MP_IOCTL_POLL_WR) && uart_tx_fifo_space(self)) {
             ret |= MP_IOCTL_POLL_WR;
         }
+    } else if (request == MP_IOCTL_POLL_NOTIFY) {
+        // the interrupt handler notifies when data arrives or the Tx FIFO empties
+        ret = 0;
     } else {
         *errcode = EINVAL;
         ret = MP_STREAM_ERROR;
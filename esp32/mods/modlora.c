@@ -25,6 +25,7 @@
 #include "radio.h"
 #include "modnetwork.h"
 #include "pybioctl.h"
+#include "moduselect.h"
 #include "modusocket.h"
 #include "pycom_config.h"
 
@@ -391,6 +392,7 @@ static IRAM_ATTR void McpsIndication (McpsIndication_t *mcpsIndication) {
                 memcpy((void *)rx_data_isr.data, mcpsIndication->Buffer, mcpsIndication->BufferSize);
                 rx_data_isr.len = mcpsIndication->BufferSize;
                 xQueueSendFromISR(xRxQueue, (void *)&rx_data_isr, NULL);
+                select_notify_from_isr();
             }
             // printf("Data on port 2 received\n");
             break;
@@ -466,6 +468,7 @@ static IRAM_ATTR void McpsIndication (McpsIndication_t *mcpsIndication) {
                             memcpy((void *)rx_data_isr.data, mcpsIndication->Buffer, mcpsIndication->BufferSize);
                             rx_data_isr.len = mcpsIndication->BufferSize;
                             xQueueSendFromISR(xRxQueue, (void *)&rx_data_isr, NULL);
+                            select_notify_from_isr();
                         }
                         // printf("Crypto message received\n");
                         break;
@@ -558,6 +561,8 @@ static void TASK_LoRa (void *pvParameters) {
         case E_LORA_STATE_SLEEP:
             // receive from the command queue and act accordingly
             if (xQueueReceive(xCmdQueue, &cmd_data, 0)) {
+                // there's room for another command now
+                select_notify();
                 switch (cmd_data.cmd) {
                 case E_LORA_CMD_INIT:
                     lora_obj.stack_mode = cmd_data.info.init.stack_mode;
@@ -782,6 +787,7 @@ static IRAM_ATTR void OnRxDone (uint8_t *payload, uint16_t size, int16_t rssi, i
         memcpy((void *)rx_data_isr.data, payload, size);
         rx_data_isr.len = size;
         xQueueSendFromISR(xRxQueue, (void *)&rx_data_isr, NULL);
+        select_notify_from_isr();
     }
 }
 
@@ -1607,6 +1613,9 @@ static int lora_socket_ioctl (mod_network_socket_obj_t *s, mp_uint_t request, mp
         if ((flags & MP_IOCTL_POLL_WR) && lora_tx_space()) {
             ret |= MP_IOCTL_POLL_WR;
         }
+    } else if (request == MP_IOCTL_POLL_NOTIFY) {
+        // received packets and free command slots are notified
+        ret = 0;
     } else {
         *_errno = EINVAL;
         ret = MP_STREAM_ERROR;
@@ -14,13 +14,36 @@
 #include "py/nlr.h"
 #include "py/obj.h"
 #include "py/objlist.h"
+#include "py/objtuple.h"
 #include "py/mperrno.h"
 #include "py/mphal.h"
+#include "py/runtime.h"
+#include "py/stream.h"
 #include "pybioctl.h"
+#include "moduselect.h"
+
+#include "esp_attr.h"
+#include "lwip/sockets.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
 
 // Flags for poll()
 #define FLAG_ONESHOT (1)
 
+// Each task waiting in select or poll takes one of these bits of the event
+// group, and select_notify() sets all of them, so that a task clearing its
+// own bit can't lose a notification meant for another
+#define SELECT_EVENT_BITS           (0x00ffffff)
+
+// How often objects that don't notify are polled, the longest lwIP's
+// select() waits on sockets while notifying objects are registered too, and
+// the longest it waits otherwise, so that a KeyboardInterrupt is seen
+#define SELECT_POLL_INTERVAL_MS     (1)
+#define SELECT_SOCKET_SLICE_MS      (10)
+#define SELECT_INTERRUPT_SLICE_MS   (100)
+
 /// \module select - Provides select function to wait for events on a stream
 ///
 /// This module provides the select function.
@@ -96,6 +119,163 @@ STATIC mp_uint_t poll_map_poll(mp_map_t *poll_map, mp_uint_t *rwx_num) {
     return n_ready;
 }
 
+STATIC EventGroupHandle_t select_events;
+STATIC uint32_t select_bits_used;
+
+void select_init0(void) {
+    if (select_events == NULL) {
+        select_events = xEventGroupCreate();
+    }
+}
+
+// Wake the tasks waiting in select or poll, so that they poll their objects
+void select_notify(void) {
+    if (select_events != NULL) {
+        xEventGroupSetBits(select_events, SELECT_EVENT_BITS);
+    }
+}
+
+void IRAM_ATTR select_notify_from_isr(void) {
+    if (select_events != NULL) {
+        xEventGroupSetBitsFromISR(select_events, SELECT_EVENT_BITS, NULL);
+    }
+}
+
+// Returns a free event bit, or 0 if all are taken.  Only called with the GIL
+// held, which serialises it.
+STATIC uint32_t select_take_bit(void) {
+    uint32_t free_bits = SELECT_EVENT_BITS & ~select_bits_used;
+    uint32_t bit = free_bits & -free_bits;
+    select_bits_used |= bit;
+    return bit;
+}
+
+STATIC void select_give_bit(uint32_t bit) {
+    select_bits_used &= ~bit;
+}
+
+STATIC TickType_t select_ms_to_ticks(mp_uint_t ms) {
+    if (ms == (mp_uint_t)-1) {
+        return portMAX_DELAY;
+    }
+    return (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+}
+
+// Sleep for at most wait_ms (-1 for no limit), until one of the objects in
+// the map may have become ready
+STATIC void select_sleep(mp_map_t *poll_map, uint32_t bit, mp_uint_t wait_ms) {
+    fd_set rfds, wfds, xfds;
+    FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
+    FD_ZERO(&xfds);
+    int maxfd = -1;
+    bool notifying = false;
+    bool polled = (bit == 0);
+
+    for (mp_uint_t i = 0; i < poll_map->alloc; ++i) {
+        if (!MP_MAP_SLOT_IS_FILLED(poll_map, i)) {
+            continue;
+        }
+        poll_obj_t *poll_obj = (poll_obj_t*)poll_map->table[i].value;
+        if (poll_obj->flags == 0) {
+            // nothing to wait for
+            continue;
+        }
+        int errcode;
+        mp_int_t fd = poll_obj->ioctl(poll_obj->obj, MP_IOCTL_POLL_FD, 0, &errcode);
+        if (fd >= 0 && fd < FD_SETSIZE) {
+            if (poll_obj->flags & MP_IOCTL_POLL_RD) {
+                FD_SET(fd, &rfds);
+            }
+            if (poll_obj->flags & MP_IOCTL_POLL_WR) {
+                FD_SET(fd, &wfds);
+            }
+            if (poll_obj->flags & (MP_IOCTL_POLL_ERR | MP_IOCTL_POLL_HUP)) {
+                FD_SET(fd, &xfds);
+            }
+            if (fd > maxfd) {
+                maxfd = fd;
+            }
+        } else if (poll_obj->ioctl(poll_obj->obj, MP_IOCTL_POLL_NOTIFY, 0, &errcode) == 0) {
+            notifying = true;
+        } else {
+            polled = true;
+        }
+    }
+
+    if (polled) {
+        // some object can only be polled, so check again soon
+        if (wait_ms > SELECT_POLL_INTERVAL_MS) {
+            wait_ms = SELECT_POLL_INTERVAL_MS;
+        }
+        maxfd = -1;
+    } else if (maxfd >= 0) {
+        // lwIP's select() can't be woken by the other objects, nor by a
+        // KeyboardInterrupt, which poll_map_wait checks for between slices
+        mp_uint_t slice_ms = notifying ? SELECT_SOCKET_SLICE_MS : SELECT_INTERRUPT_SLICE_MS;
+        if (wait_ms > slice_ms) {
+            wait_ms = slice_ms;
+        }
+    }
+
+    MP_THREAD_GIL_EXIT();
+    if (maxfd >= 0) {
+        struct timeval tv;
+        tv.tv_sec = wait_ms / 1000;
+        tv.tv_usec = (wait_ms % 1000) * 1000;
+        // errors show up when the sockets are polled again
+        lwip_select(maxfd + 1, &rfds, &wfds, &xfds, &tv);
+    } else if (bit != 0) {
+        xEventGroupWaitBits(select_events, bit, pdTRUE, pdFALSE, select_ms_to_ticks(wait_ms));
+    } else {
+        vTaskDelay(select_ms_to_ticks(wait_ms));
+    }
+    MP_THREAD_GIL_ENTER();
+}
+
+// Poll the objects in the map until one is ready or the timeout (in ms, -1
+// for none) expires, sleeping in between.  Returns the number of ready
+// objects, with their events in flags_ret.
+STATIC mp_uint_t poll_map_wait(mp_map_t *poll_map, mp_uint_t *rwx_num, mp_uint_t timeout) {
+    uint32_t bit = select_take_bit();
+    mp_uint_t start_tick = mp_hal_ticks_ms();
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_uint_t n_ready;
+        for (;;) {
+            // clear our bit before polling, so a notification that arrives
+            // from now on ends the sleep below
+            if (bit != 0) {
+                xEventGroupClearBits(select_events, bit);
+            }
+            if (rwx_num != NULL) {
+                rwx_num[0] = rwx_num[1] = rwx_num[2] = 0;
+            }
+            n_ready = poll_map_poll(poll_map, rwx_num);
+            mp_uint_t elapsed = mp_hal_ticks_ms() - start_tick;
+            if (n_ready > 0 || (timeout != -1 && elapsed >= timeout)) {
+                break;
+            }
+
+            // let a KeyboardInterrupt out of an endless wait
+            mp_obj_t exc = MP_STATE_VM(mp_pending_exception);
+            if (exc != MP_OBJ_NULL) {
+                MP_STATE_VM(mp_pending_exception) = MP_OBJ_NULL;
+                nlr_raise(exc);
+            }
+
+            select_sleep(poll_map, bit, (timeout == -1) ? timeout : timeout - elapsed);
+        }
+        nlr_pop();
+        select_give_bit(bit);
+        return n_ready;
+    } else {
+        select_give_bit(bit);
+        nlr_jump(nlr.ret_val);
+    }
+}
+
 /// \function select(rlist, wlist, xlist[, timeout])
 STATIC mp_obj_t select_select(uint n_args, const mp_obj_t *args) {
     // get array data from tuple/list arguments
@@ -127,39 +307,31 @@ STATIC mp_obj_t select_select(uint n_args, const mp_obj_t *args) {
     poll_map_add(&poll_map, w_array, rwx_len[1], MP_IOCTL_POLL_WR, true);
     poll_map_add(&poll_map, x_array, rwx_len[2], MP_IOCTL_POLL_ERR | MP_IOCTL_POLL_HUP, true);
 
-    mp_uint_t start_tick = mp_hal_ticks_ms();
+    poll_map_wait(&poll_map, rwx_len, timeout);
+
+    // build the lists of ready objects
+    mp_obj_t list_array[3];
+    list_array[0] = mp_obj_new_list(rwx_len[0], NULL);
+    list_array[1] = mp_obj_new_list(rwx_len[1], NULL);
+    list_array[2] = mp_obj_new_list(rwx_len[2], NULL);
     rwx_len[0] = rwx_len[1] = rwx_len[2] = 0;
-    for (;;) {
-        // poll the objects
-        mp_uint_t n_ready = poll_map_poll(&poll_map, rwx_len);
-
-        if (n_ready > 0 || (timeout != -1 && mp_hal_ticks_ms() - start_tick >= timeout)) {
-            // one or more objects are ready, or we had a timeout
-            mp_obj_t list_array[3];
-            list_array[0] = mp_obj_new_list(rwx_len[0], NULL);
-            list_array[1] = mp_obj_new_list(rwx_len[1], NULL);
-            list_array[2] = mp_obj_new_list(rwx_len[2], NULL);
-            rwx_len[0] = rwx_len[1] = rwx_len[2] = 0;
-            for (mp_uint_t i = 0; i < poll_map.alloc; ++i) {
-                if (!MP_MAP_SLOT_IS_FILLED(&poll_map, i)) {
-                    continue;
-                }
-                poll_obj_t *poll_obj = (poll_obj_t*)poll_map.table[i].value;
-                if (poll_obj->flags_ret & MP_IOCTL_POLL_RD) {
-                    ((mp_obj_list_t*)list_array[0])->items[rwx_len[0]++] = poll_obj->obj;
-                }
-                if (poll_obj->flags_ret & MP_IOCTL_POLL_WR) {
-                    ((mp_obj_list_t*)list_array[1])->items[rwx_len[1]++] = poll_obj->obj;
-                }
-                if ((poll_obj->flags_ret & ~(MP_IOCTL_POLL_RD | MP_IOCTL_POLL_WR)) != 0) {
-                    ((mp_obj_list_t*)list_array[2])->items[rwx_len[2]++] = poll_obj->obj;
-                }
-            }
-            mp_map_deinit(&poll_map);
-            return mp_obj_new_tuple(3, list_array);
+    for (mp_uint_t i = 0; i < poll_map.alloc; ++i) {
+        if (!MP_MAP_SLOT_IS_FILLED(&poll_map, i)) {
+            continue;
+        }
+        poll_obj_t *poll_obj = (poll_obj_t*)poll_map.table[i].value;
+        if (poll_obj->flags_ret & MP_IOCTL_POLL_RD) {
+            ((mp_obj_list_t*)list_array[0])->items[rwx_len[0]++] = poll_obj->obj;
+        }
+        if (poll_obj->flags_ret & MP_IOCTL_POLL_WR) {
+            ((mp_obj_list_t*)list_array[1])->items[rwx_len[1]++] = poll_obj->obj;
+        }
+        if ((poll_obj->flags_ret & ~(MP_IOCTL_POLL_RD | MP_IOCTL_POLL_WR)) != 0) {
+            ((mp_obj_list_t*)list_array[2])->items[rwx_len[2]++] = poll_obj->obj;
         }
-        mp_hal_delay_ms(1);
     }
+    mp_map_deinit(&poll_map);
+    return mp_obj_new_tuple(3, list_array);
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_select_select_obj, 3, 4, select_select);
 
@@ -168,6 +340,11 @@ MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_select_select_obj, 3, 4, select_select);
 typedef struct _mp_obj_poll_t {
     mp_obj_base_t base;
     mp_map_t poll_map;
+    short iter_cnt;
+    short iter_idx;
+    int flags;
+    // callee-owned tuple returned by ipoll
+    mp_obj_t ret_tuple;
 } mp_obj_poll_t;
 
 /// \method register(obj[, eventmask])
@@ -205,14 +382,13 @@ STATIC mp_obj_t poll_modify(mp_obj_t self_in, mp_obj_t obj_in, mp_obj_t eventmas
 }
 MP_DEFINE_CONST_FUN_OBJ_3(poll_modify_obj, poll_modify);
 
-/// \method poll([timeout])
-/// Timeout is in milliseconds.
-STATIC mp_obj_t poll_poll(uint n_args, const mp_obj_t *args) {
+// work out the timeout (it's given already in ms) and flags of poll or
+// ipoll, then wait for the objects; returns the number ready
+STATIC mp_uint_t poll_poll_internal(uint n_args, const mp_obj_t *args) {
     mp_obj_poll_t *self = args[0];
 
-    // work out timeout (its given already in ms)
     mp_uint_t timeout = -1;
-    int flags = 0;
+    self->flags = 0;
     if (n_args >= 2) {
         if (args[1] != mp_const_none) {
             mp_int_t timeout_i = mp_obj_get_int(args[1]);
@@ -221,51 +397,102 @@ STATIC mp_obj_t poll_poll(uint n_args, const mp_obj_t *args) {
             }
         }
         if (n_args >= 3) {
-            flags = mp_obj_get_int(args[2]);
+            self->flags = mp_obj_get_int(args[2]);
         }
     }
 
-    mp_uint_t start_tick = mp_hal_ticks_ms();
-    for (;;) {
-        // poll the objects
-        mp_uint_t n_ready = poll_map_poll(&self->poll_map, NULL);
-
-        if (n_ready > 0 || (timeout != -1 && mp_hal_ticks_ms() - start_tick >= timeout)) {
-            // one or more objects are ready, or we had a timeout
-            mp_obj_list_t *ret_list = mp_obj_new_list(n_ready, NULL);
-            n_ready = 0;
-            for (mp_uint_t i = 0; i < self->poll_map.alloc; ++i) {
-                if (!MP_MAP_SLOT_IS_FILLED(&self->poll_map, i)) {
-                    continue;
-                }
-                poll_obj_t *poll_obj = (poll_obj_t*)self->poll_map.table[i].value;
-                if (poll_obj->flags_ret != 0) {
-                    mp_obj_t tuple[2] = {poll_obj->obj, MP_OBJ_NEW_SMALL_INT(poll_obj->flags_ret)};
-                    ret_list->items[n_ready++] = mp_obj_new_tuple(2, tuple);
-                    if (flags & FLAG_ONESHOT) {
-                        // Don't poll next time, until new event flags will be set explicitly
-                        poll_obj->flags = 0;
-                    }
-                }
+    return poll_map_wait(&self->poll_map, NULL, timeout);
+}
+
+/// \method poll([timeout])
+/// Timeout is in milliseconds.
+STATIC mp_obj_t poll_poll(uint n_args, const mp_obj_t *args) {
+    mp_obj_poll_t *self = args[0];
+    mp_uint_t n_ready = poll_poll_internal(n_args, args);
+
+    mp_obj_list_t *ret_list = mp_obj_new_list(n_ready, NULL);
+    n_ready = 0;
+    for (mp_uint_t i = 0; i < self->poll_map.alloc; ++i) {
+        if (!MP_MAP_SLOT_IS_FILLED(&self->poll_map, i)) {
+            continue;
+        }
+        poll_obj_t *poll_obj = (poll_obj_t*)self->poll_map.table[i].value;
+        if (poll_obj->flags_ret != 0) {
+            mp_obj_t tuple[2] = {poll_obj->obj, MP_OBJ_NEW_SMALL_INT(poll_obj->flags_ret)};
+            ret_list->items[n_ready++] = mp_obj_new_tuple(2, tuple);
+            if (self->flags & FLAG_ONESHOT) {
+                // Don't poll next time, until new event flags will be set explicitly
+                poll_obj->flags = 0;
             }
-            return ret_list;
         }
-        mp_hal_delay_ms(1);
     }
+    return ret_list;
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_poll_obj, 1, 3, poll_poll);
 
+/// \method ipoll([timeout[, flags]])
+/// Like poll, but returns an iterator which yields the same tuple each time,
+/// updated for the next ready object, so nothing is allocated per call.
+STATIC mp_obj_t poll_ipoll(uint n_args, const mp_obj_t *args) {
+    mp_obj_poll_t *self = args[0];
+
+    if (self->ret_tuple == MP_OBJ_NULL) {
+        self->ret_tuple = mp_obj_new_tuple(2, NULL);
+    }
+
+    self->iter_cnt = poll_poll_internal(n_args, args);
+    self->iter_idx = 0;
+
+    return self;
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_ipoll_obj, 1, 3, poll_ipoll);
+
+STATIC mp_obj_t poll_iternext(mp_obj_t self_in) {
+    mp_obj_poll_t *self = self_in;
+
+    if (self->iter_cnt == 0) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+
+    self->iter_cnt--;
+
+    for (mp_uint_t i = self->iter_idx; i < self->poll_map.alloc; ++i) {
+        self->iter_idx++;
+        if (!MP_MAP_SLOT_IS_FILLED(&self->poll_map, i)) {
+            continue;
+        }
+        poll_obj_t *poll_obj = (poll_obj_t*)self->poll_map.table[i].value;
+        if (poll_obj->flags_ret != 0) {
+            mp_obj_tuple_t *t = self->ret_tuple;
+            t->items[0] = poll_obj->obj;
+            t->items[1] = MP_OBJ_NEW_SMALL_INT(poll_obj->flags_ret);
+            if (self->flags & FLAG_ONESHOT) {
+                // Don't poll next time, until new event flags will be set explicitly
+                poll_obj->flags = 0;
+            }
+            return t;
+        }
+    }
+
+    // the map was changed while iterating
+    self->iter_cnt = 0;
+    return MP_OBJ_STOP_ITERATION;
+}
+
 STATIC const mp_map_elem_t poll_locals_dict_table[] = {
     { MP_OBJ_NEW_QSTR(MP_QSTR_register), (mp_obj_t)&poll_register_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_unregister), (mp_obj_t)&poll_unregister_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_modify), (mp_obj_t)&poll_modify_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_poll), (mp_obj_t)&poll_poll_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_ipoll), (mp_obj_t)&poll_ipoll_obj },
 };
 STATIC MP_DEFINE_CONST_DICT(poll_locals_dict, poll_locals_dict_table);
 
 STATIC const mp_obj_type_t mp_type_poll = {
     { &mp_type_type },
     .name = MP_QSTR_poll,
+    .getiter = mp_identity,
+    .iternext = poll_iternext,
     .locals_dict = (mp_obj_t)&poll_locals_dict,
 };
 
@@ -274,6 +501,8 @@ STATIC mp_obj_t select_poll(void) {
     mp_obj_poll_t *poll = m_new_obj(mp_obj_poll_t);
     poll->base.type = &mp_type_poll;
     mp_map_init(&poll->poll_map, 0);
+    poll->iter_cnt = 0;
+    poll->ret_tuple = MP_OBJ_NULL;
     return poll;
 }
 MP_DEFINE_CONST_FUN_OBJ_0(mp_select_poll_obj, select_poll);
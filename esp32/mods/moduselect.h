@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2017, Pycom Limited.
+ *
+ * This software is licensed under the GNU GPL version 3 or any
+ * later version, with permitted additional terms. For more information
+ * see the Pycom Licence v1.0 document supplied with this file, or
+ * available at https://www.pycom.io/opensource/licensing
+ */
+
+#ifndef MODUSELECT_H_
+#define MODUSELECT_H_
+
+// ioctl requests used by select and poll besides MP_IOCTL_POLL.  An object
+// that answers MP_IOCTL_POLL_NOTIFY with 0 calls select_notify() or
+// select_notify_from_isr() whenever it may have become ready, so that poll
+// can sleep until then.  MP_IOCTL_POLL_FD returns the lwIP socket behind an
+// object, which poll can wait on with lwIP's select().
+#define MP_IOCTL_POLL_NOTIFY    (0x100 | 2)
+#define MP_IOCTL_POLL_FD        (0x100 | 3)
+
+extern void select_init0(void);
+extern void select_notify(void);
+extern void select_notify_from_isr(void);
+
+#endif  // MODUSELECT_H_
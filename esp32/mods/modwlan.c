@@ -35,6 +35,7 @@
 #include "modusocket.h"
 #include "modwlan.h"
 #include "pybioctl.h"
+#include "moduselect.h"
 //#include "pybrtc.h"
 #include "serverstask.h"
 #include "mpexception.h"
@@ -1383,6 +1384,9 @@ static int wlan_socket_ioctl (mod_network_socket_obj_t *s, mp_uint_t request, mp
         if (FD_ISSET(sd, &xfds)) {
             ret |= MP_IOCTL_POLL_HUP;
         }
+    } else if (request == MP_IOCTL_POLL_FD) {
+        // poll can wait for the socket with select() itself
+        ret = s->sock_base.sd;
     } else {
         *_errno = EINVAL;
         ret = MP_STREAM_ERROR;
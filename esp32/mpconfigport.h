@@ -31,23 +31,27 @@
 #define MICROPY_CAN_OVERRIDE_BUILTINS               (1)
 #define MICROPY_PY_BUILTINS_COMPLEX                 (1)
 #define MICROPY_PY_BUILTINS_STR_UNICODE             (1)
+#define MICROPY_PY_BUILTINS_STR_LAZY_CONCAT         (1)
 #define MICROPY_PY_BUILTINS_BYTEARRAY               (1)
 #define MICROPY_PY_BUILTINS_MEMORYVIEW              (1)
 #define MICROPY_PY_BUILTINS_FROZENSET               (1)
 #define MICROPY_PY_BUILTINS_SET                     (1)
 #define MICROPY_PY_BUILTINS_SLICE                   (1)
 #define MICROPY_PY_BUILTINS_PROPERTY                (1)
+#define MICROPY_PY_BUILTINS_POW3                    (1)
 #define MICROPY_PY_BUILTINS_EXECFILE                (1)
 #define MICROPY_PY___FILE__                         (1)
 #define MICROPY_PY_GC                               (1)
 #define MICROPY_PY_ARRAY                            (1)
 #define MICROPY_PY_ARRAY_SLICE_ASSIGN               (1)
+#define MICROPY_PY_ARRAY_OPS                        (1)
 #define MICROPY_PY_COLLECTIONS                      (1)
 #define MICROPY_PY_MATH                             (1)
 #define MICROPY_PY_CMATH                            (1)
 #define MICROPY_PY_IO                               (1)
 #define MICROPY_PY_IO_FILEIO                        (1)
 #define MICROPY_PY_STRUCT                           (1)
+#define MICROPY_PY_STRUCT_STRUCT                    (1)
 #define MICROPY_PY_SYS                              (1)
 #define MICROPY_PY_THREAD                           (1)
 #define MICROPY_PY_THREAD_GIL                       (1)
@@ -56,12 +60,16 @@
 #define MICROPY_PY_SYS_EXIT                         (1)
 #define MICROPY_PY_SYS_STDFILES                     (1)
 #define MICROPY_PY_UBINASCII                        (1)
+#define MICROPY_PY_UBINASCII_INTO                   (1)
+#define MICROPY_PY_UBINASCII_CRC                    (1)
 #define MICROPY_PY_UERRNO                           (1)
 #define MICROPY_PY_UCTYPES                          (1)
 #define MICROPY_PY_UHASHLIB                         (0)
 #define MICROPY_PY_UHASHLIB_SHA1                    (0)
 #define MICROPY_PY_UJSON                            (1)
 #define MICROPY_PY_URE                              (1)
+#define MICROPY_PY_URE_LINEAR                       (1)
+#define MICROPY_PY_URE_SUB                          (1)
 #define MICROPY_PY_MACHINE                          (1)
 #define MICROPY_PY_MICROPYTHON_MEM_INFO             (1)
 #define MICROPY_CPYTHON_COMPAT                      (1)
@@ -71,6 +79,7 @@
 #define MICROPY_MODULE_FROZEN                       (0)
 #define MICROPY_OPT_COMPUTED_GOTO                   (1)
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE    (0)
+#define MICROPY_OPT_MPZ_KARATSUBA                   (1)
 #define MICROPY_REPL_AUTO_INDENT                    (1)
 #define MICROPY_COMP_MODULE_CONST                   (1)
 #define MICROPY_ENABLE_FINALISER                    (1)
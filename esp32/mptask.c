@@ -51,6 +51,7 @@
 #include "machrtc.h"
 #include "modbt.h"
 #include "machtimer.h"
+#include "moduselect.h"
 #include "mptask.h"
 #include "machtimer.h"
 
@@ -160,6 +161,7 @@ soft_reset:
     mpsleep_init0();
     mp_irq_init0();
     moduos_init0();
+    select_init0();
     uart_init0();
     mperror_init0();
     rng_init0();
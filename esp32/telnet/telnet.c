@@ -25,6 +25,7 @@
 #include "modnetwork.h"
 //#include "modwlan.h"
 #include "modusocket.h"
+#include "moduselect.h"
 //#include "debug.h"
 #include "mpexception.h"
 #include "serverstask.h"
@@ -535,6 +536,8 @@ static void telnet_parse_input (uint8_t *str, int32_t *len) {
         if (ch > 127 || ch == 0 || (telnet_data.state == E_TELNET_STE_LOGGED_IN && ch == user_interrupt_char)) {
             if (ch == user_interrupt_char) {
                 mpexception_keyboard_nlr_jump();
+                // end a poll or select that is sleeping
+                select_notify();
             }
             // skip this char
             (*len)--;
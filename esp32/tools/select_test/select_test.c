@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2017, Pycom Limited.
+ *
+ * This software is licensed under the GNU GPL version 3 or any
+ * later version, with permitted additional terms. For more information
+ * see the Pycom Licence v1.0 document supplied with this file, or
+ * available at https://www.pycom.io/opensource/licensing
+ */
+
+// Host test double for the wakeups of esp32/mods/moduselect.c.
+//
+// The module is built against the unix port's core, with the FreeRTOS event
+// group emulated on pthreads, lwIP's select() mapped to the host's, and fake
+// objects that notify, that can only be polled, or that stand for a socket
+// with a pipe behind it.  It checks that waits end on a notification, on a
+// ready socket and on their timeout, that each waiter's event bit is its own
+// and is given back, also when an exception ends the wait, and that a
+// KeyboardInterrupt ends an endless wait.
+//
+// Build the unix port first, then run "make" here.  Prints one line per
+// check and exits with a non-zero status if any fails, or if it hangs.
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+// the unix port calls the module uselect, and has no ipoll qstr
+#define MP_QSTR_select MP_QSTR_uselect
+
+#include "../../mods/moduselect.c"
+#include "py/gc.h"
+#include "py/lexer.h"
+#include "py/stackctrl.h"
+#include "py/mpthread.h"
+
+/******************************************************************************
+ FreeRTOS event group and tasks on pthreads
+ ******************************************************************************/
+
+STATIC pthread_mutex_t eg_mutex = PTHREAD_MUTEX_INITIALIZER;
+STATIC pthread_cond_t eg_cond = PTHREAD_COND_INITIALIZER;
+STATIC EventBits_t eg_bits;
+STATIC int eg_waits;
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    return &eg_bits;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&eg_mutex);
+    eg_bits |= bits;
+    pthread_cond_broadcast(&eg_cond);
+    pthread_mutex_unlock(&eg_mutex);
+    return bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t *woken) {
+    xEventGroupSetBits(group, bits);
+    return pdTRUE;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&eg_mutex);
+    EventBits_t old = eg_bits;
+    eg_bits &= ~bits;
+    pthread_mutex_unlock(&eg_mutex);
+    return old;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear, BaseType_t all, TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000;
+    ts.tv_sec += ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    pthread_mutex_lock(&eg_mutex);
+    eg_waits++;
+    while (!(eg_bits & bits)) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&eg_cond, &eg_mutex);
+        } else if (pthread_cond_timedwait(&eg_cond, &eg_mutex, &ts) != 0) {
+            break;
+        }
+    }
+    EventBits_t ret = eg_bits;
+    if (clear) {
+        eg_bits &= ~bits;
+    }
+    pthread_mutex_unlock(&eg_mutex);
+    return ret;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    usleep(ticks * portTICK_PERIOD_MS * 1000);
+}
+
+int lwip_select(int nfds, fd_set *rfds, fd_set *wfds, fd_set *xfds, struct timeval *tv) {
+    return select(nfds, rfds, wfds, xfds, tv);
+}
+
+/******************************************************************************
+ Fake objects
+ ******************************************************************************/
+
+typedef enum { SRC_NOTIFY, SRC_POLLED, SRC_SOCKET, SRC_BROKEN } src_kind_t;
+
+typedef struct _src_obj_t {
+    mp_obj_base_t base;
+    src_kind_t kind;
+    volatile int ready;
+    int fd; // for a socket, the read end of a pipe
+    int wfd; // and the end to write to
+} src_obj_t;
+
+STATIC mp_uint_t src_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    src_obj_t *self = self_in;
+    if (request == MP_IOCTL_POLL) {
+        if (self->kind == SRC_BROKEN) {
+            *errcode = MP_EIO;
+            return MP_STREAM_ERROR;
+        }
+        if (self->kind == SRC_SOCKET) {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            FD_SET(self->fd, &rfds);
+            struct timeval tv = {0, 0};
+            return select(self->fd + 1, &rfds, NULL, NULL, &tv) > 0 ? (arg & MP_IOCTL_POLL_RD) : 0;
+        }
+        return self->ready & arg;
+    }
+    if (request == MP_IOCTL_POLL_NOTIFY && self->kind == SRC_NOTIFY) {
+        return 0;
+    }
+    if (request == MP_IOCTL_POLL_FD && self->kind == SRC_SOCKET) {
+        return self->fd;
+    }
+    *errcode = MP_EINVAL;
+    return MP_STREAM_ERROR;
+}
+
+STATIC const mp_stream_p_t src_stream_p = {
+    .ioctl = src_ioctl,
+};
+
+STATIC const mp_obj_type_t src_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_poll,
+    .protocol = &src_stream_p,
+};
+
+STATIC src_obj_t *src_new(src_kind_t kind) {
+    src_obj_t *self = m_new_obj(src_obj_t);
+    self->base.type = &src_type;
+    self->kind = kind;
+    self->ready = 0;
+    self->fd = -1;
+    self->wfd = -1;
+    if (kind == SRC_SOCKET) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            abort();
+        }
+        self->fd = fds[0];
+        self->wfd = fds[1];
+    }
+    return self;
+}
+
+// What a thread does to an object after a delay
+typedef enum { EV_NOTIFY, EV_NOTIFY_FROM_ISR, EV_SEND, EV_INTERRUPT } event_kind_t;
+
+typedef struct _event_t {
+    event_kind_t kind;
+    int delay_ms;
+    src_obj_t *src;
+    mp_obj_t exc;
+    pthread_t thread;
+} event_t;
+
+STATIC void *event_thread(void *arg) {
+    event_t *ev = arg;
+    usleep(ev->delay_ms * 1000);
+    switch (ev->kind) {
+        case EV_NOTIFY:
+            ev->src->ready = MP_IOCTL_POLL_RD;
+            select_notify();
+            break;
+        case EV_NOTIFY_FROM_ISR:
+            ev->src->ready = MP_IOCTL_POLL_RD;
+            select_notify_from_isr();
+            break;
+        case EV_SEND:
+            if (write(ev->src->wfd, "x", 1) != 1) {
+                abort();
+            }
+            break;
+        case EV_INTERRUPT:
+            // as mpexception_keyboard_nlr_jump and then telnet, if src is set
+            MP_STATE_VM(mp_pending_exception) = ev->exc;
+            if (ev->src != NULL) {
+                select_notify();
+            }
+            break;
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ Checks
+ ******************************************************************************/
+
+STATIC int n_failed;
+
+STATIC void check(bool ok, const char *what) {
+    printf("%s: %s\n", ok ? "pass" : "FAIL", what);
+    if (!ok) {
+        n_failed++;
+    }
+}
+
+STATIC double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+typedef struct _wait_result_t {
+    int n_ready;
+    double elapsed_ms;
+    int eg_waits;
+    bool tuple_reused;
+    mp_obj_t exc;
+} wait_result_t;
+
+// Register the objects, start the event if any and wait with ipoll
+STATIC wait_result_t wait(src_obj_t **srcs, size_t n, event_t *ev, mp_int_t timeout) {
+    wait_result_t res = { 0, 0, 0, true, MP_OBJ_NULL };
+    mp_obj_t poll = select_poll();
+    for (size_t i = 0; i < n; i++) {
+        mp_obj_t args[3] = { poll, srcs[i], MP_OBJ_NEW_SMALL_INT(MP_IOCTL_POLL_RD) };
+        poll_register(3, args);
+    }
+    if (ev != NULL) {
+        pthread_create(&ev->thread, NULL, event_thread, ev);
+    }
+    eg_waits = 0;
+    double start = now_ms();
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t args[2] = { poll, MP_OBJ_NEW_SMALL_INT(timeout) };
+        mp_obj_t iter = poll_ipoll(2, args);
+        mp_obj_t first = MP_OBJ_NULL, item;
+        while ((item = poll_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+            if (first == MP_OBJ_NULL) {
+                first = item;
+            } else if (item != first) {
+                res.tuple_reused = false;
+            }
+            res.n_ready++;
+        }
+        nlr_pop();
+    } else {
+        res.exc = nlr.ret_val;
+    }
+    res.elapsed_ms = now_ms() - start;
+    res.eg_waits = eg_waits;
+    if (ev != NULL) {
+        pthread_join(ev->thread, NULL);
+    }
+    return res;
+}
+
+// Whether an elapsed time is what was expected, allowing for scheduling
+STATIC bool took(const wait_result_t *res, double ms) {
+    return res->elapsed_ms >= ms - 1 && res->elapsed_ms < ms + 150;
+}
+
+int main(void) {
+    static char heap[1 << 20];
+    // a wait that never ends fails the test too
+    alarm(10);
+    #if MICROPY_PY_THREAD
+    mp_thread_init();
+    #endif
+    mp_stack_ctrl_init();
+    gc_init(heap, heap + sizeof(heap));
+    mp_init();
+    select_init0();
+
+    {
+        src_obj_t *srcs[2] = { src_new(SRC_NOTIFY), src_new(SRC_NOTIFY) };
+        event_t ev = { EV_NOTIFY_FROM_ISR, 200, srcs[1] };
+        wait_result_t res = wait(srcs, 2, &ev, 1000);
+        check(res.n_ready == 1 && took(&res, 200) && res.eg_waits == 1,
+            "a notification from an ISR ends the wait, which sleeps once");
+    }
+    {
+        src_obj_t *srcs[2] = { src_new(SRC_NOTIFY), src_new(SRC_NOTIFY) };
+        wait_result_t res = wait(srcs, 2, NULL, 150);
+        check(res.n_ready == 0 && took(&res, 150) && res.eg_waits == 1,
+            "the wait times out when nothing happens");
+    }
+    {
+        src_obj_t *srcs[2] = { src_new(SRC_NOTIFY), src_new(SRC_POLLED) };
+        event_t ev = { EV_NOTIFY, 100, srcs[0] };
+        wait_result_t res = wait(srcs, 2, &ev, 1000);
+        check(res.n_ready == 1 && took(&res, 100) && res.eg_waits > 1,
+            "objects that can't notify are polled");
+    }
+    {
+        src_obj_t *srcs[1] = { src_new(SRC_SOCKET) };
+        event_t ev = { EV_SEND, 120, srcs[0] };
+        wait_result_t res = wait(srcs, 1, &ev, -1);
+        check(res.n_ready == 1 && took(&res, 120) && res.eg_waits == 0,
+            "a socket ends an endless wait in lwip_select");
+    }
+    {
+        src_obj_t *srcs[2] = { src_new(SRC_NOTIFY), src_new(SRC_SOCKET) };
+        event_t ev = { EV_NOTIFY, 100, srcs[0] };
+        wait_result_t res = wait(srcs, 2, &ev, 1000);
+        check(res.n_ready == 1 && took(&res, 100),
+            "a notification ends a wait on sockets too");
+    }
+    {
+        src_obj_t *srcs[2] = { src_new(SRC_NOTIFY), src_new(SRC_NOTIFY) };
+        srcs[0]->ready = srcs[1]->ready = MP_IOCTL_POLL_RD;
+        wait_result_t res = wait(srcs, 2, NULL, 0);
+        check(res.n_ready == 2 && res.tuple_reused, "ipoll yields one reused tuple");
+    }
+    {
+        uint32_t bit1 = select_take_bit(), bit2 = select_take_bit();
+        xEventGroupClearBits(select_events, bit1 | bit2);
+        select_notify();
+        xEventGroupClearBits(select_events, bit1);
+        check(bit1 != 0 && bit2 != 0 && bit1 != bit2 && (eg_bits & bit2) != 0,
+            "a waiter clearing its bit leaves the others set");
+        select_give_bit(bit1);
+        select_give_bit(bit2);
+        check(select_bits_used == 0, "bits are given back");
+    }
+    {
+        src_obj_t *srcs[1] = { src_new(SRC_BROKEN) };
+        wait_result_t res = wait(srcs, 1, NULL, 100);
+        check(res.exc != MP_OBJ_NULL && mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(mp_obj_get_type(res.exc)), MP_OBJ_FROM_PTR(&mp_type_OSError))
+            && select_bits_used == 0, "an error ends the wait and gives the bit back");
+    }
+    {
+        src_obj_t *srcs[1] = { src_new(SRC_SOCKET) };
+        event_t ev = { EV_INTERRUPT, 150, NULL, mp_obj_new_exception(&mp_type_KeyboardInterrupt) };
+        wait_result_t res = wait(srcs, 1, &ev, -1);
+        check(res.exc == ev.exc && res.elapsed_ms >= 149 && res.elapsed_ms < 150 + SELECT_INTERRUPT_SLICE_MS + 150
+            && select_bits_used == 0,
+            "a KeyboardInterrupt ends an endless wait on sockets");
+    }
+    {
+        src_obj_t *srcs[1] = { src_new(SRC_NOTIFY) };
+        event_t ev = { EV_INTERRUPT, 150, srcs[0], mp_obj_new_exception(&mp_type_KeyboardInterrupt) };
+        wait_result_t res = wait(srcs, 1, &ev, -1);
+        check(res.exc == ev.exc && took(&res, 150) && select_bits_used == 0,
+            "a KeyboardInterrupt with a notification ends an endless wait");
+    }
+
+    mp_deinit();
+    printf("%d failed\n", n_failed);
+    return n_failed != 0;
+}
+
+// the parts of the unix port's main.c that the core needs
+const char mp_frozen_str_names[] = "\0";
+const uint32_t mp_frozen_str_sizes[] = { 0 };
+const char mp_frozen_str_content[] = "";
+
+const mp_print_t mp_stderr_print = { NULL, NULL };
+
+mp_import_stat_t mp_import_stat(const char *path) {
+    return MP_IMPORT_STAT_NO_EXIST;
+}
+
+void nlr_jump_fail(void *val) {
+    printf("FATAL: uncaught NLR %p\n", val);
+    exit(1);
+}
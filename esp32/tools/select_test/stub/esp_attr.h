@@ -0,0 +1,2 @@
+// host stand-in for the ESP-IDF header, see ../select_test.c
+#define IRAM_ATTR
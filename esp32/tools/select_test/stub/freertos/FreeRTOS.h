@@ -0,0 +1,11 @@
+// host stand-in for the FreeRTOS header, see ../../select_test.c
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef uint32_t EventBits_t;
+
+#define portMAX_DELAY       (0xffffffff)
+#define portTICK_PERIOD_MS  (10)
+#define pdTRUE              (1)
+#define pdFALSE             (0)
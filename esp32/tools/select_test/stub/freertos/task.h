@@ -0,0 +1,2 @@
+// host stand-in for the FreeRTOS header, emulated in ../../select_test.c
+void vTaskDelay(TickType_t ticks);
@@ -0,0 +1,4 @@
+// host stand-in for the lwIP header; lwip_select() is the host's select()
+#include <sys/select.h>
+
+int lwip_select(int nfds, fd_set *rfds, fd_set *wfds, fd_set *xfds, struct timeval *tv);
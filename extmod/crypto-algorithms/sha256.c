@@ -98,17 +98,30 @@ void sha256_init(CRYAL_SHA256_CTX *ctx)
 
 void sha256_update(CRYAL_SHA256_CTX *ctx, const BYTE data[], size_t len)
 {
-	WORD i;
+	size_t i = 0;
+
+	// Top up a partly filled block first.
+	if (ctx->datalen > 0) {
+		i = 64 - ctx->datalen;
+		if (i > len)
+			i = len;
+		memcpy(ctx->data + ctx->datalen, data, i);
+		ctx->datalen += i;
+		if (ctx->datalen < 64)
+			return;
+		sha256_transform(ctx, ctx->data);
+		ctx->bitlen += 512;
+		ctx->datalen = 0;
+	}
 
-	for (i = 0; i < len; ++i) {
-		ctx->data[ctx->datalen] = data[i];
-		ctx->datalen++;
-		if (ctx->datalen == 64) {
-			sha256_transform(ctx, ctx->data);
-			ctx->bitlen += 512;
-			ctx->datalen = 0;
-		}
+	// Transform whole blocks straight from the input, without copying.
+	for ( ; len - i >= 64; i += 64) {
+		sha256_transform(ctx, data + i);
+		ctx->bitlen += 512;
 	}
+
+	memcpy(ctx->data, data + i, len - i);
+	ctx->datalen = len - i;
 }
 
 void sha256_final(CRYAL_SHA256_CTX *ctx, BYTE hash[])
@@ -0,0 +1,32 @@
+/*********************************************************************
+* Filename:   sha512.h
+* Details:    Defines the API for the corresponding SHA-512 implementation,
+              in the style of sha256.h.
+*********************************************************************/
+
+#ifndef SHA512_H
+#define SHA512_H
+
+/*************************** HEADER FILES ***************************/
+#include <stddef.h>
+#include "sha256.h"
+
+/****************************** MACROS ******************************/
+#define SHA512_BLOCK_SIZE 64            // SHA512 outputs a 64 byte digest
+
+/**************************** DATA TYPES ****************************/
+typedef unsigned long long DWORD;       // 64-bit word
+
+typedef struct {
+	BYTE data[128];
+	WORD datalen;
+	unsigned long long bitlen;      // messages are < 2^64 bits in practice
+	DWORD state[8];
+} CRYAL_SHA512_CTX;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+void sha512_init(CRYAL_SHA512_CTX *ctx);
+void sha512_update(CRYAL_SHA512_CTX *ctx, const BYTE data[], size_t len);
+void sha512_final(CRYAL_SHA512_CTX *ctx, BYTE hash[]);
+
+#endif   // SHA512_H
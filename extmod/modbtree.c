@@ -39,9 +39,28 @@
 #include <db.h>
 #include <../../btree/btree.h>
 
+// File I/O of the btree page cache goes through this, to gather the pages
+// it writes back and to count I/O.  Writes of whole pages are held in wb_buf
+// (if writeback was given), and on sync or when it's full they are sorted
+// and each run of adjacent pages is written with a single write.
+typedef struct _btree_io_t {
+    mp_obj_t stream;
+    off_t pos;          // file position as seen by the btree code
+    size_t wb_size;     // size of write-back buffer, 0 to write through
+    size_t page_size;   // set by the first buffered write
+    size_t wb_pages;    // number of pages held
+    byte *wb_buf;
+    off_t *wb_offs;     // file offset of each page held
+    size_t *wb_order;   // for flushing, page indices in order of offset
+    mp_uint_t reads;    // page reads from the file (cache misses)
+    mp_uint_t writes;   // page writes from the cache (dirty write-backs)
+    mp_uint_t write_ops; // writes to the file
+} btree_io_t;
+
 typedef struct _mp_obj_btree_t {
     mp_obj_base_t base;
     DB *db;
+    btree_io_t io;
     mp_obj_t start_key;
     mp_obj_t end_key;
     #define FLAG_END_KEY_INCL 1
@@ -65,10 +84,180 @@ void __dbpanic(DB *db) {
     printf("__dbpanic(%p)\n", db);
 }
 
+// Seek before every access instead of remembering where the stream is, as
+// the file object may have been used meanwhile
+STATIC int btree_io_seek_stream(btree_io_t *io, off_t off) {
+    if (mp_stream_posix_lseek(io->stream, off, SEEK_SET) != off) {
+        return -1;
+    }
+    return 0;
+}
+
+STATIC ssize_t btree_io_write_at(btree_io_t *io, off_t off, const void *buf, size_t len) {
+    if (btree_io_seek_stream(io, off) != 0) {
+        return -1;
+    }
+    ssize_t res = mp_stream_posix_write(io->stream, buf, len);
+    io->write_ops++;
+    return res;
+}
+
+// Write out the pages held, in order of file offset
+STATIC int btree_io_flush(btree_io_t *io) {
+    size_t n = io->wb_pages;
+    size_t ps = io->page_size;
+    const off_t *offs = io->wb_offs;
+    size_t *order = io->wb_order;
+    // sort the page indices by insertion, leaving the pages where they are
+    for (size_t i = 0; i < n; i++) {
+        size_t j = i;
+        for (; j > 0 && offs[order[j - 1]] > offs[i]; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+    // write each run of pages adjacent both in the file and in the buffer
+    // with one write; pages are mostly written in order, so runs are common
+    for (size_t i = 0; i < n;) {
+        size_t j = i + 1;
+        while (j < n && order[j] == order[j - 1] + 1 && offs[order[j]] == offs[order[j - 1]] + (off_t)ps) {
+            j++;
+        }
+        size_t len = (j - i) * ps;
+        if (btree_io_write_at(io, offs[order[i]], io->wb_buf + order[i] * ps, len) != (ssize_t)len) {
+            // keep the pages not written yet, moving them to the front
+            for (size_t k = 0; k < i; k++) {
+                io->wb_offs[order[k]] = -1;
+            }
+            size_t kept = 0;
+            for (size_t k = 0; k < n; k++) {
+                if (io->wb_offs[k] != -1) {
+                    if (k != kept) {
+                        io->wb_offs[kept] = io->wb_offs[k];
+                        memcpy(io->wb_buf + kept * ps, io->wb_buf + k * ps, ps);
+                    }
+                    kept++;
+                }
+            }
+            io->wb_pages = kept;
+            return -1;
+        }
+        i = j;
+    }
+    io->wb_pages = 0;
+    return 0;
+}
+
+STATIC ssize_t btree_io_read(void *fd, void *buf, size_t len) {
+    btree_io_t *io = fd;
+    for (size_t i = 0; i < io->wb_pages; i++) {
+        off_t o = io->wb_offs[i];
+        if (o == io->pos && len == io->page_size) {
+            memcpy(buf, io->wb_buf + i * io->page_size, len);
+            io->pos += len;
+            return len;
+        }
+        if (o < io->pos + (off_t)len && io->pos < o + (off_t)io->page_size) {
+            // partly held, so make the file up to date
+            if (btree_io_flush(io) != 0) {
+                return -1;
+            }
+            break;
+        }
+    }
+    if (btree_io_seek_stream(io, io->pos) != 0) {
+        return -1;
+    }
+    ssize_t res = mp_stream_posix_read(io->stream, buf, len);
+    if (res >= 0 && (size_t)res < len && io->wb_pages > 0) {
+        // the file may end short of pages held after this; write them out
+        // so that the gap reads as zeros
+        if (btree_io_flush(io) != 0 || btree_io_seek_stream(io, io->pos) != 0) {
+            return -1;
+        }
+        res = mp_stream_posix_read(io->stream, buf, len);
+    }
+    if (res < 0) {
+        return res;
+    }
+    io->pos += res;
+    io->reads++;
+    return res;
+}
+
+STATIC ssize_t btree_io_write(void *fd, const void *buf, size_t len) {
+    btree_io_t *io = fd;
+    io->writes++;
+    if (io->wb_size != 0 && io->page_size == 0 && len <= io->wb_size) {
+        io->page_size = len;
+        io->wb_buf = m_new(byte, io->wb_size / len * len);
+        io->wb_offs = m_new(off_t, io->wb_size / len);
+        io->wb_order = m_new(size_t, io->wb_size / len);
+    }
+    if (io->page_size == 0 || len != io->page_size) {
+        // not a page, write it straight away, after any pages it may cover
+        if (btree_io_flush(io) != 0) {
+            return -1;
+        }
+        ssize_t res = btree_io_write_at(io, io->pos, buf, len);
+        if (res > 0) {
+            io->pos += res;
+        }
+        return res;
+    }
+    size_t i;
+    for (i = 0; i < io->wb_pages && io->wb_offs[i] != io->pos; i++) {
+    }
+    if (i == io->wb_size / len) {
+        if (btree_io_flush(io) != 0) {
+            return -1;
+        }
+        i = 0;
+    }
+    if (i == io->wb_pages) {
+        io->wb_offs[i] = io->pos;
+        io->wb_pages++;
+    }
+    memcpy(io->wb_buf + i * len, buf, len);
+    io->pos += len;
+    return len;
+}
+
+STATIC off_t btree_io_lseek(void *fd, off_t offset, int whence) {
+    btree_io_t *io = fd;
+    if (whence == SEEK_SET) {
+        io->pos = offset;
+    } else if (whence == SEEK_CUR) {
+        io->pos += offset;
+    } else {
+        off_t end = mp_stream_posix_lseek(io->stream, 0, SEEK_END);
+        if (end < 0) {
+            return -1;
+        }
+        // pages held may extend the file
+        for (size_t i = 0; i < io->wb_pages; i++) {
+            if (io->wb_offs[i] + (off_t)io->page_size > end) {
+                end = io->wb_offs[i] + io->page_size;
+            }
+        }
+        io->pos = end + offset;
+    }
+    return io->pos;
+}
+
+STATIC int btree_io_fsync(void *fd) {
+    btree_io_t *io = fd;
+    if (btree_io_flush(io) != 0) {
+        return -1;
+    }
+    return mp_stream_posix_fsync(io->stream);
+}
+
 STATIC mp_obj_btree_t *btree_new(DB *db) {
     mp_obj_btree_t *o = m_new_obj(mp_obj_btree_t);
     o->base.type = &btree_type;
     o->db = db;
+    memset(&o->io, 0, sizeof(o->io));
     o->start_key = mp_const_none;
     o->end_key = mp_const_none;
     o->next_flags = 0;
@@ -83,10 +272,43 @@ STATIC void btree_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind
 
 STATIC mp_obj_t btree_close(mp_obj_t self_in) {
     mp_obj_btree_t *self = MP_OBJ_TO_PTR(self_in);
-    return MP_OBJ_NEW_SMALL_INT(__bt_close(self->db));
+    int res = __bt_close(self->db);
+    // closing syncs, which writes out the pages held, but make sure
+    if (btree_io_flush(&self->io) != 0) {
+        res = RET_ERROR;
+    }
+    return MP_OBJ_NEW_SMALL_INT(res);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(btree_close_obj, btree_close);
 
+STATIC mp_obj_t btree_flush(mp_obj_t self_in) {
+    mp_obj_btree_t *self = MP_OBJ_TO_PTR(self_in);
+    int res = __bt_sync(self->db, 0);
+    CHECK_ERROR(res);
+    if (btree_io_flush(&self->io) != 0) {
+        mp_raise_OSError(errno);
+    }
+    return MP_OBJ_NEW_SMALL_INT(res);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(btree_flush_obj, btree_flush);
+
+// Return (pages cached, cache size in pages, page reads, page writes,
+// file writes, pages held for write-back)
+STATIC mp_obj_t btree_stats(mp_obj_t self_in) {
+    mp_obj_btree_t *self = MP_OBJ_TO_PTR(self_in);
+    BTREE *t = self->db->internal;
+    mp_obj_t items[6] = {
+        mp_obj_new_int_from_uint(t->bt_mp->curcache),
+        mp_obj_new_int_from_uint(t->bt_mp->maxcache),
+        mp_obj_new_int_from_uint(self->io.reads),
+        mp_obj_new_int_from_uint(self->io.writes),
+        mp_obj_new_int_from_uint(self->io.write_ops),
+        MP_OBJ_NEW_SMALL_INT(self->io.wb_pages),
+    };
+    return mp_obj_new_tuple(6, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(btree_stats_obj, btree_stats);
+
 STATIC mp_obj_t btree_put(size_t n_args, const mp_obj_t *args) {
     (void)n_args;
     mp_obj_btree_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -121,6 +343,175 @@ STATIC mp_obj_t btree_get(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(btree_get_obj, 2, 3, btree_get);
 
+// Move the cursor to the next record of an iteration from *start_key (or the
+// first/last record if None) to end_key, as set up by keys()/values()/items().
+// *start_key is set to MP_OBJ_NULL once the cursor has been positioned, and
+// *end_key when the end is reached.  Returns false at the end.
+STATIC bool btree_iter_step(DB *db, mp_obj_t *start_key, mp_obj_t *end_key, byte iter_flags, DBT *key, DBT *val) {
+    int res;
+    // Different ports may have different type sizes
+    mp_uint_t v;
+    bool desc = iter_flags & FLAG_DESC;
+    if (*end_key == MP_OBJ_NULL) {
+        return false;
+    }
+    if (*start_key != MP_OBJ_NULL) {
+        int flags = R_FIRST;
+        if (*start_key != mp_const_none) {
+            key->data = (void*)mp_obj_str_get_data(*start_key, &v);
+            key->size = v;
+            flags = R_CURSOR;
+        } else if (desc) {
+            flags = R_LAST;
+        }
+        res = __bt_seq(db, key, val, flags);
+        *start_key = MP_OBJ_NULL;
+    } else {
+        res = __bt_seq(db, key, val, desc ? R_PREV : R_NEXT);
+    }
+
+    if (res == RET_SPECIAL) {
+        return false;
+    }
+    CHECK_ERROR(res);
+
+    if (*end_key != mp_const_none) {
+        DBT end;
+        end.data = (void*)mp_obj_str_get_data(*end_key, &v);
+        end.size = v;
+        BTREE *t = db->internal;
+        int cmp = t->bt_cmp(key, &end);
+        if (desc) {
+            cmp = -cmp;
+        }
+        if (iter_flags & FLAG_END_KEY_INCL) {
+            cmp--;
+        }
+        if (cmp >= 0) {
+            *end_key = MP_OBJ_NULL;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Put all the (key, value) pairs of iterable.  If sorted is set, the keys
+// must be in strictly ascending order, which is checked.
+STATIC mp_obj_t btree_put_iter(mp_obj_btree_t *self, mp_obj_t iterable, bool sorted) {
+    BTREE *t = self->db->internal;
+    mp_obj_t iter = mp_getiter(iterable);
+    mp_obj_t item, prev_key = MP_OBJ_NULL;
+    mp_int_t n = 0;
+    while ((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+        mp_obj_t *kv;
+        mp_obj_get_array_fixed_n(item, 2, &kv);
+        DBT key, val;
+        // Different ports may have different type sizes
+        mp_uint_t v;
+        key.data = (void*)mp_obj_str_get_data(kv[0], &v);
+        key.size = v;
+        if (sorted && prev_key != MP_OBJ_NULL) {
+            DBT prev;
+            prev.data = (void*)mp_obj_str_get_data(prev_key, &v);
+            prev.size = v;
+            if (t->bt_cmp(&prev, &key) >= 0) {
+                nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "keys not sorted"));
+            }
+        }
+        val.data = (void*)mp_obj_str_get_data(kv[1], &v);
+        val.size = v;
+        int res = __bt_put(self->db, &key, &val, 0);
+        CHECK_ERROR(res);
+        prev_key = kv[0];
+        n++;
+    }
+    return MP_OBJ_NEW_SMALL_INT(n);
+}
+
+STATIC mp_obj_t btree_put_many(mp_obj_t self_in, mp_obj_t iterable) {
+    return btree_put_iter(MP_OBJ_TO_PTR(self_in), iterable, false);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(btree_put_many_obj, btree_put_many);
+
+// Bulk load from pairs in key order.  Each key then goes after the last one
+// in the tree, which the btree code handles without a search (it keeps the
+// last leaf page), and when that page is full it starts a new empty page
+// instead of splitting it in two.  So the tree is built bottom-up with full
+// pages, rather than half-full ones as for random inserts.
+STATIC mp_obj_t btree_load(mp_obj_t self_in, mp_obj_t iterable) {
+    return btree_put_iter(MP_OBJ_TO_PTR(self_in), iterable, true);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(btree_load_obj, btree_load);
+
+STATIC mp_obj_t btree_get_many(size_t n_args, const mp_obj_t *args) {
+    mp_obj_btree_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t dflt = n_args > 2 ? args[2] : mp_const_none;
+    mp_obj_t iter = mp_getiter(args[1]);
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    mp_obj_t item;
+    while ((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+        DBT key, val;
+        // Different ports may have different type sizes
+        mp_uint_t v;
+        key.data = (void*)mp_obj_str_get_data(item, &v);
+        key.size = v;
+        int res = __bt_get(self->db, &key, &val, 0);
+        CHECK_ERROR(res);
+        mp_obj_list_append(list, res == RET_SPECIAL ? dflt : mp_obj_new_bytes(val.data, val.size));
+    }
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(btree_get_many_obj, 2, 3, btree_get_many);
+
+typedef struct _mp_obj_btree_scan_t {
+    mp_obj_base_t base;
+    mp_obj_btree_t *btree;
+    mp_obj_t start_key;
+    mp_obj_t end_key;
+    mp_obj_t buf;
+    byte flags;
+} mp_obj_btree_scan_t;
+
+// Copy the key and value of the next record into buf, back to back, and
+// return (key length, value length)
+STATIC mp_obj_t btree_scan_iternext(mp_obj_t self_in) {
+    mp_obj_btree_scan_t *self = MP_OBJ_TO_PTR(self_in);
+    DBT key, val;
+    if (!btree_iter_step(self->btree->db, &self->start_key, &self->end_key, self->flags, &key, &val)) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(self->buf, &bufinfo, MP_BUFFER_WRITE);
+    if (key.size + val.size > bufinfo.len) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "buffer too small"));
+    }
+    memcpy(bufinfo.buf, key.data, key.size);
+    memcpy((byte*)bufinfo.buf + key.size, val.data, val.size);
+    mp_obj_t lens[2] = {MP_OBJ_NEW_SMALL_INT(key.size), MP_OBJ_NEW_SMALL_INT(val.size)};
+    return mp_obj_new_tuple(2, lens);
+}
+
+STATIC const mp_obj_type_t btree_scan_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_iterator,
+    .getiter = mp_identity,
+    .iternext = btree_scan_iternext,
+};
+
+STATIC mp_obj_t btree_scan_into(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    mp_obj_btree_scan_t *o = m_new_obj(mp_obj_btree_scan_t);
+    o->base.type = &btree_scan_type;
+    o->btree = MP_OBJ_TO_PTR(args[0]);
+    o->buf = args[1];
+    o->start_key = n_args > 2 ? args[2] : mp_const_none;
+    o->end_key = n_args > 3 ? args[3] : mp_const_none;
+    o->flags = n_args > 4 ? MP_OBJ_SMALL_INT_VALUE(args[4]) : 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(btree_scan_into_obj, 2, 5, btree_scan_into);
+
 STATIC mp_obj_t btree_seq(size_t n_args, const mp_obj_t *args) {
     mp_obj_btree_t *self = MP_OBJ_TO_PTR(args[0]);
     int flags = MP_OBJ_SMALL_INT_VALUE(args[1]);
@@ -198,47 +589,9 @@ STATIC mp_obj_t btree_getiter(mp_obj_t self_in) {
 STATIC mp_obj_t btree_iternext(mp_obj_t self_in) {
     mp_obj_btree_t *self = MP_OBJ_TO_PTR(self_in);
     DBT key, val;
-    int res;
-    // Different ports may have different type sizes
-    mp_uint_t v;
-    bool desc = self->flags & FLAG_DESC;
-    if (self->start_key != MP_OBJ_NULL) {
-        int flags = R_FIRST;
-        if (self->start_key != mp_const_none) {
-            key.data = (void*)mp_obj_str_get_data(self->start_key, &v);
-            key.size = v;
-            flags = R_CURSOR;
-        } else if (desc) {
-            flags = R_LAST;
-        }
-        res = __bt_seq(self->db, &key, &val, flags);
-        self->start_key = MP_OBJ_NULL;
-    } else {
-        res = __bt_seq(self->db, &key, &val, desc ? R_PREV : R_NEXT);
-    }
-
-    if (res == RET_SPECIAL) {
+    if (!btree_iter_step(self->db, &self->start_key, &self->end_key, self->flags, &key, &val)) {
         return MP_OBJ_STOP_ITERATION;
     }
-    CHECK_ERROR(res);
-
-    if (self->end_key != mp_const_none) {
-        DBT end_key;
-        end_key.data = (void*)mp_obj_str_get_data(self->end_key, &v);
-        end_key.size = v;
-        BTREE *t = self->db->internal;
-        int cmp = t->bt_cmp(&key, &end_key);
-        if (desc) {
-            cmp = -cmp;
-        }
-        if (self->flags & FLAG_END_KEY_INCL) {
-            cmp--;
-        }
-        if (cmp >= 0) {
-            self->end_key = MP_OBJ_NULL;
-            return MP_OBJ_STOP_ITERATION;
-        }
-    }
 
     switch (self->flags & FLAG_ITER_TYPE_MASK) {
         case FLAG_ITER_KEYS:
@@ -314,8 +667,14 @@ STATIC mp_obj_t btree_binary_op(mp_uint_t op, mp_obj_t lhs_in, mp_obj_t rhs_in)
 
 STATIC const mp_rom_map_elem_t btree_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&btree_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&btree_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&btree_stats_obj) },
     { MP_ROM_QSTR(MP_QSTR_get), MP_ROM_PTR(&btree_get_obj) },
     { MP_ROM_QSTR(MP_QSTR_put), MP_ROM_PTR(&btree_put_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_many), MP_ROM_PTR(&btree_get_many_obj) },
+    { MP_ROM_QSTR(MP_QSTR_put_many), MP_ROM_PTR(&btree_put_many_obj) },
+    { MP_ROM_QSTR(MP_QSTR_load), MP_ROM_PTR(&btree_load_obj) },
+    { MP_ROM_QSTR(MP_QSTR_scan_into), MP_ROM_PTR(&btree_scan_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_seq), MP_ROM_PTR(&btree_seq_obj) },
     { MP_ROM_QSTR(MP_QSTR_keys), MP_ROM_PTR(&btree_keys_obj) },
     { MP_ROM_QSTR(MP_QSTR_values), MP_ROM_PTR(&btree_values_obj) },
@@ -337,10 +696,10 @@ STATIC const mp_obj_type_t btree_type = {
 };
 
 STATIC FILEVTABLE btree_stream_fvtable = {
-    mp_stream_posix_read,
-    mp_stream_posix_write,
-    mp_stream_posix_lseek,
-    mp_stream_posix_fsync
+    btree_io_read,
+    btree_io_write,
+    btree_io_lseek,
+    btree_io_fsync
 };
 
 STATIC mp_obj_t mod_btree_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
@@ -349,6 +708,7 @@ STATIC mp_obj_t mod_btree_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t
         { MP_QSTR_cachesize, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
         { MP_QSTR_pagesize, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
         { MP_QSTR_minkeypage, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_writeback, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
     };
 
     // Make sure we got a stream object
@@ -359,6 +719,7 @@ STATIC mp_obj_t mod_btree_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t
         mp_arg_val_t cachesize;
         mp_arg_val_t pagesize;
         mp_arg_val_t minkeypage;
+        mp_arg_val_t writeback;
     } args;
     mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args,
         MP_ARRAY_SIZE(allowed_args), allowed_args, (mp_arg_val_t*)&args);
@@ -368,11 +729,16 @@ STATIC mp_obj_t mod_btree_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t
     openinfo.psize = args.pagesize.u_int;
     openinfo.minkeypage = args.minkeypage.u_int;
 
-    DB *db = __bt_open(pos_args[0], &btree_stream_fvtable, &openinfo, /*dflags*/0);
+    // the I/O state lives in the btree object, so create it first
+    mp_obj_btree_t *o = btree_new(NULL);
+    o->io.stream = pos_args[0];
+    o->io.wb_size = args.writeback.u_int;
+    DB *db = __bt_open(&o->io, &btree_stream_fvtable, &openinfo, /*dflags*/0);
     if (db == NULL) {
         mp_raise_OSError(errno);
     }
-    return MP_OBJ_FROM_PTR(btree_new(db));
+    o->db = db;
+    return MP_OBJ_FROM_PTR(o);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_btree_open_obj, 1, mod_btree_open);
 
@@ -35,174 +35,267 @@
 
 #include "uzlib/tinf.h"
 
+STATIC const char binascii_hex_digits[16] = "0123456789abcdef";
+
+// Value of each ASCII hex digit, or 0x80 if not a hex digit
+STATIC const byte binascii_unhex_table[128] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+STATIC const char binascii_base64_digits[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Value of each ASCII base64 digit, 0x40 for the '=' padding, or 0x80 if not
+// valid in base64
+STATIC const byte binascii_unbase64_table[128] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x3e, 0x80, 0x80, 0x80, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x80, 0x80, 0x80, 0x40, 0x80, 0x80,
+    0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+// Characters outside ASCII look up as invalid without a branch
+#define BINASCII_LOOKUP(table, c) (table[(c) & 0x7f] | ((c) & 0x80))
+
+// Returns the buffer of buf_in to write size bytes of output to
+STATIC byte *binascii_get_dest(mp_obj_t buf_in, size_t size) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (bufinfo.len < size) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "buffer too small"));
+    }
+    return bufinfo.buf;
+}
+
+STATIC size_t binascii_hexlify_size(size_t len, const char *sep) {
+    if (len == 0) {
+        return 0;
+    }
+    return len * 2 + (sep != NULL ? len - 1 : 0);
+}
+
+STATIC void binascii_hexlify_buf(byte *out, const byte *in, size_t len, const char *sep) {
+    if (sep == NULL) {
+        for (; len; len--) {
+            byte b = *in++;
+            out[0] = binascii_hex_digits[b >> 4];
+            out[1] = binascii_hex_digits[b & 0xf];
+            out += 2;
+        }
+    } else {
+        for (size_t i = 0; i < len; i++) {
+            byte b = in[i];
+            if (i != 0) {
+                *out++ = *sep;
+            }
+            out[0] = binascii_hex_digits[b >> 4];
+            out[1] = binascii_hex_digits[b & 0xf];
+            out += 2;
+        }
+    }
+}
+
 mp_obj_t mod_binascii_hexlify(size_t n_args, const mp_obj_t *args) {
     // Second argument is for an extension to allow a separator to be used
     // between values.
     const char *sep = NULL;
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
-
-    vstr_t vstr;
-    size_t out_len = bufinfo.len * 2;
     if (n_args > 1) {
         // 1-char separator between hex numbers
-        out_len += bufinfo.len - 1;
         sep = mp_obj_str_get_str(args[1]);
     }
-    vstr_init_len(&vstr, out_len);
-    byte *in = bufinfo.buf, *out = (byte*)vstr.buf;
-    for (mp_uint_t i = bufinfo.len; i--;) {
-        byte d = (*in >> 4);
-        if (d > 9) {
-            d += 'a' - '9' - 1;
-        }
-        *out++ = d + '0';
-        d = (*in++ & 0xf);
-        if (d > 9) {
-            d += 'a' - '9' - 1;
-        }
-        *out++ = d + '0';
-        if (sep != NULL && i != 0) {
-            *out++ = *sep;
-        }
-    }
+
+    vstr_t vstr;
+    vstr_init_len(&vstr, binascii_hexlify_size(bufinfo.len, sep));
+    binascii_hexlify_buf((byte*)vstr.buf, bufinfo.buf, bufinfo.len, sep);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_binascii_hexlify_obj, 1, 2, mod_binascii_hexlify);
 
-mp_obj_t mod_binascii_unhexlify(mp_obj_t data) {
-    mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
-
-    if ((bufinfo.len & 1) != 0) {
+STATIC size_t binascii_unhexlify_size(size_t len) {
+    if ((len & 1) != 0) {
         nlr_raise(mp_obj_new_exception_msg_varg(&mp_type_ValueError, "odd-length string"));
     }
-    vstr_t vstr;
-    vstr_init_len(&vstr, bufinfo.len / 2);
-    byte *in = bufinfo.buf, *out = (byte*)vstr.buf;
-    byte hex_byte = 0;
-    for (mp_uint_t i = bufinfo.len; i--;) {
-        byte hex_ch = *in++;
-        if (unichar_isxdigit(hex_ch)) {
-            hex_byte += unichar_xdigit_value(hex_ch);
-        } else {
+    return len / 2;
+}
+
+STATIC void binascii_unhexlify_buf(byte *out, const byte *in, size_t len) {
+    for (; len; len -= 2) {
+        byte hi = BINASCII_LOOKUP(binascii_unhex_table, in[0]);
+        byte lo = BINASCII_LOOKUP(binascii_unhex_table, in[1]);
+        if ((hi | lo) & 0x80) {
             nlr_raise(mp_obj_new_exception_msg_varg(&mp_type_ValueError, "non-hex digit found"));
         }
-        if (i & 1) {
-            hex_byte <<= 4;
-        } else {
-            *out++ = hex_byte;
-            hex_byte = 0;
-        }
+        *out++ = hi << 4 | lo;
+        in += 2;
     }
-    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
-MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_unhexlify_obj, mod_binascii_unhexlify);
 
-mp_obj_t mod_binascii_a2b_base64(mp_obj_t data) {
+mp_obj_t mod_binascii_unhexlify(mp_obj_t data) {
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
-    if (bufinfo.len % 4 != 0) {
+
+    vstr_t vstr;
+    vstr_init_len(&vstr, binascii_unhexlify_size(bufinfo.len));
+    binascii_unhexlify_buf((byte*)vstr.buf, bufinfo.buf, bufinfo.len);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_unhexlify_obj, mod_binascii_unhexlify);
+
+// Returns the decoded size of base64 data, checking its length
+STATIC size_t binascii_a2b_base64_size(const byte *in, size_t len) {
+    if (len % 4 != 0) {
         nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "incorrect padding"));
     }
+    size_t size = len / 4 * 3;
+    if (len != 0 && in[len - 1] == '=') {
+        size -= (in[len - 2] == '=') ? 2 : 1;
+    }
+    return size;
+}
 
-    vstr_t vstr;
-    byte *in = bufinfo.buf;
-    if (bufinfo.len == 0) {
-        vstr_init_len(&vstr, 0);
-    }
-    else {
-        vstr_init_len(&vstr, ((bufinfo.len / 4) * 3) - ((in[bufinfo.len-1] == '=') ? ((in[bufinfo.len-2] == '=') ? 2 : 1 ) : 0)); 
-    }
-    byte *out = (byte*)vstr.buf;
-    for (mp_uint_t i = bufinfo.len; i; i -= 4) {
-        char hold[4];
-        for (int j = 4; j--;) {
-            if (in[j] >= 'A' && in[j] <= 'Z') {
-                hold[j] = in[j] - 'A';
-            } else if (in[j] >= 'a' && in[j] <= 'z') {
-                hold[j] = in[j] - 'a' + 26;
-            } else if (in[j] >= '0' && in[j] <= '9') {
-                hold[j] = in[j] - '0' + 52;
-            } else if (in[j] == '+') {
-                hold[j] = 62;
-            } else if (in[j] == '/') {
-                hold[j] = 63;
-            } else if (in[j] == '=') {
-                if (j < 2 || i > 4) {
-                    nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "incorrect padding"));
-                }
-                hold[j] = 64;
-            } else {
+STATIC void binascii_a2b_base64_buf(byte *out, const byte *in, size_t len) {
+    for (; len; len -= 4) {
+        byte a = BINASCII_LOOKUP(binascii_unbase64_table, in[0]);
+        byte b = BINASCII_LOOKUP(binascii_unbase64_table, in[1]);
+        byte c = BINASCII_LOOKUP(binascii_unbase64_table, in[2]);
+        byte d = BINASCII_LOOKUP(binascii_unbase64_table, in[3]);
+        in += 4;
+        if ((a | b | c | d) & 0xc0) {
+            // invalid, or padding which may only end the last group
+            if ((a | b | c | d) & 0x80) {
                 nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "invalid character"));
             }
-        }
-        in += 4;
-
-        *out++ = (hold[0]) << 2 | (hold[1]) >> 4;
-        if (hold[2] != 64) {
-            *out++ = (hold[1] & 0x0F) << 4 | hold[2] >> 2;
-            if (hold[3] != 64) {
-                *out++ = (hold[2] & 0x03) << 6 | hold[3];
+            if (len > 4 || ((a | b) & 0x40) || (c & ~d & 0x40)) {
+                nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "incorrect padding"));
+            }
+            *out++ = a << 2 | b >> 4;
+            if (!(c & 0x40)) {
+                *out++ = b << 4 | c >> 2;
             }
+            return;
         }
+        uint32_t w = (uint32_t)a << 18 | b << 12 | c << 6 | d;
+        out[0] = w >> 16;
+        out[1] = w >> 8;
+        out[2] = w;
+        out += 3;
     }
-    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
-MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_a2b_base64_obj, mod_binascii_a2b_base64);
 
-mp_obj_t mod_binascii_b2a_base64(mp_obj_t data) {
+mp_obj_t mod_binascii_a2b_base64(mp_obj_t data) {
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
 
     vstr_t vstr;
-    vstr_init_len(&vstr, ((bufinfo.len != 0) ? (((bufinfo.len - 1) / 3) + 1) * 4 : 0) + 1);
-
-    // First pass, we convert input buffer to numeric base 64 values
-    byte *in = bufinfo.buf, *out = (byte*)vstr.buf;
-    mp_uint_t i;
-    for (i = bufinfo.len; i >= 3; i -= 3) {
-        *out++ = (in[0] & 0xFC) >> 2;
-        *out++ = (in[0] & 0x03) << 4 | (in[1] & 0xF0) >> 4;
-        *out++ = (in[1] & 0x0F) << 2 | (in[2] & 0xC0) >> 6;
-        *out++ = in[2] & 0x3F;
+    vstr_init_len(&vstr, binascii_a2b_base64_size(bufinfo.buf, bufinfo.len));
+    binascii_a2b_base64_buf((byte*)vstr.buf, bufinfo.buf, bufinfo.len);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_a2b_base64_obj, mod_binascii_a2b_base64);
+
+STATIC size_t binascii_b2a_base64_size(size_t len, bool newline) {
+    return (len + 2) / 3 * 4 + newline;
+}
+
+STATIC void binascii_b2a_base64_buf(byte *out, const byte *in, size_t len, bool newline) {
+    const char *digits = binascii_base64_digits;
+    for (; len >= 3; len -= 3) {
+        uint32_t w = (uint32_t)in[0] << 16 | in[1] << 8 | in[2];
+        out[0] = digits[w >> 18];
+        out[1] = digits[(w >> 12) & 0x3f];
+        out[2] = digits[(w >> 6) & 0x3f];
+        out[3] = digits[w & 0x3f];
         in += 3;
+        out += 4;
     }
-    if (i != 0) {
-        *out++ = (in[0] & 0xFC) >> 2;
-        if (i == 2) {
-            *out++ = (in[0] & 0x03) << 4 | (in[1] & 0xF0) >> 4;
-            *out++ = (in[1] & 0x0F) << 2;
-        }
-        else {
-            *out++ = (in[0] & 0x03) << 4;
-            *out++ = 64;
-        }
-        *out++ = 64;
-    }
-
-    // Second pass, we convert number base 64 values to actual base64 ascii encoding
-    out = (byte*)vstr.buf;
-    for (mp_uint_t j = vstr.len - 1; j--;) {
-        if (*out < 26) {
-            *out += 'A';
-        } else if (*out < 52) {
-            *out += 'a' - 26;
-        } else if (*out < 62) {
-            *out += '0' - 52;
-        } else if (*out == 62) {
-            *out ='+';
-        } else if (*out == 63) {
-            *out = '/';
-        } else {
-            *out = '=';
-        }
-        out++;
+    if (len != 0) {
+        uint32_t w = (uint32_t)in[0] << 16 | (len == 2 ? in[1] << 8 : 0);
+        out[0] = digits[w >> 18];
+        out[1] = digits[(w >> 12) & 0x3f];
+        out[2] = (len == 2) ? digits[(w >> 6) & 0x3f] : '=';
+        out[3] = '=';
+        out += 4;
     }
-    *out = '\n';
+    if (newline) {
+        *out = '\n';
+    }
+}
+
+STATIC const mp_arg_t binascii_b2a_base64_allowed_args[] = {
+    { MP_QSTR_newline, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = true} },
+};
+
+mp_obj_t mod_binascii_b2a_base64(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    mp_arg_val_t newline;
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, 1, binascii_b2a_base64_allowed_args, &newline);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(pos_args[0], &bufinfo, MP_BUFFER_READ);
+
+    vstr_t vstr;
+    vstr_init_len(&vstr, binascii_b2a_base64_size(bufinfo.len, newline.u_bool));
+    binascii_b2a_base64_buf((byte*)vstr.buf, bufinfo.buf, bufinfo.len, newline.u_bool);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
-MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_b2a_base64_obj, mod_binascii_b2a_base64);
+MP_DEFINE_CONST_FUN_OBJ_KW(mod_binascii_b2a_base64_obj, 1, mod_binascii_b2a_base64);
+
+#if MICROPY_PY_UBINASCII_INTO
+// The _into variants write to a caller's buffer, which must not overlap the
+// input, and return the number of bytes written.
+
+STATIC mp_obj_t mod_binascii_hexlify_into(size_t n_args, const mp_obj_t *args) {
+    const char *sep = NULL;
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+    if (n_args > 2) {
+        sep = mp_obj_str_get_str(args[2]);
+    }
+    size_t size = binascii_hexlify_size(bufinfo.len, sep);
+    binascii_hexlify_buf(binascii_get_dest(args[0], size), bufinfo.buf, bufinfo.len, sep);
+    return MP_OBJ_NEW_SMALL_INT(size);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_binascii_hexlify_into_obj, 2, 3, mod_binascii_hexlify_into);
+
+STATIC mp_obj_t mod_binascii_unhexlify_into(mp_obj_t buf_in, mp_obj_t data) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
+    size_t size = binascii_unhexlify_size(bufinfo.len);
+    binascii_unhexlify_buf(binascii_get_dest(buf_in, size), bufinfo.buf, bufinfo.len);
+    return MP_OBJ_NEW_SMALL_INT(size);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_binascii_unhexlify_into_obj, mod_binascii_unhexlify_into);
+
+STATIC mp_obj_t mod_binascii_a2b_base64_into(mp_obj_t buf_in, mp_obj_t data) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
+    size_t size = binascii_a2b_base64_size(bufinfo.buf, bufinfo.len);
+    binascii_a2b_base64_buf(binascii_get_dest(buf_in, size), bufinfo.buf, bufinfo.len);
+    return MP_OBJ_NEW_SMALL_INT(size);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_binascii_a2b_base64_into_obj, mod_binascii_a2b_base64_into);
+
+STATIC mp_obj_t mod_binascii_b2a_base64_into(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    mp_arg_val_t newline;
+    mp_arg_parse_all(n_args - 2, pos_args + 2, kw_args, 1, binascii_b2a_base64_allowed_args, &newline);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(pos_args[1], &bufinfo, MP_BUFFER_READ);
+    size_t size = binascii_b2a_base64_size(bufinfo.len, newline.u_bool);
+    binascii_b2a_base64_buf(binascii_get_dest(pos_args[0], size), bufinfo.buf, bufinfo.len, newline.u_bool);
+    return MP_OBJ_NEW_SMALL_INT(size);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_binascii_b2a_base64_into_obj, 2, mod_binascii_b2a_base64_into);
+#endif
 
 #if MICROPY_PY_UBINASCII_CRC32
 mp_obj_t mod_binascii_crc32(size_t n_args, const mp_obj_t *args) {
@@ -215,6 +308,155 @@ mp_obj_t mod_binascii_crc32(size_t n_args, const mp_obj_t *args) {
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_binascii_crc32_obj, 1, 2, mod_binascii_crc32);
 #endif
 
+#if MICROPY_PY_UBINASCII_CRC
+
+#define CRC_TABLE_BITS MICROPY_PY_UBINASCII_CRC_TABLE_BITS
+
+// The register is kept reflected if the input is, so that each step shifts
+// right; otherwise it's kept in the top width bits, so that each step
+// shifts left and the same code serves all widths up to 32.
+typedef struct _mp_obj_binascii_crc_t {
+    mp_obj_base_t base;
+    uint8_t width;
+    bool refin;
+    bool refout;
+    uint32_t init;
+    uint32_t xorout;
+    uint32_t crc;
+    uint32_t table[1 << CRC_TABLE_BITS];
+} mp_obj_binascii_crc_t;
+
+STATIC uint32_t binascii_crc_reflect(uint32_t v, int width) {
+    uint32_t r = 0;
+    while (width--) {
+        r = (r << 1) | (v & 1);
+        v >>= 1;
+    }
+    return r;
+}
+
+STATIC uint32_t binascii_crc_mask(int width) {
+    return width == 32 ? 0xffffffff : ((uint32_t)1 << width) - 1;
+}
+
+STATIC mp_obj_t binascii_crc_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    enum { ARG_width, ARG_poly, ARG_init, ARG_refin, ARG_refout, ARG_xorout };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_width, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_poly, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_init, MP_ARG_OBJ, {.u_obj = MP_OBJ_NEW_SMALL_INT(0)} },
+        { MP_QSTR_refin, MP_ARG_BOOL, {.u_bool = false} },
+        { MP_QSTR_refout, MP_ARG_BOOL, {.u_bool = false} },
+        { MP_QSTR_xorout, MP_ARG_OBJ, {.u_obj = MP_OBJ_NEW_SMALL_INT(0)} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+
+    mp_int_t width = vals[ARG_width].u_int;
+    if (width < 1 || width > 32) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "invalid width"));
+    }
+    uint32_t mask = binascii_crc_mask(width);
+    uint32_t poly = mp_obj_get_int_truncated(vals[ARG_poly].u_obj) & mask;
+    uint32_t init = mp_obj_get_int_truncated(vals[ARG_init].u_obj) & mask;
+
+    mp_obj_binascii_crc_t *o = m_new_obj(mp_obj_binascii_crc_t);
+    o->base.type = type;
+    o->width = width;
+    o->refin = vals[ARG_refin].u_bool;
+    o->refout = vals[ARG_refout].u_bool;
+    o->xorout = mp_obj_get_int_truncated(vals[ARG_xorout].u_obj) & mask;
+
+    if (o->refin) {
+        poly = binascii_crc_reflect(poly, width);
+        o->init = binascii_crc_reflect(init, width);
+        for (uint32_t i = 0; i < MP_ARRAY_SIZE(o->table); i++) {
+            uint32_t c = i;
+            for (int k = 0; k < CRC_TABLE_BITS; k++) {
+                c = (c & 1) ? (c >> 1) ^ poly : c >> 1;
+            }
+            o->table[i] = c;
+        }
+    } else {
+        poly <<= 32 - width;
+        o->init = init << (32 - width);
+        for (uint32_t i = 0; i < MP_ARRAY_SIZE(o->table); i++) {
+            uint32_t c = i << (32 - CRC_TABLE_BITS);
+            for (int k = 0; k < CRC_TABLE_BITS; k++) {
+                c = (c & 0x80000000) ? (c << 1) ^ poly : c << 1;
+            }
+            o->table[i] = c;
+        }
+    }
+    o->crc = o->init;
+
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_obj_t binascii_crc_update(mp_obj_t self_in, mp_obj_t data) {
+    mp_obj_binascii_crc_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
+    const byte *buf = bufinfo.buf;
+    const uint32_t *table = self->table;
+    uint32_t crc = self->crc;
+    if (self->refin) {
+        for (size_t i = 0; i < bufinfo.len; i++) {
+            crc ^= buf[i];
+            for (int k = 0; k < 8; k += CRC_TABLE_BITS) {
+                crc = table[crc & ((1 << CRC_TABLE_BITS) - 1)] ^ (crc >> CRC_TABLE_BITS);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < bufinfo.len; i++) {
+            crc ^= (uint32_t)buf[i] << 24;
+            for (int k = 0; k < 8; k += CRC_TABLE_BITS) {
+                crc = table[crc >> (32 - CRC_TABLE_BITS)] ^ (crc << CRC_TABLE_BITS);
+            }
+        }
+    }
+    self->crc = crc;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(binascii_crc_update_obj, binascii_crc_update);
+
+STATIC mp_obj_t binascii_crc_value(mp_obj_t self_in) {
+    mp_obj_binascii_crc_t *self = MP_OBJ_TO_PTR(self_in);
+    uint32_t crc = self->crc;
+    if (!self->refin) {
+        crc >>= 32 - self->width;
+    }
+    if (self->refin != self->refout) {
+        crc = binascii_crc_reflect(crc, self->width);
+    }
+    return mp_obj_new_int_from_uint(crc ^ self->xorout);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(binascii_crc_value_obj, binascii_crc_value);
+
+STATIC mp_obj_t binascii_crc_reset(mp_obj_t self_in) {
+    mp_obj_binascii_crc_t *self = MP_OBJ_TO_PTR(self_in);
+    self->crc = self->init;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(binascii_crc_reset_obj, binascii_crc_reset);
+
+STATIC const mp_rom_map_elem_t binascii_crc_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&binascii_crc_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_value), MP_ROM_PTR(&binascii_crc_value_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&binascii_crc_reset_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(binascii_crc_locals_dict, binascii_crc_locals_dict_table);
+
+STATIC const mp_obj_type_t binascii_crc_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_CRC,
+    .make_new = binascii_crc_make_new,
+    .locals_dict = (void*)&binascii_crc_locals_dict,
+};
+
+#endif
+
 #if MICROPY_PY_UBINASCII
 
 STATIC const mp_rom_map_elem_t mp_module_binascii_globals_table[] = {
@@ -223,9 +465,18 @@ STATIC const mp_rom_map_elem_t mp_module_binascii_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_unhexlify), MP_ROM_PTR(&mod_binascii_unhexlify_obj) },
     { MP_ROM_QSTR(MP_QSTR_a2b_base64), MP_ROM_PTR(&mod_binascii_a2b_base64_obj) },
     { MP_ROM_QSTR(MP_QSTR_b2a_base64), MP_ROM_PTR(&mod_binascii_b2a_base64_obj) },
+    #if MICROPY_PY_UBINASCII_INTO
+    { MP_ROM_QSTR(MP_QSTR_hexlify_into), MP_ROM_PTR(&mod_binascii_hexlify_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unhexlify_into), MP_ROM_PTR(&mod_binascii_unhexlify_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_a2b_base64_into), MP_ROM_PTR(&mod_binascii_a2b_base64_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_b2a_base64_into), MP_ROM_PTR(&mod_binascii_b2a_base64_into_obj) },
+    #endif
     #if MICROPY_PY_UBINASCII_CRC32
     { MP_ROM_QSTR(MP_QSTR_crc32), MP_ROM_PTR(&mod_binascii_crc32_obj) },
     #endif
+    #if MICROPY_PY_UBINASCII_CRC
+    { MP_ROM_QSTR(MP_QSTR_CRC), MP_ROM_PTR(&binascii_crc_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_binascii_globals, mp_module_binascii_globals_table);
@@ -29,122 +29,325 @@
 
 #include "py/nlr.h"
 #include "py/runtime.h"
+#include "py/stream.h"
 
 #if MICROPY_PY_UHASHLIB
 
 #include "crypto-algorithms/sha256.h"
+#if MICROPY_PY_UHASHLIB_SHA512
+#include "crypto-algorithms/sha512.h"
+#endif
 #if MICROPY_PY_UHASHLIB_SHA1
 #include "lib/axtls/crypto/crypto.h"
 #endif
 
+// Each hash type points to one of these, so that the methods can be shared
+// between all algorithms
+typedef struct _hash_alg_t {
+    uint16_t ctx_size;
+    uint8_t digest_size;
+    uint8_t block_size;
+    void (*init)(void *ctx);
+    void (*update)(void *ctx, const byte *data, size_t len);
+    void (*final)(void *ctx, byte *digest);
+} hash_alg_t;
+
+// A hash type is a type object followed by its algorithm
+typedef struct _hash_type_t {
+    mp_obj_type_t base;
+    const hash_alg_t *alg;
+} hash_type_t;
+
 typedef struct _mp_obj_hash_t {
     mp_obj_base_t base;
+    const hash_alg_t *alg;
+    // context of the hash; for hmac, the inner then the outer context
     char state[0];
 } mp_obj_hash_t;
 
-STATIC mp_obj_t hash_update(mp_obj_t self_in, mp_obj_t arg);
+#if MICROPY_PY_UHASHLIB_HMAC
+STATIC const mp_obj_type_t hmac_type;
+#endif
 
-STATIC mp_obj_t hash_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
-    mp_arg_check_num(n_args, n_kw, 0, 1, false);
-    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, sizeof(CRYAL_SHA256_CTX));
-    o->base.type = type;
-    sha256_init((CRYAL_SHA256_CTX*)o->state);
-    if (n_args == 1) {
-        hash_update(MP_OBJ_FROM_PTR(o), args[0]);
-    }
-    return MP_OBJ_FROM_PTR(o);
+STATIC void sha256_init_ctx(void *ctx) {
+    sha256_init(ctx);
+}
+
+STATIC void sha256_update_ctx(void *ctx, const byte *data, size_t len) {
+    sha256_update(ctx, data, len);
+}
+
+STATIC void sha256_final_ctx(void *ctx, byte *digest) {
+    sha256_final(ctx, digest);
+}
+
+STATIC const hash_alg_t sha256_alg = {
+    sizeof(CRYAL_SHA256_CTX), SHA256_BLOCK_SIZE, 64,
+    sha256_init_ctx, sha256_update_ctx, sha256_final_ctx,
+};
+
+#if MICROPY_PY_UHASHLIB_SHA512
+STATIC void sha512_init_ctx(void *ctx) {
+    sha512_init(ctx);
+}
+
+STATIC void sha512_update_ctx(void *ctx, const byte *data, size_t len) {
+    sha512_update(ctx, data, len);
+}
+
+STATIC void sha512_final_ctx(void *ctx, byte *digest) {
+    sha512_final(ctx, digest);
 }
 
+STATIC const hash_alg_t sha512_alg = {
+    sizeof(CRYAL_SHA512_CTX), SHA512_BLOCK_SIZE, 128,
+    sha512_init_ctx, sha512_update_ctx, sha512_final_ctx,
+};
+#endif
+
 #if MICROPY_PY_UHASHLIB_SHA1
-STATIC mp_obj_t sha1_update(mp_obj_t self_in, mp_obj_t arg);
+STATIC void sha1_init_ctx(void *ctx) {
+    SHA1_Init(ctx);
+}
+
+STATIC void sha1_update_ctx(void *ctx, const byte *data, size_t len) {
+    SHA1_Update(ctx, data, len);
+}
+
+STATIC void sha1_final_ctx(void *ctx, byte *digest) {
+    SHA1_Final(digest, ctx);
+}
 
-STATIC mp_obj_t sha1_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+STATIC const hash_alg_t sha1_alg = {
+    sizeof(SHA1_CTX), SHA1_SIZE, 64,
+    sha1_init_ctx, sha1_update_ctx, sha1_final_ctx,
+};
+#endif
+
+STATIC mp_obj_t hash_update(mp_obj_t self_in, mp_obj_t arg);
+
+STATIC mp_obj_t hash_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     mp_arg_check_num(n_args, n_kw, 0, 1, false);
-    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, sizeof(SHA1_CTX));
+    const hash_alg_t *alg = ((const hash_type_t*)type)->alg;
+    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, alg->ctx_size);
     o->base.type = type;
-    SHA1_Init((SHA1_CTX*)o->state);
+    o->alg = alg;
+    alg->init(o->state);
     if (n_args == 1) {
-        sha1_update(MP_OBJ_FROM_PTR(o), args[0]);
+        hash_update(MP_OBJ_FROM_PTR(o), args[0]);
     }
     return MP_OBJ_FROM_PTR(o);
 }
-#endif
 
 STATIC mp_obj_t hash_update(mp_obj_t self_in, mp_obj_t arg) {
     mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(arg, &bufinfo, MP_BUFFER_READ);
-    sha256_update((CRYAL_SHA256_CTX*)self->state, bufinfo.buf, bufinfo.len);
+    self->alg->update(self->state, bufinfo.buf, bufinfo.len);
     return mp_const_none;
 }
 MP_DEFINE_CONST_FUN_OBJ_2(hash_update_obj, hash_update);
 
-#if MICROPY_PY_UHASHLIB_SHA1
-STATIC mp_obj_t sha1_update(mp_obj_t self_in, mp_obj_t arg) {
+// Hash up to nbytes (all if negative) read from stream, through a buffer on
+// the C stack, and return the number of bytes hashed
+STATIC mp_obj_t hash_update_from(size_t n_args, const mp_obj_t *args) {
+    mp_obj_hash_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_get_stream_raise(args[1], MP_STREAM_OP_READ);
+    mp_int_t nbytes = -1;
+    if (n_args > 2) {
+        nbytes = mp_obj_get_int(args[2]);
+    }
+    byte buf[MICROPY_PY_UHASHLIB_STREAM_BUF_SIZE];
+    mp_uint_t total = 0;
+    while (nbytes < 0 || total < (mp_uint_t)nbytes) {
+        mp_uint_t size = sizeof(buf);
+        if (nbytes >= 0 && (mp_uint_t)nbytes - total < size) {
+            size = nbytes - total;
+        }
+        int error;
+        mp_uint_t out_sz = mp_stream_read_exactly(args[1], buf, size, &error);
+        if (error != 0) {
+            mp_raise_OSError(error);
+        }
+        self->alg->update(self->state, buf, out_sz);
+        total += out_sz;
+        if (out_sz < size) {
+            break;
+        }
+    }
+    return mp_obj_new_int_from_uint(total);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(hash_update_from_obj, 2, 3, hash_update_from);
+
+STATIC mp_obj_t hash_copy(mp_obj_t self_in) {
     mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
-    mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(arg, &bufinfo, MP_BUFFER_READ);
-    SHA1_Update((SHA1_CTX*)self->state, bufinfo.buf, bufinfo.len);
-    return mp_const_none;
+    size_t size = self->alg->ctx_size;
+    #if MICROPY_PY_UHASHLIB_HMAC
+    if (self->base.type == &hmac_type) {
+        size *= 2;
+    }
+    #endif
+    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, size);
+    memcpy(o, self, sizeof(mp_obj_hash_t) + size);
+    return MP_OBJ_FROM_PTR(o);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(hash_copy_obj, hash_copy);
+
+// Finish a copy of the context into digest, so the hash can still be
+// updated or digested again
+STATIC void hash_final_copy(const hash_alg_t *alg, const void *ctx, byte *digest) {
+    void *tmp = alloca(alg->ctx_size);
+    memcpy(tmp, ctx, alg->ctx_size);
+    alg->final(tmp, digest);
 }
-MP_DEFINE_CONST_FUN_OBJ_2(sha1_update_obj, sha1_update);
-#endif
 
 STATIC mp_obj_t hash_digest(mp_obj_t self_in) {
     mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
+    const hash_alg_t *alg = self->alg;
     vstr_t vstr;
-    vstr_init_len(&vstr, SHA256_BLOCK_SIZE);
-    sha256_final((CRYAL_SHA256_CTX*)self->state, (byte*)vstr.buf);
+    vstr_init_len(&vstr, alg->digest_size);
+    hash_final_copy(alg, self->state, (byte*)vstr.buf);
+    #if MICROPY_PY_UHASHLIB_HMAC
+    if (self->base.type == &hmac_type) {
+        // outer hash of the inner digest
+        void *outer = alloca(alg->ctx_size);
+        memcpy(outer, self->state + alg->ctx_size, alg->ctx_size);
+        alg->update(outer, (byte*)vstr.buf, alg->digest_size);
+        alg->final(outer, (byte*)vstr.buf);
+    }
+    #endif
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(hash_digest_obj, hash_digest);
 
-#if MICROPY_PY_UHASHLIB_SHA1
-STATIC mp_obj_t sha1_digest(mp_obj_t self_in) {
-    mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
+STATIC mp_obj_t hash_hexdigest(mp_obj_t self_in) {
+    mp_obj_t digest = hash_digest(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer(digest, &bufinfo, MP_BUFFER_READ);
     vstr_t vstr;
-    vstr_init_len(&vstr, SHA1_SIZE);
-    SHA1_Final((byte*)vstr.buf, (SHA1_CTX*)self->state);
-    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+    vstr_init_len(&vstr, bufinfo.len * 2);
+    for (size_t i = 0; i < bufinfo.len; i++) {
+        byte b = ((byte*)bufinfo.buf)[i];
+        vstr.buf[i * 2] = "0123456789abcdef"[b >> 4];
+        vstr.buf[i * 2 + 1] = "0123456789abcdef"[b & 15];
+    }
+    return mp_obj_new_str_from_vstr(&mp_type_str, &vstr);
 }
-MP_DEFINE_CONST_FUN_OBJ_1(sha1_digest_obj, sha1_digest);
-#endif
+MP_DEFINE_CONST_FUN_OBJ_1(hash_hexdigest_obj, hash_hexdigest);
 
 STATIC const mp_rom_map_elem_t hash_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&hash_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_update_from), MP_ROM_PTR(&hash_update_from_obj) },
     { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&hash_digest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_hexdigest), MP_ROM_PTR(&hash_hexdigest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_copy), MP_ROM_PTR(&hash_copy_obj) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(hash_locals_dict, hash_locals_dict_table);
 
-STATIC const mp_obj_type_t sha256_type = {
-    { &mp_type_type },
-    .name = MP_QSTR_sha256,
-    .make_new = hash_make_new,
-    .locals_dict = (void*)&hash_locals_dict,
+STATIC const hash_type_t sha256_type = {
+    {
+        { &mp_type_type },
+        .name = MP_QSTR_sha256,
+        .make_new = hash_make_new,
+        .locals_dict = (void*)&hash_locals_dict,
+    },
+    &sha256_alg,
 };
 
+#if MICROPY_PY_UHASHLIB_SHA512
+STATIC const hash_type_t sha512_type = {
+    {
+        { &mp_type_type },
+        .name = MP_QSTR_sha512,
+        .make_new = hash_make_new,
+        .locals_dict = (void*)&hash_locals_dict,
+    },
+    &sha512_alg,
+};
+#endif
+
 #if MICROPY_PY_UHASHLIB_SHA1
-STATIC const mp_rom_map_elem_t sha1_locals_dict_table[] = {
-    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&sha1_update_obj) },
-    { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&sha1_digest_obj) },
+STATIC const hash_type_t sha1_type = {
+    {
+        { &mp_type_type },
+        .name = MP_QSTR_sha1,
+        .make_new = hash_make_new,
+        .locals_dict = (void*)&hash_locals_dict,
+    },
+    &sha1_alg,
 };
-STATIC MP_DEFINE_CONST_DICT(sha1_locals_dict, sha1_locals_dict_table);
+#endif
+
+#if MICROPY_PY_UHASHLIB_HMAC
+// hmac(key, msg=None, digestmod=sha256)
+STATIC mp_obj_t hmac_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    enum { ARG_key, ARG_msg, ARG_digestmod };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_key, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_msg, MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_digestmod, MP_ARG_OBJ, {.u_obj = MP_OBJ_FROM_PTR(&sha256_type)} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+    const mp_obj_type_t *digestmod = MP_OBJ_TO_PTR(vals[ARG_digestmod].u_obj);
+    if (!MP_OBJ_IS_TYPE(vals[ARG_digestmod].u_obj, &mp_type_type) || digestmod->make_new != hash_make_new) {
+        mp_raise_TypeError("digestmod must be a uhashlib hash");
+    }
+    const hash_alg_t *alg = ((const hash_type_t*)digestmod)->alg;
+    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, alg->ctx_size * 2);
+    o->base.type = type;
+    o->alg = alg;
+
+    // keys longer than a block are hashed first
+    mp_buffer_info_t key;
+    mp_get_buffer_raise(vals[ARG_key].u_obj, &key, MP_BUFFER_READ);
+    byte pad[128];
+    memset(pad, 0, sizeof(pad));
+    if (key.len > alg->block_size) {
+        alg->init(o->state);
+        alg->update(o->state, key.buf, key.len);
+        alg->final(o->state, pad);
+    } else {
+        memcpy(pad, key.buf, key.len);
+    }
+    for (size_t i = 0; i < alg->block_size; i++) {
+        pad[i] ^= 0x36;
+    }
+    alg->init(o->state);
+    alg->update(o->state, pad, alg->block_size);
+    for (size_t i = 0; i < alg->block_size; i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+    alg->init(o->state + alg->ctx_size);
+    alg->update(o->state + alg->ctx_size, pad, alg->block_size);
+
+    if (vals[ARG_msg].u_obj != mp_const_none) {
+        hash_update(MP_OBJ_FROM_PTR(o), vals[ARG_msg].u_obj);
+    }
+    return MP_OBJ_FROM_PTR(o);
+}
 
-STATIC const mp_obj_type_t sha1_type = {
+STATIC const mp_obj_type_t hmac_type = {
     { &mp_type_type },
-    .name = MP_QSTR_sha1,
-    .make_new = sha1_make_new,
-    .locals_dict = (void*)&sha1_locals_dict,
+    .name = MP_QSTR_hmac,
+    .make_new = hmac_make_new,
+    .locals_dict = (void*)&hash_locals_dict,
 };
 #endif
 
 STATIC const mp_rom_map_elem_t mp_module_hashlib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uhashlib) },
     { MP_ROM_QSTR(MP_QSTR_sha256), MP_ROM_PTR(&sha256_type) },
+    #if MICROPY_PY_UHASHLIB_SHA512
+    { MP_ROM_QSTR(MP_QSTR_sha512), MP_ROM_PTR(&sha512_type) },
+    #endif
     #if MICROPY_PY_UHASHLIB_SHA1
     { MP_ROM_QSTR(MP_QSTR_sha1), MP_ROM_PTR(&sha1_type) },
     #endif
+    #if MICROPY_PY_UHASHLIB_HMAC
+    { MP_ROM_QSTR(MP_QSTR_hmac), MP_ROM_PTR(&hmac_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_hashlib_globals, mp_module_hashlib_globals_table);
@@ -155,5 +358,8 @@ const mp_obj_module_t mp_module_uhashlib = {
 };
 
 #include "crypto-algorithms/sha256.c"
+#if MICROPY_PY_UHASHLIB_SHA512
+#include "crypto-algorithms/sha512.c"
+#endif
 
 #endif //MICROPY_PY_UHASHLIB
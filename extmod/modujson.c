@@ -25,26 +25,155 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "py/nlr.h"
 #include "py/objlist.h"
-#include "py/objstringio.h"
+#include "py/objstr.h"
+#include "py/formatfloat.h"
 #include "py/parsenum.h"
 #include "py/runtime.h"
 #include "py/stream.h"
+#include "py/smallint.h"
+#include "py/stackctrl.h"
 
 #if MICROPY_PY_UJSON
 
+// The JSON encoder handles the common types directly and falls back to the
+// PRINT_JSON print method of the object for everything else.  The output has
+// the same format as printing the object with PRINT_JSON.
+STATIC void ujson_encode(const mp_print_t *print, mp_obj_t obj) {
+    // there can be data structures nested too deep, or just recursive
+    MP_STACK_CHECK();
+    if (MP_OBJ_IS_SMALL_INT(obj)) {
+        char buf[sizeof(mp_int_t) * 3 + 2];
+        char *p = buf + sizeof(buf);
+        mp_int_t val = MP_OBJ_SMALL_INT_VALUE(obj);
+        mp_uint_t u = val < 0 ? -(mp_uint_t)val : (mp_uint_t)val;
+        do {
+            *--p = '0' + u % 10;
+            u /= 10;
+        } while (u != 0);
+        if (val < 0) {
+            *--p = '-';
+        }
+        print->print_strn(print->data, p, buf + sizeof(buf) - p);
+    } else if (MP_OBJ_IS_STR(obj)) {
+        GET_STR_DATA_LEN(obj, str_data, str_len);
+        mp_str_print_json(print, str_data, str_len);
+    } else if (obj == mp_const_none) {
+        mp_print_str(print, "null");
+    } else if (obj == mp_const_true) {
+        mp_print_str(print, "true");
+    } else if (obj == mp_const_false) {
+        mp_print_str(print, "false");
+    } else if (MP_OBJ_IS_TYPE(obj, &mp_type_list) || MP_OBJ_IS_TYPE(obj, &mp_type_tuple)) {
+        mp_uint_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(obj, &len, &items);
+        mp_print_str(print, "[");
+        for (mp_uint_t i = 0; i < len; i++) {
+            if (i > 0) {
+                mp_print_str(print, ", ");
+            }
+            ujson_encode(print, items[i]);
+        }
+        mp_print_str(print, "]");
+    } else if (MP_OBJ_IS_TYPE(obj, &mp_type_dict)) {
+        mp_map_t *map = mp_obj_dict_get_map(obj);
+        bool first = true;
+        mp_print_str(print, "{");
+        for (mp_uint_t i = 0; i < map->alloc; i++) {
+            if (MP_MAP_SLOT_IS_FILLED(map, i)) {
+                if (!first) {
+                    mp_print_str(print, ", ");
+                }
+                first = false;
+                ujson_encode(print, map->table[i].key);
+                mp_print_str(print, ": ");
+                ujson_encode(print, map->table[i].value);
+            }
+        }
+        mp_print_str(print, "}");
+    #if MICROPY_PY_BUILTINS_FLOAT
+    } else if (mp_obj_is_float(obj)) {
+        // same format as float_print
+        #if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_FLOAT
+        char buf[16];
+        const int precision = 7;
+        #else
+        char buf[32];
+        const int precision = 16;
+        #endif
+        mp_format_float(mp_obj_float_get(obj), buf, sizeof(buf), 'g', precision, '\0');
+        mp_print_str(print, buf);
+        if (strchr(buf, '.') == NULL && strchr(buf, 'e') == NULL && strchr(buf, 'n') == NULL) {
+            mp_print_str(print, ".0");
+        }
+    #endif
+    } else {
+        mp_obj_print_helper(print, obj, PRINT_JSON);
+    }
+}
+
+// For dump the encoder output is collected in a small buffer, which is
+// written to the stream each time it fills up.  So the memory needed doesn't
+// depend on the size of the output, and the stream sees reasonably sized writes.
+typedef struct _ujson_stream_print_t {
+    mp_obj_t stream_obj;
+    size_t len;
+    byte buf[MICROPY_PY_UJSON_DUMP_BUF_SIZE];
+} ujson_stream_print_t;
+
+STATIC void ujson_stream_write(mp_obj_t stream_obj, const void *buf, size_t len) {
+    int errcode;
+    mp_stream_write_exactly(stream_obj, buf, len, &errcode);
+    if (errcode != 0) {
+        mp_raise_OSError(errcode);
+    }
+}
+
+STATIC void ujson_stream_print_strn(void *data, const char *str, size_t len) {
+    ujson_stream_print_t *sp = data;
+    if (sp->len + len > sizeof(sp->buf)) {
+        if (sp->len > 0) {
+            ujson_stream_write(sp->stream_obj, sp->buf, sp->len);
+            sp->len = 0;
+        }
+        if (len > sizeof(sp->buf)) {
+            // too big to buffer, so write it straight out
+            ujson_stream_write(sp->stream_obj, str, len);
+            return;
+        }
+    }
+    memcpy(sp->buf + sp->len, str, len);
+    sp->len += len;
+}
+
+STATIC mp_obj_t mod_ujson_dump(mp_obj_t obj, mp_obj_t stream_obj) {
+    mp_get_stream_raise(stream_obj, MP_STREAM_OP_WRITE);
+    ujson_stream_print_t sp;
+    sp.stream_obj = stream_obj;
+    sp.len = 0;
+    mp_print_t print = {&sp, ujson_stream_print_strn};
+    ujson_encode(&print, obj);
+    if (sp.len > 0) {
+        ujson_stream_write(stream_obj, sp.buf, sp.len);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_ujson_dump_obj, mod_ujson_dump);
+
 STATIC mp_obj_t mod_ujson_dumps(mp_obj_t obj) {
     vstr_t vstr;
     mp_print_t print;
     vstr_init_print(&vstr, 8, &print);
-    mp_obj_print_helper(&print, obj, PRINT_JSON);
+    ujson_encode(&print, obj);
     return mp_obj_new_str_from_vstr(&mp_type_str, &vstr);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_dumps_obj, mod_ujson_dumps);
 
-// The function below implements a simple non-recursive JSON parser.
+// The functions below implement a simple non-recursive JSON parser.
 //
 // The JSON specification is at http://www.ietf.org/rfc/rfc4627.txt
 // The parser here will parse any valid JSON and return the correct
@@ -56,51 +185,89 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_dumps_obj, mod_ujson_dumps);
 // Most of the work is parsing the primitives (null, false, true, numbers,
 // strings).  It does 1 pass over the input stream.  It tries to be fast and
 // small in code size, while not using more RAM than necessary.
+//
+// Input from a stream is read in blocks into a small buffer, while loads
+// parses the string data in place.
 
 typedef struct _ujson_stream_t {
     mp_obj_t stream_obj;
     mp_uint_t (*read)(mp_obj_t obj, void *buf, mp_uint_t size, int *errcode);
-    int errcode;
+    const byte *pos; // next byte of input
+    const byte *end; // end of the input that is currently available
+    byte *buf; // buffer to read blocks of the stream into
     byte cur;
 } ujson_stream_t;
 
 #define S_EOF (0) // null is not allowed in json stream so is ok as EOF marker
 #define S_END(s) ((s).cur == S_EOF)
 #define S_CUR(s) ((s).cur)
-#define S_NEXT(s) (ujson_stream_next(&(s)))
+#define S_NEXT(s) ((s).pos < (s).end ? ((s).cur = *(s).pos++) : ujson_stream_fill(&(s)))
 
-STATIC byte ujson_stream_next(ujson_stream_t *s) {
-    mp_uint_t ret = s->read(s->stream_obj, &s->cur, 1, &s->errcode);
-    if (s->errcode != 0) {
-        mp_raise_OSError(s->errcode);
-    }
-    if (ret == 0) {
-        s->cur = S_EOF;
+STATIC byte ujson_stream_fill(ujson_stream_t *s) {
+    s->cur = S_EOF;
+    if (s->read != NULL) {
+        int errcode;
+        mp_uint_t ret = s->read(s->stream_obj, s->buf, MICROPY_PY_UJSON_LOAD_BUF_SIZE, &errcode);
+        if (ret == MP_STREAM_ERROR) {
+            mp_raise_OSError(errcode);
+        }
+        if (ret > 0) {
+            s->pos = s->buf;
+            s->end = s->buf + ret;
+            s->cur = *s->pos++;
+        }
     }
     return s->cur;
 }
 
-STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
+STATIC void ujson_stream_init(ujson_stream_t *s, mp_obj_t stream_obj, byte *buf) {
     const mp_stream_p_t *stream_p = mp_get_stream_raise(stream_obj, MP_STREAM_OP_READ);
-    ujson_stream_t s = {stream_obj, stream_p->read, 0, 0};
-    vstr_t vstr;
-    vstr_init(&vstr, 8);
-    mp_obj_list_t stack; // we use a list as a simple stack for nested JSON
-    stack.len = 0;
-    stack.items = NULL;
-    mp_obj_t stack_top = MP_OBJ_NULL;
-    mp_obj_type_t *stack_top_type = NULL;
-    mp_obj_t stack_key = MP_OBJ_NULL;
-    S_NEXT(s);
+    s->stream_obj = stream_obj;
+    s->read = stream_p->read;
+    s->pos = s->end = buf;
+    s->buf = buf;
+    S_NEXT(*s);
+}
+
+STATIC void ujson_stream_init_data(ujson_stream_t *s, const byte *data, size_t len) {
+    s->stream_obj = MP_OBJ_NULL;
+    s->read = NULL;
+    s->pos = data;
+    s->end = data + len;
+    s->buf = NULL;
+    S_NEXT(*s);
+}
+
+STATIC NORETURN void ujson_syntax_error(void) {
+    nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "syntax error in JSON"));
+}
+
+// how to create a str object
+enum {
+    UJSON_STR_VALUE, // new str object
+    UJSON_STR_KEY, // use the qstr for the data if there is one
+    UJSON_STR_INTERN, // make a qstr for the data
+};
+
+enum {
+    UJSON_TOK_EOF,
+    UJSON_TOK_VALUE,
+    UJSON_TOK_START_LIST,
+    UJSON_TOK_END_LIST,
+    UJSON_TOK_START_DICT,
+    UJSON_TOK_END_DICT,
+};
+
+// Parse the next token from the input, returning its kind.  For a value the
+// object is stored in *value, and str_kind says how to make a string.  vstr
+// is scratch space for strings and numbers.
+STATIC int ujson_next_token(ujson_stream_t *s, vstr_t *vstr, int str_kind, mp_obj_t *value) {
     for (;;) {
-        cont:
-        if (S_END(s)) {
-            break;
+        if (S_END(*s)) {
+            return UJSON_TOK_EOF;
         }
-        mp_obj_t next = MP_OBJ_NULL;
-        bool enter = false;
-        byte cur = S_CUR(s);
-        S_NEXT(s);
+        byte cur = S_CUR(*s);
+        S_NEXT(*s);
         switch (cur) {
             case ',':
             case ':':
@@ -108,37 +275,34 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
             case '\t':
             case '\n':
             case '\r':
-                goto cont;
+                continue;
             case 'n':
-                if (S_CUR(s) == 'u' && S_NEXT(s) == 'l' && S_NEXT(s) == 'l') {
-                    S_NEXT(s);
-                    next = mp_const_none;
-                } else {
-                    goto fail;
+                if (S_CUR(*s) == 'u' && S_NEXT(*s) == 'l' && S_NEXT(*s) == 'l') {
+                    S_NEXT(*s);
+                    *value = mp_const_none;
+                    return UJSON_TOK_VALUE;
                 }
                 break;
             case 'f':
-                if (S_CUR(s) == 'a' && S_NEXT(s) == 'l' && S_NEXT(s) == 's' && S_NEXT(s) == 'e') {
-                    S_NEXT(s);
-                    next = mp_const_false;
-                } else {
-                    goto fail;
+                if (S_CUR(*s) == 'a' && S_NEXT(*s) == 'l' && S_NEXT(*s) == 's' && S_NEXT(*s) == 'e') {
+                    S_NEXT(*s);
+                    *value = mp_const_false;
+                    return UJSON_TOK_VALUE;
                 }
                 break;
             case 't':
-                if (S_CUR(s) == 'r' && S_NEXT(s) == 'u' && S_NEXT(s) == 'e') {
-                    S_NEXT(s);
-                    next = mp_const_true;
-                } else {
-                    goto fail;
+                if (S_CUR(*s) == 'r' && S_NEXT(*s) == 'u' && S_NEXT(*s) == 'e') {
+                    S_NEXT(*s);
+                    *value = mp_const_true;
+                    return UJSON_TOK_VALUE;
                 }
                 break;
             case '"':
-                vstr_reset(&vstr);
-                for (; !S_END(s) && S_CUR(s) != '"';) {
-                    byte c = S_CUR(s);
+                vstr_reset(vstr);
+                for (; !S_END(*s) && S_CUR(*s) != '"';) {
+                    byte c = S_CUR(*s);
                     if (c == '\\') {
-                        c = S_NEXT(s);
+                        c = S_NEXT(*s);
                         switch (c) {
                             case 'b': c = 0x08; break;
                             case 'f': c = 0x0c; break;
@@ -148,75 +312,130 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
                             case 'u': {
                                 mp_uint_t num = 0;
                                 for (int i = 0; i < 4; i++) {
-                                    c = (S_NEXT(s) | 0x20) - '0';
+                                    c = (S_NEXT(*s) | 0x20) - '0';
                                     if (c > 9) {
                                         c -= ('a' - ('9' + 1));
                                     }
                                     num = (num << 4) | c;
                                 }
-                                vstr_add_char(&vstr, num);
+                                vstr_add_char(vstr, num);
                                 goto str_cont;
                             }
                         }
+                    } else {
+                        // copy the run of plain chars that follows straight from the input
+                        const byte *run = s->pos;
+                        while (run < s->end && *run != '"' && *run != '\\' && *run != S_EOF) {
+                            run++;
+                        }
+                        vstr_add_byte(vstr, c);
+                        vstr_add_strn(vstr, (const char*)s->pos, run - s->pos);
+                        s->pos = run;
+                        goto str_cont;
                     }
-                    vstr_add_byte(&vstr, c);
+                    vstr_add_byte(vstr, c);
                 str_cont:
-                    S_NEXT(s);
+                    S_NEXT(*s);
                 }
-                if (S_END(s)) {
-                    goto fail;
+                if (S_END(*s)) {
+                    break;
                 }
-                S_NEXT(s);
-                next = mp_obj_new_str(vstr.buf, vstr.len, false);
-                break;
+                S_NEXT(*s);
+                if (str_kind == UJSON_STR_VALUE) {
+                    // searching the qstr pool for values isn't worth the time it takes
+                    *value = mp_obj_new_str_of_type(&mp_type_str, (const byte*)vstr->buf, vstr->len);
+                } else {
+                    bool make_qstr = str_kind == UJSON_STR_INTERN && vstr->len < (1 << (8 * MICROPY_QSTR_BYTES_IN_LEN));
+                    *value = mp_obj_new_str(vstr->buf, vstr->len, make_qstr);
+                }
+                return UJSON_TOK_VALUE;
             case '-':
             case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9': {
                 bool flt = false;
-                vstr_reset(&vstr);
+                // the value is accumulated as long as it's a simple small int
+                bool small = true;
+                bool neg = cur == '-';
+                mp_int_t val = neg ? 0 : cur - '0';
+                vstr_reset(vstr);
                 for (;;) {
-                    vstr_add_byte(&vstr, cur);
-                    cur = S_CUR(s);
+                    vstr_add_byte(vstr, cur);
+                    cur = S_CUR(*s);
                     if (cur == '.' || cur == 'E' || cur == 'e') {
                         flt = true;
-                    } else if (cur == '-' || unichar_isdigit(cur)) {
-                        // pass
+                    } else if (unichar_isdigit(cur)) {
+                        if (val > MP_SMALL_INT_MAX / 10 - 1) {
+                            small = false;
+                        }
+                        if (small) {
+                            val = val * 10 + (cur - '0');
+                        }
+                    } else if (cur == '-') {
+                        small = false;
                     } else {
                         break;
                     }
-                    S_NEXT(s);
+                    S_NEXT(*s);
                 }
-                if (flt) {
-                    next = mp_parse_num_decimal(vstr.buf, vstr.len, false, false, NULL);
+                if (small && !flt && vstr->len > (size_t)neg) {
+                    *value = MP_OBJ_NEW_SMALL_INT(neg ? -val : val);
+                } else if (flt) {
+                    *value = mp_parse_num_decimal(vstr->buf, vstr->len, false, false, NULL);
                 } else {
-                    next = mp_parse_num_integer(vstr.buf, vstr.len, 10, NULL);
+                    *value = mp_parse_num_integer(vstr->buf, vstr->len, 10, NULL);
                 }
-                break;
+                return UJSON_TOK_VALUE;
             }
             case '[':
-                next = mp_obj_new_list(0, NULL);
-                enter = true;
-                break;
+                return UJSON_TOK_START_LIST;
+            case ']':
+                return UJSON_TOK_END_LIST;
             case '{':
-                next = mp_obj_new_dict(0);
-                enter = true;
-                break;
+                return UJSON_TOK_START_DICT;
             case '}':
-            case ']': {
-                if (stack_top == MP_OBJ_NULL) {
-                    // no object at all
-                    goto fail;
-                }
-                if (stack.len == 0) {
-                    // finished; compound object
-                    goto success;
-                }
-                stack.len -= 1;
-                stack_top = stack.items[stack.len];
-                stack_top_type = mp_obj_get_type(stack_top);
-                goto cont;
-            }
-            default:
+                return UJSON_TOK_END_DICT;
+        }
+        ujson_syntax_error();
+    }
+}
+
+STATIC mp_obj_t ujson_load(ujson_stream_t *s, bool intern_keys) {
+    vstr_t vstr;
+    vstr_init(&vstr, 8);
+    mp_obj_list_t stack; // we use a list as a simple stack for nested JSON
+    stack.len = 0;
+    stack.items = NULL;
+    mp_obj_t stack_top = MP_OBJ_NULL;
+    mp_obj_type_t *stack_top_type = NULL;
+    mp_obj_t stack_key = MP_OBJ_NULL;
+    for (;;) {
+        mp_obj_t next = MP_OBJ_NULL;
+        bool enter = false;
+        int str_kind = UJSON_STR_VALUE;
+        if (stack_top_type == &mp_type_dict && stack_key == MP_OBJ_NULL) {
+            str_kind = intern_keys ? UJSON_STR_INTERN : UJSON_STR_KEY;
+        }
+        int tok = ujson_next_token(s, &vstr, str_kind, &next);
+        if (tok == UJSON_TOK_EOF) {
+            break;
+        } else if (tok == UJSON_TOK_START_LIST) {
+            next = mp_obj_new_list(0, NULL);
+            enter = true;
+        } else if (tok == UJSON_TOK_START_DICT) {
+            next = mp_obj_new_dict(0);
+            enter = true;
+        } else if (tok != UJSON_TOK_VALUE) {
+            if (stack_top == MP_OBJ_NULL) {
+                // no object at all
                 goto fail;
+            }
+            if (stack.len == 0) {
+                // finished; compound object
+                goto success;
+            }
+            stack.len -= 1;
+            stack_top = stack.items[stack.len];
+            stack_top_type = mp_obj_get_type(stack_top);
+            continue;
         }
         if (stack_top == MP_OBJ_NULL) {
             stack_top = next;
@@ -254,10 +473,10 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
     }
     success:
     // eat trailing whitespace
-    while (unichar_isspace(S_CUR(s))) {
-        S_NEXT(s);
+    while (unichar_isspace(S_CUR(*s))) {
+        S_NEXT(*s);
     }
-    if (!S_END(s)) {
+    if (!S_END(*s)) {
         // unexpected chars
         goto fail;
     }
@@ -269,24 +488,144 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
     return stack_top;
 
     fail:
-    nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "syntax error in JSON"));
+    ujson_syntax_error();
+}
+
+// Parse the intern_keys keyword argument of the load functions.  Interning
+// dict keys as qstrs means repeated documents share the memory for their
+// keys, and looking them up in the dict compares pointers.  But qstrs are
+// never freed, so this is only suitable for a bounded set of keys.
+STATIC bool ujson_get_intern_keys(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_intern_keys, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    return args[0].u_bool;
+}
+
+STATIC mp_obj_t mod_ujson_load(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    bool intern_keys = ujson_get_intern_keys(n_args, pos_args, kw_args);
+    byte buf[MICROPY_PY_UJSON_LOAD_BUF_SIZE];
+    ujson_stream_t s;
+    ujson_stream_init(&s, pos_args[0], buf);
+    return ujson_load(&s, intern_keys);
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_load_obj, mod_ujson_load);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_ujson_load_obj, 1, mod_ujson_load);
 
-STATIC mp_obj_t mod_ujson_loads(mp_obj_t obj) {
+STATIC mp_obj_t mod_ujson_loads(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    bool intern_keys = ujson_get_intern_keys(n_args, pos_args, kw_args);
     mp_uint_t len;
-    const char *buf = mp_obj_str_get_data(obj, &len);
-    vstr_t vstr = {len, len, (char*)buf, true};
-    mp_obj_stringio_t sio = {{&mp_type_stringio}, &vstr, 0};
-    return mod_ujson_load(MP_OBJ_FROM_PTR(&sio));
+    const char *data = mp_obj_str_get_data(pos_args[0], &len);
+    ujson_stream_t s;
+    ujson_stream_init_data(&s, (const byte*)data, len);
+    return ujson_load(&s, intern_keys);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_ujson_loads_obj, 1, mod_ujson_loads);
+
+// Incremental parser, which yields an (event, value) tuple for each part of
+// the input rather than building the objects, so it can process documents
+// that don't fit in memory.  The events are "start_map", "map_key",
+// "end_map", "start_array", "end_array" and "value", and value is the key
+// or value for "map_key" and "value" events, else None.  The input may
+// consist of several consecutive documents.
+
+typedef struct _ujson_iter_t {
+    mp_obj_base_t base;
+    ujson_stream_t s;
+    vstr_t vstr;
+    // one entry for each open container: '[' for a list, and for a dict 'k'
+    // if a key comes next or 'v' if a value does
+    vstr_t stack;
+    bool intern_keys;
+    byte buf[MICROPY_PY_UJSON_LOAD_BUF_SIZE];
+} ujson_iter_t;
+
+STATIC mp_obj_t ujson_iter_iternext(mp_obj_t self_in) {
+    ujson_iter_t *self = MP_OBJ_TO_PTR(self_in);
+    char *state = self->stack.len > 0 ? &self->stack.buf[self->stack.len - 1] : NULL;
+    bool is_key = state != NULL && *state == 'k';
+    mp_obj_t items[2] = {MP_OBJ_NULL, mp_const_none};
+    int str_kind = UJSON_STR_VALUE;
+    if (is_key) {
+        str_kind = self->intern_keys ? UJSON_STR_INTERN : UJSON_STR_KEY;
+    }
+    int tok = ujson_next_token(&self->s, &self->vstr, str_kind, &items[1]);
+    switch (tok) {
+        case UJSON_TOK_EOF:
+            if (state != NULL) {
+                // input ended inside a container
+                ujson_syntax_error();
+            }
+            return MP_OBJ_STOP_ITERATION;
+        case UJSON_TOK_VALUE:
+            if (is_key) {
+                if (!MP_OBJ_IS_STR(items[1])) {
+                    ujson_syntax_error();
+                }
+                *state = 'v';
+                items[0] = MP_OBJ_NEW_QSTR(MP_QSTR_map_key);
+            } else {
+                if (state != NULL && *state == 'v') {
+                    *state = 'k';
+                }
+                items[0] = MP_OBJ_NEW_QSTR(MP_QSTR_value);
+            }
+            break;
+        case UJSON_TOK_START_LIST:
+        case UJSON_TOK_START_DICT:
+            if (is_key) {
+                ujson_syntax_error();
+            }
+            if (state != NULL && *state == 'v') {
+                *state = 'k';
+            }
+            if (tok == UJSON_TOK_START_LIST) {
+                vstr_add_byte(&self->stack, '[');
+                items[0] = MP_OBJ_NEW_QSTR(MP_QSTR_start_array);
+            } else {
+                vstr_add_byte(&self->stack, 'k');
+                items[0] = MP_OBJ_NEW_QSTR(MP_QSTR_start_map);
+            }
+            break;
+        default:
+            if (state == NULL || *state != (tok == UJSON_TOK_END_LIST ? '[' : 'k')) {
+                // no container open, or mismatched brackets
+                ujson_syntax_error();
+            }
+            self->stack.len -= 1;
+            items[0] = MP_OBJ_NEW_QSTR(tok == UJSON_TOK_END_LIST ? MP_QSTR_end_array : MP_QSTR_end_map);
+            break;
+    }
+    return mp_obj_new_tuple(2, items);
+}
+
+STATIC const mp_obj_type_t ujson_iter_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_iterator,
+    .getiter = mp_identity,
+    .iternext = ujson_iter_iternext,
+};
+
+STATIC mp_obj_t mod_ujson_iterload(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    bool intern_keys = ujson_get_intern_keys(n_args, pos_args, kw_args);
+    ujson_iter_t *o = m_new_obj(ujson_iter_t);
+    o->base.type = &ujson_iter_type;
+    vstr_init(&o->vstr, 8);
+    vstr_init(&o->stack, 8);
+    o->intern_keys = intern_keys;
+    ujson_stream_init(&o->s, pos_args[0], o->buf);
+    return MP_OBJ_FROM_PTR(o);
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_loads_obj, mod_ujson_loads);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_ujson_iterload_obj, 1, mod_ujson_iterload);
 
 STATIC const mp_rom_map_elem_t mp_module_ujson_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ujson) },
+    { MP_ROM_QSTR(MP_QSTR_dump), MP_ROM_PTR(&mod_ujson_dump_obj) },
     { MP_ROM_QSTR(MP_QSTR_dumps), MP_ROM_PTR(&mod_ujson_dumps_obj) },
     { MP_ROM_QSTR(MP_QSTR_load), MP_ROM_PTR(&mod_ujson_load_obj) },
     { MP_ROM_QSTR(MP_QSTR_loads), MP_ROM_PTR(&mod_ujson_loads_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iterload), MP_ROM_PTR(&mod_ujson_iterload_obj) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_ujson_globals, mp_module_ujson_globals_table);
@@ -37,9 +37,16 @@
 #include "re1.5/re1.5.h"
 
 #define FLAG_DEBUG 0x1000
+#define FLAG_LINEAR 0x2000
 
 typedef struct _mp_obj_re_t {
     mp_obj_base_t base;
+    #if MICROPY_PY_URE_LINEAR
+    // work area for the Pike VM, allocated on first use; NULL if the
+    // backtracking matcher is used
+    void *pike_work;
+    bool linear;
+    #endif
     ByteProg re;
 } mp_obj_re_t;
 
@@ -92,6 +99,44 @@ STATIC void re_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t
     mp_printf(print, "<re %p>", self);
 }
 
+// Run the pattern over subj with the matcher it was compiled for.  caps must
+// be cleared by the caller.
+STATIC int ure_run(mp_obj_re_t *self, Subject *subj, const char **caps, int caps_num, bool is_anchored) {
+    Subject s = *subj;
+    if (!is_anchored && self->re.start != START_ANY) {
+        // skip to the first place where a match may start
+        s.begin = re1_5_nextcandidate(&self->re, s.begin, s.end);
+        if (s.begin == NULL) {
+            return 0;
+        }
+    }
+    #if MICROPY_PY_URE_LINEAR
+    if (self->linear) {
+        // the work area is only used during the call, so can be shared
+        // by all uses of the pattern
+        if (self->pike_work == NULL) {
+            size_t size = re1_5_pikevm_worksize(&self->re, caps_num);
+            self->pike_work = m_new(void*, (size + sizeof(void*) - 1) / sizeof(void*));
+        }
+        return re1_5_pikevm(&self->re, &s, caps, caps_num, is_anchored, self->pike_work);
+    }
+    #endif
+    if (is_anchored || self->re.start == START_ANY) {
+        return re1_5_recursiveloopprog(&self->re, &s, caps, caps_num, is_anchored);
+    }
+    // try an anchored match at each candidate; a failed match leaves caps
+    // cleared
+    for (;;) {
+        if (re1_5_recursiveloopprog(&self->re, &s, caps, caps_num, true)) {
+            return 1;
+        }
+        s.begin = re1_5_nextcandidate(&self->re, s.begin + 1, s.end);
+        if (s.begin == NULL) {
+            return 0;
+        }
+    }
+}
+
 STATIC mp_obj_t ure_exec(bool is_anchored, uint n_args, const mp_obj_t *args) {
     (void)n_args;
     mp_obj_re_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -99,11 +144,13 @@ STATIC mp_obj_t ure_exec(bool is_anchored, uint n_args, const mp_obj_t *args) {
     mp_uint_t len;
     subj.begin = mp_obj_str_get_data(args[1], &len);
     subj.end = subj.begin + len;
+    subj.begin_line = subj.begin;
+    subj.notempty_at = NULL;
     int caps_num = (self->re.sub + 1) * 2;
     mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, char*, caps_num);
     // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
     memset((char*)match->caps, 0, caps_num * sizeof(char*));
-    int res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, is_anchored);
+    int res = ure_run(self, &subj, match->caps, caps_num, is_anchored);
     if (res == 0) {
         m_del_var(mp_obj_match_t, char*, caps_num, match);
         return mp_const_none;
@@ -131,6 +178,8 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
     mp_uint_t len;
     subj.begin = mp_obj_str_get_data(args[1], &len);
     subj.end = subj.begin + len;
+    subj.begin_line = subj.begin;
+    subj.notempty_at = NULL;
     int caps_num = (self->re.sub + 1) * 2;
 
     int maxsplit = 0;
@@ -143,7 +192,7 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
     while (true) {
         // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
         memset((char**)caps, 0, caps_num * sizeof(char*));
-        int res = re1_5_recursiveloopprog(&self->re, &subj, caps, caps_num, false);
+        int res = ure_run(self, &subj, caps, caps_num, false);
 
         // if we didn't have a match, or had an empty match, it's time to stop
         if (!res || caps[0] == caps[1]) {
@@ -167,10 +216,204 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_split_obj, 2, 3, re_split);
 
+#if MICROPY_PY_URE_SUB
+
+// Search subj for the next match, from pos on.  If must_advance is set, the
+// previous match was empty and at pos, so as in CPython 3.7 a match at pos
+// must not be empty; a non-empty one, or any match further on, is accepted.
+// A match found from pos ends at pos only if it's empty and at pos, so the
+// matchers are told to reject matches ending there.
+STATIC bool ure_search_next(mp_obj_re_t *self, const Subject *subj, const char *pos,
+    bool must_advance, const char **caps, int caps_num) {
+    Subject s = *subj;
+    s.begin = pos;
+    s.notempty_at = must_advance ? pos : NULL;
+    memset((char**)caps, 0, caps_num * sizeof(char*));
+    return ure_run(self, &s, caps, caps_num, false);
+}
+
+STATIC mp_obj_t match_new(mp_obj_t str, const char **caps, int caps_num) {
+    mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, char*, caps_num);
+    match->base.type = &match_type;
+    match->num_matches = caps_num / 2;
+    match->str = str;
+    memcpy((char**)match->caps, caps, caps_num * sizeof(char*));
+    return MP_OBJ_FROM_PTR(match);
+}
+
+typedef struct _mp_obj_re_finditer_t {
+    mp_obj_base_t base;
+    mp_obj_re_t *re;
+    mp_obj_t str;
+    size_t pos; // offset to search from, or -1 when done
+    bool must_advance;
+} mp_obj_re_finditer_t;
+
+STATIC mp_obj_t re_finditer_iternext(mp_obj_t self_in) {
+    mp_obj_re_finditer_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->pos == (size_t)-1) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    Subject subj;
+    mp_uint_t len;
+    subj.begin = mp_obj_str_get_data(self->str, &len);
+    subj.end = subj.begin + len;
+    subj.begin_line = subj.begin;
+    subj.notempty_at = NULL;
+    int caps_num = (self->re->re.sub + 1) * 2;
+    const char **caps = alloca(caps_num * sizeof(char*));
+    if (!ure_search_next(self->re, &subj, subj.begin + self->pos, self->must_advance, caps, caps_num)) {
+        self->pos = -1;
+        return MP_OBJ_STOP_ITERATION;
+    }
+    self->pos = caps[1] - subj.begin;
+    self->must_advance = caps[0] == caps[1];
+    return match_new(self->str, caps, caps_num);
+}
+
+STATIC const mp_obj_type_t re_finditer_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_iterator,
+    .getiter = mp_identity,
+    .iternext = re_finditer_iternext,
+};
+
+STATIC mp_obj_t re_finditer(mp_obj_t self_in, mp_obj_t str) {
+    mp_uint_t len;
+    mp_obj_str_get_data(str, &len);
+    mp_obj_re_finditer_t *o = m_new_obj(mp_obj_re_finditer_t);
+    o->base.type = &re_finditer_type;
+    o->re = MP_OBJ_TO_PTR(self_in);
+    o->str = str;
+    o->pos = 0;
+    o->must_advance = false;
+    return MP_OBJ_FROM_PTR(o);
+}
+MP_DEFINE_CONST_FUN_OBJ_2(re_finditer_obj, re_finditer);
+
+// Append the replacement template to vstr, expanding escapes and the group
+// references \0 to \99 and \g<n>; groups which didn't match expand to nothing
+STATIC void ure_expand_template(vstr_t *vstr, mp_obj_t repl, const char **caps, int caps_num) {
+    mp_uint_t len;
+    const char *p = mp_obj_str_get_data(repl, &len);
+    const char *top = p + len;
+    while (p < top) {
+        const char *esc = memchr(p, '\\', top - p);
+        if (esc == NULL) {
+            vstr_add_strn(vstr, p, top - p);
+            break;
+        }
+        vstr_add_strn(vstr, p, esc - p);
+        p = esc + 1;
+        if (p == top) {
+            vstr_add_byte(vstr, '\\');
+            break;
+        }
+        char c = *p++;
+        int no = -1;
+        if (unichar_isdigit(c)) {
+            no = c - '0';
+            if (p < top && unichar_isdigit(*p)) {
+                no = no * 10 + *p++ - '0';
+            }
+        } else if (c == 'g') {
+            const char *end = p < top && *p == '<' ? memchr(p, '>', top - p) : NULL;
+            if (end == NULL || end == p + 1) {
+                goto bad_group;
+            }
+            no = 0;
+            for (p++; p < end; p++) {
+                if (!unichar_isdigit(*p)) {
+                    goto bad_group;
+                }
+                no = no * 10 + *p - '0';
+            }
+            p++;
+        } else {
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case '\\': break;
+                default: vstr_add_byte(vstr, '\\'); break;
+            }
+            vstr_add_byte(vstr, c);
+            continue;
+        }
+        if (no >= caps_num / 2) {
+            goto bad_group;
+        }
+        const char *start = caps[no * 2];
+        if (start != NULL) {
+            vstr_add_strn(vstr, start, caps[no * 2 + 1] - start);
+        }
+    }
+    return;
+
+bad_group:
+    nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "invalid group reference"));
+}
+
+// args are repl, string[, count]
+STATIC mp_obj_t ure_sub_helper(mp_obj_re_t *self, size_t n_args, const mp_obj_t *args) {
+    mp_obj_t repl = args[0];
+    mp_obj_t where = args[1];
+    mp_int_t count = 0;
+    if (n_args > 2) {
+        count = mp_obj_get_int(args[2]);
+    }
+    bool repl_is_callable = mp_obj_is_callable(repl);
+
+    Subject subj;
+    mp_uint_t len;
+    subj.begin = mp_obj_str_get_data(where, &len);
+    subj.end = subj.begin + len;
+    subj.begin_line = subj.begin;
+    subj.notempty_at = NULL;
+    int caps_num = (self->re.sub + 1) * 2;
+    const char **caps = alloca(caps_num * sizeof(char*));
+
+    vstr_t vstr;
+    vstr_init(&vstr, len);
+    const char *pos = subj.begin;
+    bool must_advance = false;
+    for (mp_int_t n = 0; count == 0 || n < count; n++) {
+        if (!ure_search_next(self, &subj, pos, must_advance, caps, caps_num)) {
+            break;
+        }
+        vstr_add_strn(&vstr, pos, caps[0] - pos);
+        if (repl_is_callable) {
+            mp_obj_t r = mp_call_function_1(repl, match_new(where, caps, caps_num));
+            mp_uint_t rlen;
+            const char *rstr = mp_obj_str_get_data(r, &rlen);
+            vstr_add_strn(&vstr, rstr, rlen);
+        } else {
+            ure_expand_template(&vstr, repl, caps, caps_num);
+        }
+        // text between matches is copied from pos, so an empty match must
+        // not move it back
+        pos = caps[1];
+        must_advance = caps[0] == caps[1];
+    }
+    vstr_add_strn(&vstr, pos, subj.end - pos);
+    return mp_obj_new_str_from_vstr(mp_obj_get_type(where), &vstr);
+}
+
+STATIC mp_obj_t re_sub(size_t n_args, const mp_obj_t *args) {
+    return ure_sub_helper(MP_OBJ_TO_PTR(args[0]), n_args - 1, args + 1);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_sub_obj, 3, 4, re_sub);
+
+#endif
+
 STATIC const mp_rom_map_elem_t re_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_match), MP_ROM_PTR(&re_match_obj) },
     { MP_ROM_QSTR(MP_QSTR_search), MP_ROM_PTR(&re_search_obj) },
     { MP_ROM_QSTR(MP_QSTR_split), MP_ROM_PTR(&re_split_obj) },
+    #if MICROPY_PY_URE_SUB
+    { MP_ROM_QSTR(MP_QSTR_finditer), MP_ROM_PTR(&re_finditer_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sub), MP_ROM_PTR(&re_sub_obj) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(re_locals_dict, re_locals_dict_table);
@@ -190,6 +433,9 @@ STATIC mp_obj_t mod_re_compile(size_t n_args, const mp_obj_t *args) {
     }
     mp_obj_re_t *o = m_new_obj_var(mp_obj_re_t, char, size);
     o->base.type = &re_type;
+    #if MICROPY_PY_URE_LINEAR
+    o->pike_work = NULL;
+    #endif
     int flags = 0;
     if (n_args > 1) {
         flags = mp_obj_get_int(args[1]);
@@ -199,6 +445,9 @@ STATIC mp_obj_t mod_re_compile(size_t n_args, const mp_obj_t *args) {
 error:
         nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "Error in regex"));
     }
+    #if MICROPY_PY_URE_LINEAR
+    o->linear = (flags & FLAG_LINEAR) != 0;
+    #endif
     if (flags & FLAG_DEBUG) {
         re1_5_dumpcode(&o->re);
     }
@@ -225,12 +474,32 @@ STATIC mp_obj_t mod_re_search(size_t n_args, const mp_obj_t *args) {
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_re_search_obj, 2, 4, mod_re_search);
 
+#if MICROPY_PY_URE_SUB
+STATIC mp_obj_t mod_re_finditer(mp_obj_t pattern, mp_obj_t str) {
+    return re_finditer(mod_re_compile(1, &pattern), str);
+}
+MP_DEFINE_CONST_FUN_OBJ_2(mod_re_finditer_obj, mod_re_finditer);
+
+STATIC mp_obj_t mod_re_sub(size_t n_args, const mp_obj_t *args) {
+    mp_obj_t self = mod_re_compile(1, args);
+    return ure_sub_helper(MP_OBJ_TO_PTR(self), n_args - 1, args + 1);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_re_sub_obj, 3, 4, mod_re_sub);
+#endif
+
 STATIC const mp_rom_map_elem_t mp_module_re_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ure) },
     { MP_ROM_QSTR(MP_QSTR_compile), MP_ROM_PTR(&mod_re_compile_obj) },
     { MP_ROM_QSTR(MP_QSTR_match), MP_ROM_PTR(&mod_re_match_obj) },
     { MP_ROM_QSTR(MP_QSTR_search), MP_ROM_PTR(&mod_re_search_obj) },
+    #if MICROPY_PY_URE_SUB
+    { MP_ROM_QSTR(MP_QSTR_finditer), MP_ROM_PTR(&mod_re_finditer_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sub), MP_ROM_PTR(&mod_re_sub_obj) },
+    #endif
     { MP_ROM_QSTR(MP_QSTR_DEBUG), MP_ROM_INT(FLAG_DEBUG) },
+    #if MICROPY_PY_URE_LINEAR
+    { MP_ROM_QSTR(MP_QSTR_LINEAR), MP_ROM_INT(FLAG_LINEAR) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_re_globals, mp_module_re_globals_table);
@@ -248,5 +517,8 @@ const mp_obj_module_t mp_module_ure = {
 #include "re1.5/dumpcode.c"
 #include "re1.5/recursiveloop.c"
 #include "re1.5/charclass.c"
+#if MICROPY_PY_URE_LINEAR
+#include "re1.5/pike.c"
+#endif
 
 #endif //MICROPY_PY_URE
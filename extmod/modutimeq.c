@@ -0,0 +1,358 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Pycom Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "py/nlr.h"
+#include "py/objlist.h"
+#include "py/smallint.h"
+#include "py/runtime0.h"
+#include "py/runtime.h"
+
+#if MICROPY_PY_UTIMEQ
+
+// Queues for a cooperative scheduler that don't allocate once created:
+// utimeq is a heap of (time, callback, args) entries ordered by time, where
+// times are utime ticks values and so may wrap around, and runq is a FIFO
+// of (callback, args) entries in a ring buffer.  Entries are taken off into
+// a list given by the caller.
+
+#define MODULO (MICROPY_PY_UTIME_TICKS_PERIOD - 1)
+
+/// \class utimeq - queue of callbacks ordered by time
+
+struct qentry {
+    mp_uint_t time;
+    mp_uint_t id;
+    mp_obj_t callback;
+    mp_obj_t args;
+};
+
+typedef struct _mp_obj_utimeq_t {
+    mp_obj_base_t base;
+    mp_uint_t alloc;
+    mp_uint_t len;
+    // entries with equal times are taken in the order they were pushed
+    mp_uint_t next_id;
+    struct qentry items[];
+} mp_obj_utimeq_t;
+
+STATIC mp_obj_list_t *get_ret_list(mp_obj_t list_in, mp_uint_t len) {
+    if (!MP_OBJ_IS_TYPE(list_in, &mp_type_list)) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_TypeError, "expecting a list"));
+    }
+    mp_obj_list_t *ret = MP_OBJ_TO_PTR(list_in);
+    if (ret->len < len) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "list too short"));
+    }
+    return ret;
+}
+
+// Get the capacity argument of a queue constructor, checking that the size
+// of the queue object doesn't overflow
+STATIC mp_uint_t get_capacity(mp_obj_t arg, size_t obj_size, size_t entry_size) {
+    mp_int_t alloc = mp_obj_get_int(arg);
+    if (alloc < 0) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "capacity must be non-negative"));
+    }
+    if ((size_t)alloc > (SIZE_MAX - obj_size) / entry_size) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_MemoryError, "capacity too large"));
+    }
+    return alloc;
+}
+
+STATIC void queue_overflow(void) {
+    nlr_raise(mp_obj_new_exception_msg(&mp_type_IndexError, "queue overflow"));
+}
+
+STATIC void queue_empty(void) {
+    nlr_raise(mp_obj_new_exception_msg(&mp_type_IndexError, "empty queue"));
+}
+
+// Whether a comes before b, with times compared like utime.ticks_diff
+STATIC bool time_less_than(const struct qentry *a, const struct qentry *b) {
+    mp_uint_t diff = (a->time - b->time + MICROPY_PY_UTIME_TICKS_PERIOD / 2) & MODULO;
+    if (diff != MICROPY_PY_UTIME_TICKS_PERIOD / 2) {
+        return diff < MICROPY_PY_UTIME_TICKS_PERIOD / 2;
+    }
+    return (mp_int_t)(a->id - b->id) < 0;
+}
+
+// the sifting is as for uheapq
+
+STATIC void heap_siftdown(mp_obj_utimeq_t *heap, mp_uint_t start_pos, mp_uint_t pos) {
+    struct qentry item = heap->items[pos];
+    while (pos > start_pos) {
+        mp_uint_t parent_pos = (pos - 1) >> 1;
+        struct qentry *parent = &heap->items[parent_pos];
+        if (time_less_than(&item, parent)) {
+            heap->items[pos] = *parent;
+            pos = parent_pos;
+        } else {
+            break;
+        }
+    }
+    heap->items[pos] = item;
+}
+
+STATIC void heap_siftup(mp_obj_utimeq_t *heap, mp_uint_t pos) {
+    mp_uint_t start_pos = pos;
+    mp_uint_t end_pos = heap->len;
+    struct qentry item = heap->items[pos];
+    for (mp_uint_t child_pos = 2 * pos + 1; child_pos < end_pos; child_pos = 2 * pos + 1) {
+        // choose right child if it's <= left child
+        if (child_pos + 1 < end_pos && !time_less_than(&heap->items[child_pos], &heap->items[child_pos + 1])) {
+            child_pos += 1;
+        }
+        // bubble up the smaller child
+        heap->items[pos] = heap->items[child_pos];
+        pos = child_pos;
+    }
+    heap->items[pos] = item;
+    heap_siftdown(heap, start_pos, pos);
+}
+
+// Take the entry at pos out of the heap
+STATIC void heap_remove(mp_obj_utimeq_t *heap, mp_uint_t pos) {
+    heap->len -= 1;
+    heap->items[pos] = heap->items[heap->len];
+    memset(&heap->items[heap->len], 0, sizeof(struct qentry)); // so we don't retain pointers
+    if (pos < heap->len) {
+        if (pos > 0 && time_less_than(&heap->items[pos], &heap->items[(pos - 1) >> 1])) {
+            heap_siftdown(heap, 0, pos);
+        } else {
+            heap_siftup(heap, pos);
+        }
+    }
+}
+
+STATIC mp_obj_t utimeq_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    mp_uint_t alloc = get_capacity(args[0], sizeof(mp_obj_utimeq_t), sizeof(struct qentry));
+    mp_obj_utimeq_t *o = m_new_obj_var(mp_obj_utimeq_t, struct qentry, alloc);
+    memset(o->items, 0, sizeof(*o->items) * alloc);
+    o->base.type = type;
+    o->alloc = alloc;
+    o->len = 0;
+    o->next_id = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+/// \method push(time, callback, args)
+STATIC mp_obj_t utimeq_push(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    mp_obj_utimeq_t *heap = MP_OBJ_TO_PTR(args[0]);
+    if (heap->len == heap->alloc) {
+        queue_overflow();
+    }
+    struct qentry *item = &heap->items[heap->len];
+    item->time = mp_obj_get_int_truncated(args[1]) & MODULO;
+    item->id = heap->next_id++;
+    item->callback = args[2];
+    item->args = args[3];
+    heap_siftdown(heap, 0, heap->len++);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(utimeq_push_obj, 4, 4, utimeq_push);
+
+/// \method pop(list)
+/// Take off the earliest entry, storing its time, callback and args in the
+/// first three items of list, which is returned.
+STATIC mp_obj_t utimeq_pop(mp_obj_t heap_in, mp_obj_t list_in) {
+    mp_obj_utimeq_t *heap = MP_OBJ_TO_PTR(heap_in);
+    if (heap->len == 0) {
+        queue_empty();
+    }
+    mp_obj_list_t *ret = get_ret_list(list_in, 3);
+    struct qentry *item = &heap->items[0];
+    ret->items[0] = MP_OBJ_NEW_SMALL_INT(item->time);
+    ret->items[1] = item->callback;
+    ret->items[2] = item->args;
+    heap_remove(heap, 0);
+    return list_in;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(utimeq_pop_obj, utimeq_pop);
+
+/// \method peektime()
+STATIC mp_obj_t utimeq_peektime(mp_obj_t heap_in) {
+    mp_obj_utimeq_t *heap = MP_OBJ_TO_PTR(heap_in);
+    if (heap->len == 0) {
+        queue_empty();
+    }
+    return MP_OBJ_NEW_SMALL_INT(heap->items[0].time);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(utimeq_peektime_obj, utimeq_peektime);
+
+/// \method remove(callback)
+/// Take off the earliest entry for callback, if any; returns whether there
+/// was one.
+STATIC mp_obj_t utimeq_remove(mp_obj_t heap_in, mp_obj_t callback) {
+    mp_obj_utimeq_t *heap = MP_OBJ_TO_PTR(heap_in);
+    mp_uint_t found = heap->len;
+    for (mp_uint_t i = 0; i < heap->len; i++) {
+        if (heap->items[i].callback == callback
+            && (found == heap->len || time_less_than(&heap->items[i], &heap->items[found]))) {
+            found = i;
+        }
+    }
+    if (found == heap->len) {
+        return mp_const_false;
+    }
+    heap_remove(heap, found);
+    return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(utimeq_remove_obj, utimeq_remove);
+
+STATIC mp_obj_t utimeq_unary_op(mp_uint_t op, mp_obj_t self_in) {
+    mp_obj_utimeq_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (op) {
+        case MP_UNARY_OP_BOOL: return mp_obj_new_bool(self->len != 0);
+        case MP_UNARY_OP_LEN: return MP_OBJ_NEW_SMALL_INT(self->len);
+        default: return MP_OBJ_NULL; // op not supported
+    }
+}
+
+STATIC const mp_rom_map_elem_t utimeq_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_push), MP_ROM_PTR(&utimeq_push_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pop), MP_ROM_PTR(&utimeq_pop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_peektime), MP_ROM_PTR(&utimeq_peektime_obj) },
+    { MP_ROM_QSTR(MP_QSTR_remove), MP_ROM_PTR(&utimeq_remove_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(utimeq_locals_dict, utimeq_locals_dict_table);
+
+STATIC const mp_obj_type_t utimeq_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_utimeq,
+    .make_new = utimeq_make_new,
+    .unary_op = utimeq_unary_op,
+    .locals_dict = (void*)&utimeq_locals_dict,
+};
+
+/// \class runq - FIFO queue of callbacks
+
+struct rentry {
+    mp_obj_t callback;
+    mp_obj_t args;
+};
+
+typedef struct _mp_obj_runq_t {
+    mp_obj_base_t base;
+    mp_uint_t alloc;
+    mp_uint_t len;
+    mp_uint_t head; // index of the first entry
+    struct rentry items[];
+} mp_obj_runq_t;
+
+STATIC mp_obj_t runq_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    mp_uint_t alloc = get_capacity(args[0], sizeof(mp_obj_runq_t), sizeof(struct rentry));
+    mp_obj_runq_t *o = m_new_obj_var(mp_obj_runq_t, struct rentry, alloc);
+    memset(o->items, 0, sizeof(*o->items) * alloc);
+    o->base.type = type;
+    o->alloc = alloc;
+    o->len = 0;
+    o->head = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+/// \method push(callback, args)
+STATIC mp_obj_t runq_push(mp_obj_t self_in, mp_obj_t callback, mp_obj_t args) {
+    mp_obj_runq_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->len == self->alloc) {
+        queue_overflow();
+    }
+    mp_uint_t tail = self->head + self->len++;
+    if (tail >= self->alloc) {
+        tail -= self->alloc;
+    }
+    self->items[tail].callback = callback;
+    self->items[tail].args = args;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(runq_push_obj, runq_push);
+
+/// \method pop(list)
+/// Take off the first entry, storing its callback and args in the first two
+/// items of list, which is returned.
+STATIC mp_obj_t runq_pop(mp_obj_t self_in, mp_obj_t list_in) {
+    mp_obj_runq_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->len == 0) {
+        queue_empty();
+    }
+    mp_obj_list_t *ret = get_ret_list(list_in, 2);
+    struct rentry *item = &self->items[self->head];
+    ret->items[0] = item->callback;
+    ret->items[1] = item->args;
+    item->callback = MP_OBJ_NULL; // so we don't retain pointers
+    item->args = MP_OBJ_NULL;
+    if (++self->head == self->alloc) {
+        self->head = 0;
+    }
+    self->len -= 1;
+    return list_in;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(runq_pop_obj, runq_pop);
+
+STATIC mp_obj_t runq_unary_op(mp_uint_t op, mp_obj_t self_in) {
+    mp_obj_runq_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (op) {
+        case MP_UNARY_OP_BOOL: return mp_obj_new_bool(self->len != 0);
+        case MP_UNARY_OP_LEN: return MP_OBJ_NEW_SMALL_INT(self->len);
+        default: return MP_OBJ_NULL; // op not supported
+    }
+}
+
+STATIC const mp_rom_map_elem_t runq_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_push), MP_ROM_PTR(&runq_push_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pop), MP_ROM_PTR(&runq_pop_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(runq_locals_dict, runq_locals_dict_table);
+
+STATIC const mp_obj_type_t runq_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_runq,
+    .make_new = runq_make_new,
+    .unary_op = runq_unary_op,
+    .locals_dict = (void*)&runq_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_utimeq_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_utimeq) },
+    { MP_ROM_QSTR(MP_QSTR_utimeq), MP_ROM_PTR(&utimeq_type) },
+    { MP_ROM_QSTR(MP_QSTR_runq), MP_ROM_PTR(&runq_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_utimeq_globals, mp_module_utimeq_globals_table);
+
+const mp_obj_module_t mp_module_utimeq = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&mp_module_utimeq_globals,
+};
+
+#endif //MICROPY_PY_UTIMEQ
@@ -34,6 +34,7 @@
 
 #if MICROPY_PY_UZLIB
 
+#define TINF_CRC32_SLICE8 (MICROPY_PY_UZLIB_CRC32_SLICE8)
 #include "uzlib/tinf.h"
 
 #if 0 // print debugging info
@@ -42,11 +43,15 @@
 #define DEBUG_printf(...) (void)0
 #endif
 
+// The source stream is read in blocks, so DecompIO may read past the end of
+// the compressed data.  When it reaches the end, the unused part of the last
+// block is given back by seeking, if the source stream supports it.
 typedef struct _mp_obj_decompio_t {
     mp_obj_base_t base;
     mp_obj_t src_stream;
     TINF_DATA decomp;
     bool eof;
+    byte src_buf[MICROPY_PY_UZLIB_DECOMPIO_BUF_SIZE];
 } mp_obj_decompio_t;
 
 STATIC unsigned char read_src_stream(TINF_DATA *data) {
@@ -56,15 +61,31 @@ STATIC unsigned char read_src_stream(TINF_DATA *data) {
 
     const mp_stream_p_t *stream = mp_get_stream_raise(self->src_stream, MP_STREAM_OP_READ);
     int err;
-    byte c;
-    mp_uint_t out_sz = stream->read(self->src_stream, &c, 1, &err);
+    mp_uint_t out_sz = stream->read(self->src_stream, self->src_buf, sizeof(self->src_buf), &err);
     if (out_sz == MP_STREAM_ERROR) {
         mp_raise_OSError(err);
     }
     if (out_sz == 0) {
         nlr_raise(mp_obj_new_exception(&mp_type_EOFError));
     }
-    return c;
+    data->source = self->src_buf + 1;
+    data->source_limit = self->src_buf + out_sz;
+    return self->src_buf[0];
+}
+
+STATIC void decompio_unread_src(mp_obj_decompio_t *o) {
+    mp_int_t unused = o->decomp.source_limit - o->decomp.source + o->decomp.bitcount / 8;
+    if (unused == 0) {
+        return;
+    }
+    const mp_stream_p_t *stream = mp_get_stream_raise(o->src_stream, MP_STREAM_OP_READ);
+    if (stream->ioctl != NULL) {
+        struct mp_stream_seek_t seek_s;
+        seek_s.offset = -unused;
+        seek_s.whence = SEEK_CUR;
+        int err;
+        stream->ioctl(o->src_stream, MP_STREAM_SEEK, (mp_uint_t)(uintptr_t)&seek_s, &err);
+    }
 }
 
 STATIC mp_obj_t decompio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
@@ -114,6 +135,7 @@ STATIC mp_uint_t decompio_read(mp_obj_t o_in, void *buf, mp_uint_t size, int *er
     int st = uzlib_uncompress_chksum(&o->decomp);
     if (st == TINF_DONE) {
         o->eof = true;
+        decompio_unread_src(o);
     }
     if (st < 0) {
         *errcode = MP_EINVAL;
@@ -160,6 +182,7 @@ STATIC mp_obj_t mod_uzlib_decompress(size_t n_args, const mp_obj_t *args) {
     decomp->destSize = dest_buf_size;
     DEBUG_printf("uzlib: Initial out buffer: " UINT_FMT " bytes\n", decomp->destSize);
     decomp->source = bufinfo.buf;
+    decomp->source_limit = decomp->source + bufinfo.len;
 
     int st;
     bool is_zlib = true;
@@ -183,11 +206,14 @@ STATIC mp_obj_t mod_uzlib_decompress(size_t n_args, const mp_obj_t *args) {
         if (st == TINF_DONE) {
             break;
         }
+        // Grow the buffer geometrically, so large outputs aren't copied
+        // over and over again
         size_t offset = decomp->dest - dest_buf;
-        dest_buf = m_renew(byte, dest_buf, dest_buf_size, dest_buf_size + 256);
-        dest_buf_size += 256;
+        size_t grow = dest_buf_size / 2 + 256;
+        dest_buf = m_renew(byte, dest_buf, dest_buf_size, dest_buf_size + grow);
+        dest_buf_size += grow;
         decomp->dest = dest_buf + offset;
-        decomp->destSize = 256;
+        decomp->destSize = grow;
     }
 
     mp_uint_t final_sz = decomp->dest - dest_buf;
@@ -202,10 +228,265 @@ error:
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_decompress_obj, 1, 3, mod_uzlib_decompress);
 
+#if MICROPY_PY_UZLIB_COMPRESS
+
+// Maximum hash chain length searched, indexed by compression level 0-9.
+// Level 0 produces stored blocks.
+STATIC const uint16_t uzlib_level_chain[] = {0, 4, 8, 16, 32, 64, 128, 256, 1024, 4096};
+
+// Parse a wbits argument (9..15 zlib, -9..-15 raw, 25..31 gzip) and return
+// the window size in bits.
+STATIC unsigned int uzlib_comp_wbits(mp_int_t wbits, char *checksum_type) {
+    if (wbits >= 9 + 16 && wbits <= 15 + 16) {
+        *checksum_type = TINF_CHKSUM_CRC;
+        return wbits - 16;
+    } else if (wbits >= 9 && wbits <= 15) {
+        *checksum_type = TINF_CHKSUM_ADLER;
+        return wbits;
+    } else if (wbits >= -15 && wbits <= -9) {
+        *checksum_type = TINF_CHKSUM_NONE;
+        return -wbits;
+    }
+    nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "invalid wbits"));
+}
+
+STATIC unsigned int uzlib_comp_chain(mp_int_t level) {
+    if (level == -1) {
+        level = 6;
+    } else if (level < 0 || level > 9) {
+        nlr_raise(mp_obj_new_exception_msg(&mp_type_ValueError, "invalid level"));
+    }
+    return uzlib_level_chain[level];
+}
+
+// The hash table is kept smaller than the window for large windows, longer
+// chains make up for the collisions.
+STATIC unsigned int uzlib_comp_hash_bits(unsigned int window_bits) {
+    return window_bits > 13 ? 12 : window_bits - 1;
+}
+
+typedef struct _mp_obj_compio_t {
+    mp_obj_base_t base;
+    mp_obj_t dest_stream;
+    UZLIB_COMP comp;
+    bool closed;
+    byte outbuf[MICROPY_PY_UZLIB_COMPIO_BUF_SIZE];
+} mp_obj_compio_t;
+
+STATIC void compio_write_dest(UZLIB_COMP *c) {
+    byte *p = (void*)c;
+    p -= offsetof(mp_obj_compio_t, comp);
+    mp_obj_compio_t *self = (mp_obj_compio_t*)p;
+
+    int err;
+    mp_stream_write_exactly(self->dest_stream, c->outbuf, c->outlen, &err);
+    if (err != 0) {
+        mp_raise_OSError(err);
+    }
+    c->outlen = 0;
+}
+
+STATIC mp_obj_t compio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 3, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_WRITE);
+
+    mp_int_t wbits = 10;
+    mp_int_t level = -1;
+    if (n_args > 1) {
+        wbits = mp_obj_get_int(args[1]);
+    }
+    if (n_args > 2) {
+        level = mp_obj_get_int(args[2]);
+    }
+    char checksum_type;
+    unsigned int window_bits = uzlib_comp_wbits(wbits, &checksum_type);
+    unsigned int max_chain = uzlib_comp_chain(level);
+
+    mp_obj_compio_t *o = m_new_obj(mp_obj_compio_t);
+    o->base.type = type;
+    o->dest_stream = args[0];
+    o->closed = false;
+
+    unsigned short *hash_head = NULL, *hash_prev = NULL;
+    unsigned int hash_bits = uzlib_comp_hash_bits(window_bits);
+    if (max_chain) {
+        hash_head = m_new(unsigned short, 1 << hash_bits);
+        hash_prev = m_new(unsigned short, 1 << window_bits);
+    }
+    uzlib_compress_init(&o->comp, m_new(byte, 2 << window_bits), window_bits,
+        hash_head, hash_bits, hash_prev, max_chain, checksum_type);
+    o->comp.outbuf = o->outbuf;
+    o->comp.outlen = 0;
+    o->comp.outsize = sizeof(o->outbuf);
+    o->comp.outbuf_full = compio_write_dest;
+    uzlib_compress_header(&o->comp);
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_uint_t compio_write(mp_obj_t o_in, const void *buf, mp_uint_t size, int *errcode) {
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    if (o->closed) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    uzlib_compress(&o->comp, buf, size);
+    return size;
+}
+
+STATIC mp_uint_t compio_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    (void)arg;
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    if (request == MP_STREAM_FLUSH && !o->closed) {
+        uzlib_compress_flush(&o->comp);
+        compio_write_dest(&o->comp);
+        return 0;
+    }
+    *errcode = MP_EINVAL;
+    return MP_STREAM_ERROR;
+}
+
+// Terminate the compressed stream; the destination stream is left open.
+STATIC mp_obj_t compio_close(mp_obj_t self_in) {
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(self_in);
+    if (!o->closed) {
+        uzlib_compress_finish(&o->comp);
+        compio_write_dest(&o->comp);
+        o->closed = true;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(compio_close_obj, compio_close);
+
+STATIC mp_obj_t compio___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return compio_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(compio___exit___obj, 4, 4, compio___exit__);
+
+STATIC const mp_rom_map_elem_t compio_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&mp_stream_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&compio_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&compio___exit___obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(compio_locals_dict, compio_locals_dict_table);
+
+STATIC const mp_stream_p_t compio_stream_p = {
+    .write = compio_write,
+    .ioctl = compio_ioctl,
+};
+
+STATIC const mp_obj_type_t compio_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_CompIO,
+    .make_new = compio_make_new,
+    .protocol = &compio_stream_p,
+    .locals_dict = (void*)&compio_locals_dict,
+};
+
+// Output of compress() goes straight into a vstr, which is grown as needed
+typedef struct _uzlib_comp_vstr_t {
+    UZLIB_COMP comp;
+    vstr_t vstr;
+} uzlib_comp_vstr_t;
+
+STATIC void uzlib_comp_vstr_grow(UZLIB_COMP *c) {
+    vstr_t *vstr = &((uzlib_comp_vstr_t*)c)->vstr;
+    vstr->len = c->outlen;
+    vstr_hint_size(vstr, 64 + vstr->len / 4);
+    c->outbuf = (byte*)vstr->buf;
+    c->outsize = vstr->alloc;
+}
+
+STATIC void uzlib_compress_vstr(vstr_t *vstr, const byte *data, size_t len, unsigned int window_bits,
+    unsigned int max_chain, char checksum_type) {
+    unsigned int hist_size = 2 << window_bits;
+    unsigned int hash_bits = uzlib_comp_hash_bits(window_bits);
+    byte *hist = m_new(byte, hist_size);
+    unsigned short *hash_head = NULL, *hash_prev = NULL;
+    if (max_chain) {
+        hash_head = m_new(unsigned short, 1 << hash_bits);
+        hash_prev = m_new(unsigned short, 1 << window_bits);
+    }
+
+    uzlib_comp_vstr_t out;
+    out.vstr = *vstr;
+    uzlib_compress_init(&out.comp, hist, window_bits, hash_head, hash_bits, hash_prev,
+        max_chain, checksum_type);
+    out.comp.outbuf = (byte*)out.vstr.buf;
+    out.comp.outlen = out.vstr.len;
+    out.comp.outsize = out.vstr.alloc;
+    out.comp.outbuf_full = uzlib_comp_vstr_grow;
+
+    uzlib_compress_header(&out.comp);
+    uzlib_compress(&out.comp, data, len);
+    uzlib_compress_finish(&out.comp);
+    out.vstr.len = out.comp.outlen;
+    *vstr = out.vstr;
+
+    m_del(byte, hist, hist_size);
+    if (max_chain) {
+        m_del(unsigned short, hash_head, 1 << hash_bits);
+        m_del(unsigned short, hash_prev, 1 << window_bits);
+    }
+}
+
+STATIC mp_obj_t mod_uzlib_compress(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+
+    mp_int_t level = -1;
+    mp_int_t wbits = 15;
+    if (n_args > 1) {
+        level = mp_obj_get_int(args[1]);
+    }
+    if (n_args > 2) {
+        wbits = mp_obj_get_int(args[2]);
+    }
+    char checksum_type;
+    unsigned int window_bits = uzlib_comp_wbits(wbits, &checksum_type);
+    unsigned int max_chain = uzlib_comp_chain(level);
+
+    // Matches can't reach further back than the start of the data, so
+    // there's no need to spend memory on a larger window than that.
+    while (window_bits > 9 && (1u << (window_bits - 1)) >= bufinfo.len) {
+        window_bits--;
+    }
+
+    vstr_t vstr;
+    vstr_init(&vstr, 32 + bufinfo.len / 2);
+    uzlib_compress_vstr(&vstr, bufinfo.buf, bufinfo.len, window_bits, max_chain, checksum_type);
+
+    // Fixed Huffman codes expand data that doesn't compress, in which case
+    // store it instead: each stored block (one per history buffer) costs 5
+    // bytes, then there's the final empty block, the header and trailer.
+    size_t stored_len = bufinfo.len + 5 * (bufinfo.len / (2 << window_bits) + 1) + 2;
+    if (checksum_type == TINF_CHKSUM_ADLER) {
+        stored_len += 2 + 4;
+    } else if (checksum_type == TINF_CHKSUM_CRC) {
+        stored_len += 10 + 8;
+    }
+    if (max_chain && vstr.len > stored_len) {
+        vstr.len = 0;
+        uzlib_compress_vstr(&vstr, bufinfo.buf, bufinfo.len, window_bits, 0, checksum_type);
+    }
+
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_compress_obj, 1, 3, mod_uzlib_compress);
+
+#endif // MICROPY_PY_UZLIB_COMPRESS
+
 STATIC const mp_rom_map_elem_t mp_module_uzlib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uzlib) },
     { MP_ROM_QSTR(MP_QSTR_decompress), MP_ROM_PTR(&mod_uzlib_decompress_obj) },
     { MP_ROM_QSTR(MP_QSTR_DecompIO), MP_ROM_PTR(&decompio_type) },
+    #if MICROPY_PY_UZLIB_COMPRESS
+    { MP_ROM_QSTR(MP_QSTR_compress), MP_ROM_PTR(&mod_uzlib_compress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_CompIO), MP_ROM_PTR(&compio_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_uzlib_globals, mp_module_uzlib_globals_table);
@@ -223,5 +504,8 @@ const mp_obj_module_t mp_module_uzlib = {
 #include "uzlib/tinfgzip.c"
 #include "uzlib/adler32.c"
 #include "uzlib/crc32.c"
+#if MICROPY_PY_UZLIB_COMPRESS
+#include "uzlib/tdeflate.c"
+#endif
 
 #endif // MICROPY_PY_UZLIB
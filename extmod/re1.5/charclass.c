@@ -12,22 +12,24 @@ int _re1_5_classmatch(const char *pc, const char *sp)
     return !is_positive;
 }
 
+// For each ASCII character, bit 0 is set if it's in \d, bit 1 for \s and
+// bit 2 for \w; other bytes are in none of them
+static const unsigned char _namedclass_table[128] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 0, 0, 0, 0, 0, 0,
+    0, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 0, 0, 0, 4,
+    0, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 0, 0, 0, 0,
+};
+
 int _re1_5_namedclassmatch(const char *pc, const char *sp)
 {
     // pc points to name of class
-    int off = (*pc >> 5) & 1;
-    if ((*pc | 0x20) == 'd') {
-        if (!(*sp >= '0' && *sp <= '9')) {
-            off ^= 1;
-        }
-    } else if ((*pc | 0x20) == 's') {
-        if (!(*sp == ' ' || (*sp >= '\t' && *sp <= '\r'))) {
-            off ^= 1;
-        }
-    } else { // w
-        if (!((*sp >= 'A' && *sp <= 'Z') || (*sp >= 'a' && *sp <= 'z') || (*sp >= '0' && *sp <= '9') || *sp == '_')) {
-            off ^= 1;
-        }
-    }
-    return off;
+    int bit = (*pc | 0x20) == 'd' ? 1 : (*pc | 0x20) == 's' ? 2 : 4;
+    int in = (unsigned char)*sp < 128 && (_namedclass_table[(unsigned char)*sp] & bit);
+    // lower case name matches the class, upper case its complement
+    return (*pc & 0x20) ? in : !in;
 }
@@ -8,9 +8,12 @@
     ((code ? memmove(code + at + num, code + at, pc - at) : (void)0), pc += num)
 #define REL(at, to) (to - at - 2)
 #define EMIT(at, byte) (code ? (code[at] = byte) : (void)(at))
+// Jump offsets are a signed char, so fail if one doesn't fit
+#define EMIT_REL(at, rel) \
+    do { int r_ = (rel); if (r_ < -128 || r_ > 127) return NULL; EMIT(at, r_); } while (0)
 #define PC (prog->bytelen)
 
-static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
+static const char *_compilecode(const char *re, ByteProg *prog, int sizecode, int classbits)
 {
     char *code = sizecode ? NULL : prog->insts;
     int start = PC;
@@ -42,25 +45,52 @@ static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
             break;
         case '[': {
             int cnt;
+            const char *r;
             term = PC;
             re++;
-            if (*re == '^') {
-                EMIT(PC++, ClassNot);
-                re++;
-            } else {
-                EMIT(PC++, Class);
+            int negate = *re == '^';
+            re += negate;
+            for (r = re, cnt = 0; *r != ']'; r++, cnt++) {
+                if (!*r) return NULL;
+                if (r[1] == '-') {
+                    r += 2;
+                    if (!*r) return NULL;
+                }
             }
-            PC++; // Skip # of pair byte
             prog->len++;
-            for (cnt = 0; *re != ']'; re++, cnt++) {
-                if (!*re) return NULL;
+            if (classbits && cnt >= CLASS_BITS_MIN_RANGES) {
+                // test membership with a single lookup instead of a scan
+                EMIT(PC++, ClassBits);
+                if (code) {
+                    memset(code + PC, negate ? 0xff : 0, CLASS_BITS_SIZE);
+                }
+                for (; *re != ']'; re++) {
+                    int lo = *re;
+                    if (re[1] == '-') {
+                        re += 2;
+                    }
+                    // ranges compare as (signed) char, as in _re1_5_classmatch
+                    for (int ch = lo; code && ch <= *re; ch++) {
+                        char *b = &code[PC + ((unsigned char)ch >> 3)];
+                        if (negate) {
+                            *b &= ~(1 << (ch & 7));
+                        } else {
+                            *b |= 1 << (ch & 7);
+                        }
+                    }
+                }
+                PC += CLASS_BITS_SIZE;
+                break;
+            }
+            EMIT(PC++, negate ? ClassNot : Class);
+            EMIT(PC++, cnt);
+            for (; *re != ']'; re++) {
                 EMIT(PC++, *re);
                 if (re[1] == '-') {
                     re += 2;
                 }
                 EMIT(PC++, *re);
             }
-            EMIT(term + 1, cnt);
             break;
         }
         case '(': {
@@ -77,7 +107,7 @@ static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
                     re += 2;
             }
 
-            re = _compilecode(re + 1, prog, sizecode);
+            re = _compilecode(re + 1, prog, sizecode, classbits);
             if (re == NULL || *re != ')') return NULL; // error, or no matching paren
 
             if (capture) {
@@ -97,7 +127,7 @@ static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
             } else {
                 EMIT(term, Split);
             }
-            EMIT(term + 1, REL(term, PC));
+            EMIT_REL(term + 1, REL(term, PC));
             prog->len++;
             term = PC;
             break;
@@ -105,7 +135,7 @@ static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
             if (PC == term) return NULL; // nothing to repeat
             INSERT_CODE(term, 2, PC);
             EMIT(PC, Jmp);
-            EMIT(PC + 1, REL(PC, term));
+            EMIT_REL(PC + 1, REL(PC, term));
             PC += 2;
             if (re[1] == '?') {
                 EMIT(term, RSplit);
@@ -113,7 +143,7 @@ static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
             } else {
                 EMIT(term, Split);
             }
-            EMIT(term + 1, REL(term, PC));
+            EMIT_REL(term + 1, REL(term, PC));
             prog->len += 2;
             term = PC;
             break;
@@ -125,20 +155,20 @@ static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
             } else {
                 EMIT(PC, RSplit);
             }
-            EMIT(PC + 1, REL(PC, term));
+            EMIT_REL(PC + 1, REL(PC, term));
             PC += 2;
             prog->len++;
             term = PC;
             break;
         case '|':
             if (alt_label) {
-                EMIT(alt_label, REL(alt_label, PC) + 1);
+                EMIT_REL(alt_label, REL(alt_label, PC) + 1);
             }
             INSERT_CODE(start, 2, PC);
             EMIT(PC++, Jmp);
             alt_label = PC++;
             EMIT(start, Split);
-            EMIT(start + 1, REL(start, PC));
+            EMIT_REL(start + 1, REL(start, PC));
             prog->len += 2;
             term = PC;
             break;
@@ -156,11 +186,126 @@ static const char *_compilecode(const char *re, ByteProg *prog, int sizecode)
     }
 
     if (alt_label) {
-        EMIT(alt_label, REL(alt_label, PC) + 1);
+        EMIT_REL(alt_label, REL(alt_label, PC) + 1);
     }
     return re;
 }
 
+// Add to set the bytes that the matches of the code at pc may start with.
+// Returns 0 if a match may be empty or start with any byte, or if the code
+// has loops or is too complex to look through in *budget steps.
+static int _firstset(const char *pc, unsigned char *set, int *budget)
+{
+    for (;;) {
+        if (--*budget < 0) return 0;
+        switch (*pc) {
+        case Char:
+            set[(unsigned char)pc[1] >> 3] |= 1 << (pc[1] & 7);
+            return 1;
+        case Class:
+        case ClassNot:
+        case NamedClass:
+        case ClassBits:
+            for (int c = 0; c < 256; c++) {
+                char ch = c;
+                int in;
+                if (*pc == ClassBits) {
+                    in = CLASS_BITS_TEST(pc + 1, ch);
+                } else if (*pc == NamedClass) {
+                    in = _re1_5_namedclassmatch(pc + 1, &ch);
+                } else {
+                    in = _re1_5_classmatch(pc + 1, &ch);
+                }
+                if (in) {
+                    set[c >> 3] |= 1 << (c & 7);
+                }
+            }
+            return 1;
+        case Save:
+            pc += 2;
+            continue;
+        case Bol:
+            pc++;
+            continue;
+        case Jmp:
+            if ((signed char)pc[1] < 0) return 0;
+            pc += 2 + (signed char)pc[1];
+            continue;
+        case Split:
+        case RSplit:
+            if ((signed char)pc[1] < 0) return 0;
+            if (!_firstset(pc + 2 + (signed char)pc[1], set, budget)) return 0;
+            pc += 2;
+            continue;
+        default: // Any, Eol, Match
+            return 0;
+        }
+    }
+}
+
+// Find the literal prefix or the set of first bytes of all matches, so that
+// a search can skip ahead to where a match may start
+static void _analysestart(ByteProg *prog)
+{
+    const char *pc = HANDLE_ANCHORED(prog->insts, 1);
+    int budget = 64;
+
+    prog->start = START_ANY;
+    prog->prefixlen = 0;
+    for (;;) {
+        if (*pc == Save) {
+            pc += 2;
+        } else if (*pc == Char && prog->prefixlen < RE1_5_PREFIX_MAX) {
+            prog->u.prefix[prog->prefixlen++] = pc[1];
+            pc += 2;
+        } else {
+            break;
+        }
+    }
+    if (prog->prefixlen > 0) {
+        prog->start = START_PREFIX;
+        return;
+    }
+    memset(prog->u.firstset, 0, sizeof(prog->u.firstset));
+    if (_firstset(pc, prog->u.firstset, &budget)) {
+        prog->start = START_SET;
+    }
+}
+
+// Return the first position from sp on at which a match may start, or NULL
+// if there is none
+const char *re1_5_nextcandidate(ByteProg *prog, const char *sp, const char *end)
+{
+    switch (prog->start) {
+    case START_PREFIX: {
+        int n = prog->prefixlen;
+        while (end - sp >= n) {
+            sp = memchr(sp, prog->u.prefix[0], end - sp - n + 1);
+            if (sp == NULL) return NULL;
+            if (memcmp(sp + 1, prog->u.prefix + 1, n - 1) == 0) return sp;
+            sp++;
+        }
+        return NULL;
+    }
+    case START_SET:
+        for (; sp < end; sp++) {
+            if (CLASS_BITS_TEST(prog->u.firstset, *sp)) return sp;
+        }
+        return NULL;
+    default:
+        return sp;
+    }
+}
+
+// Whether classes can be compiled to bitmaps, which are bigger than a short
+// list of ranges, without making a jump too long
+static int _classbits_fit(const char *re)
+{
+    ByteProg dummyprog = { .bytelen = 0 };
+
+    return _compilecode(re, &dummyprog, /*sizecode*/1, /*classbits*/1) != NULL;
+}
+
 int re1_5_sizecode(const char *re)
 {
     ByteProg dummyprog = {
@@ -168,7 +313,7 @@ int re1_5_sizecode(const char *re)
         .bytelen = 5 + NON_ANCHORED_PREFIX
     };
 
-    if (_compilecode(re, &dummyprog, /*sizecode*/1) == NULL) return -1;
+    if (_compilecode(re, &dummyprog, /*sizecode*/1, _classbits_fit(re)) == NULL) return -1;
 
     return dummyprog.bytelen;
 }
@@ -181,7 +326,7 @@ int re1_5_compilecode(ByteProg *prog, const char *re)
 
     // Add code to implement non-anchored operation ("search"),
     // for anchored operation ("match"), this code will be just skipped.
-    // TODO: Implement search in much more efficient manner
+    // Searches skip ahead to where a match may start, see _analysestart.
     prog->insts[prog->bytelen++] = RSplit;
     prog->insts[prog->bytelen++] = 3;
     prog->insts[prog->bytelen++] = Any;
@@ -193,7 +338,7 @@ int re1_5_compilecode(ByteProg *prog, const char *re)
     prog->insts[prog->bytelen++] = 0;
     prog->len++;
 
-    re = _compilecode(re, prog, /*sizecode*/0);
+    re = _compilecode(re, prog, /*sizecode*/0, _classbits_fit(re));
     if (re == NULL || *re) return 1;
 
     prog->insts[prog->bytelen++] = Save;
@@ -203,6 +348,8 @@ int re1_5_compilecode(ByteProg *prog, const char *re)
     prog->insts[prog->bytelen++] = Match;
     prog->len++;
 
+    _analysestart(prog);
+
     return 0;
 }
 
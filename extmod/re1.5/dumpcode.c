@@ -47,6 +47,18 @@ void re1_5_dumpcode(ByteProg *prog)
                 case NamedClass:
                         printf("namedclass %c\n", code[pc++]);
                         break;
+                case ClassBits: {
+                        int c;
+                        printf("classbits");
+                        for (c = 0; c < 256; c++) {
+                            if (CLASS_BITS_TEST(code + pc, c)) {
+                                printf(" 0x%02x", c);
+                            }
+                        }
+                        printf("\n");
+                        pc += CLASS_BITS_SIZE;
+                        break;
+                }
                 case Match:
                         printf("match\n");
                         break;
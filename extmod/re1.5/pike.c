@@ -0,0 +1,208 @@
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Pike VM: runs all threads of the program in lockstep over the subject,
+// keeping at most one thread per instruction.  So it takes time linear in
+// the length of the subject and, unlike the backtracking matchers, no C
+// stack proportional to it.  Threads are kept in priority order, which
+// gives the same (leftmost, non-POSIX) matches as backtracking.
+
+#include "re1.5.h"
+
+typedef struct {
+    const char *pc;
+    int slot;           // < 0 to follow pc, else restore subp[slot] to old
+    const char *old;
+} PikeStackEntry;
+
+typedef struct {
+    ByteProg *prog;
+    Subject *input;
+    int nsubp;
+    int tsize;          // thread size: pc, then nsubp captures
+    unsigned int gen;
+    unsigned int *mark; // for each byte of code, gen when last visited
+    PikeStackEntry *stack;
+    const char **caps;  // captures of the thread being added
+} PikeVM;
+
+// Size of the work area needed by re1_5_pikevm
+int re1_5_pikevm_worksize(ByteProg *prog, int nsubp)
+{
+    return (2 * prog->len * (1 + nsubp) + nsubp) * sizeof(const char*)
+        + (prog->len + 1) * sizeof(PikeStackEntry)
+        + prog->bytelen * sizeof(unsigned int);
+}
+
+// Add thread at pc to list, following jumps and splits (in priority order)
+// and empty-width instructions, with an explicit stack instead of recursion
+static void addthread(PikeVM *vm, const char **list, int *n, const char *pc, const char *sp)
+{
+    PikeStackEntry *top = vm->stack;
+    const char **caps = vm->caps;
+    const char **t;
+    int off;
+
+    top->pc = pc;
+    top->slot = -1;
+    top++;
+    while (top > vm->stack) {
+        top--;
+        if (top->slot >= 0) {
+            caps[top->slot] = top->old;
+            continue;
+        }
+        pc = top->pc;
+        for (;;) {
+            unsigned int *mark = &vm->mark[pc - vm->prog->insts];
+            if (*mark == vm->gen) {
+                break;
+            }
+            *mark = vm->gen;
+            switch (*pc) {
+            case Jmp:
+                pc += 2 + (signed char)pc[1];
+                continue;
+            case Split:
+                top->pc = pc + 2 + (signed char)pc[1];
+                top->slot = -1;
+                top++;
+                pc += 2;
+                continue;
+            case RSplit:
+                top->pc = pc + 2;
+                top->slot = -1;
+                top++;
+                pc += 2 + (signed char)pc[1];
+                continue;
+            case Save:
+                off = (unsigned char)pc[1];
+                if (off < vm->nsubp) {
+                    top->slot = off;
+                    top->old = caps[off];
+                    top++;
+                    caps[off] = sp;
+                }
+                pc += 2;
+                continue;
+            case Bol:
+                if (sp != vm->input->begin_line) {
+                    break;
+                }
+                pc++;
+                continue;
+            case Eol:
+                if (sp != vm->input->end) {
+                    break;
+                }
+                pc++;
+                continue;
+            default:
+                // consumer or match: this is a thread
+                t = list + (*n)++ * vm->tsize;
+                t[0] = pc;
+                memcpy(t + 1, caps, vm->nsubp * sizeof(*caps));
+                break;
+            }
+            break;
+        }
+    }
+}
+
+// work must point to re1_5_pikevm_worksize(prog, nsubp) bytes, aligned
+// for pointers
+int re1_5_pikevm(ByteProg *prog, Subject *input, const char **subp, int nsubp, int is_anchored, void *work)
+{
+    PikeVM vm;
+    int tsize = 1 + nsubp;
+    const char **clist = work;
+    const char **nlist = clist + prog->len * tsize;
+    const char **tmp;
+    const char *start = HANDLE_ANCHORED(prog->insts, 1);
+    const char *sp;
+    int cn = 0, nn, i, matched = 0;
+
+    vm.prog = prog;
+    vm.input = input;
+    vm.nsubp = nsubp;
+    vm.tsize = tsize;
+    vm.caps = nlist + prog->len * tsize;
+    vm.stack = (PikeStackEntry*)(vm.caps + nsubp);
+    vm.mark = (unsigned int*)(vm.stack + prog->len + 1);
+    memset(vm.mark, 0, prog->bytelen * sizeof(*vm.mark));
+    vm.gen = 1;
+
+    for (sp = input->begin;; sp++) {
+        // a new thread starting here has the lowest priority
+        if (!matched && (!is_anchored || sp == input->begin)) {
+            memset(vm.caps, 0, nsubp * sizeof(*vm.caps));
+            addthread(&vm, clist, &cn, start, sp);
+        }
+        if (cn == 0) {
+            break;
+        }
+
+        vm.gen++;
+        nn = 0;
+        for (i = 0; i < cn; i++) {
+            const char **t = clist + i * tsize;
+            const char *pc = t[0];
+            if (*pc == Match) {
+                if (sp == input->notempty_at) {
+                    continue;
+                }
+                // threads after this one have lower priority, drop them
+                memcpy(subp, t + 1, nsubp * sizeof(*subp));
+                matched = 1;
+                break;
+            }
+            if (sp >= input->end) {
+                continue;
+            }
+            switch (*pc) {
+            case Char:
+                if (*sp != pc[1]) {
+                    continue;
+                }
+                pc += 2;
+                break;
+            case Any:
+                pc++;
+                break;
+            case Class:
+            case ClassNot:
+                if (!_re1_5_classmatch(pc + 1, sp)) {
+                    continue;
+                }
+                pc += 2 + (unsigned char)pc[1] * 2;
+                break;
+            case NamedClass:
+                if (!_re1_5_namedclassmatch(pc + 1, sp)) {
+                    continue;
+                }
+                pc += 2;
+                break;
+            case ClassBits:
+                if (!CLASS_BITS_TEST(pc + 1, *sp)) {
+                    continue;
+                }
+                pc += 1 + CLASS_BITS_SIZE;
+                break;
+            default:
+                re1_5_fatal("pikevm");
+            }
+            memcpy(vm.caps, t + 1, nsubp * sizeof(*vm.caps));
+            addthread(&vm, nlist, &nn, pc, sp + 1);
+        }
+
+        tmp = clist;
+        clist = nlist;
+        nlist = tmp;
+        cn = nn;
+        if (sp >= input->end) {
+            break;
+        }
+    }
+
+    return matched;
+}
@@ -56,11 +56,27 @@ struct Prog
 	int len;
 };
 
+enum	/* ByteProg.start */
+{
+	START_ANY,	// a match may start anywhere, or be empty
+	START_PREFIX,	// every match starts with prefix
+	START_SET,	// every match starts with a byte in firstset
+};
+
+#define RE1_5_PREFIX_MAX 32
+
 struct ByteProg
 {
 	int bytelen;
 	int len;
 	int sub;
+	// what a match starts with, to skip ahead when searching
+	unsigned char start;
+	unsigned char prefixlen;
+	union {
+		char prefix[RE1_5_PREFIX_MAX];
+		unsigned char firstset[256 / 8];
+	} u;
 	char insts[0];
 };
 
@@ -83,6 +99,7 @@ enum	/* Inst.opcode */
 	Class,
 	ClassNot,
 	NamedClass,
+	ClassBits,	// followed by a bitmap of 256 bits
 
 	ASSERTS = 0x50,
 	Bol = ASSERTS,
@@ -129,14 +146,25 @@ void decref(Sub*);
 struct Subject {
 	const char *begin;
 	const char *end;
+	// start of the string, for ^; begin may be later when searching on
+	const char *begin_line;
+	// a match ending here isn't accepted, or NULL; set to begin to look
+	// for a non-empty match there
+	const char *notempty_at;
 };
 
 
 #define NON_ANCHORED_PREFIX 5
 #define HANDLE_ANCHORED(bytecode, is_anchored) ((is_anchored) ? (bytecode) + NON_ANCHORED_PREFIX : (bytecode))
 
+// Classes with at least this many ranges are compiled to a bitmap
+#define CLASS_BITS_MIN_RANGES 4
+#define CLASS_BITS_SIZE (256 / 8)
+#define CLASS_BITS_TEST(bits, c) (((bits)[(unsigned char)(c) >> 3] >> ((c) & 7)) & 1)
+
 int re1_5_backtrack(ByteProg*, Subject*, const char**, int, int);
-int re1_5_pikevm(ByteProg*, Subject*, const char**, int, int);
+int re1_5_pikevm(ByteProg*, Subject*, const char**, int, int, void*);
+int re1_5_pikevm_worksize(ByteProg*, int);
 int re1_5_recursiveloopprog(ByteProg*, Subject*, const char**, int, int);
 int re1_5_recursiveprog(ByteProg*, Subject*, const char**, int, int);
 int re1_5_thompsonvm(ByteProg*, Subject*, const char**, int, int);
@@ -144,6 +172,7 @@ int re1_5_thompsonvm(ByteProg*, Subject*, const char**, int, int);
 int re1_5_sizecode(const char *re);
 int re1_5_compilecode(ByteProg *prog, const char *re);
 void re1_5_dumpcode(ByteProg *prog);
+const char *re1_5_nextcandidate(ByteProg *prog, const char *sp, const char *end);
 void cleanmarks(ByteProg *prog);
 int _re1_5_classmatch(const char *pc, const char *sp);
 int _re1_5_namedclassmatch(const char *pc, const char *sp);
@@ -36,7 +36,15 @@ recursiveloop(char *pc, const char *sp, Subject *input, const char **subp, int n
 			pc++;
 			sp++;
 			continue;
+		case ClassBits:
+			if (!CLASS_BITS_TEST(pc, *sp))
+				return 0;
+			pc += CLASS_BITS_SIZE;
+			sp++;
+			continue;
 		case Match:
+			if(sp == input->notempty_at)
+				return 0;
 			return 1;
 		case Jmp:
 			off = (signed char)*pc++;
@@ -65,7 +73,7 @@ recursiveloop(char *pc, const char *sp, Subject *input, const char **subp, int n
 			subp[off] = old;
 			return 0;
 		case Bol:
-			if(sp != input->begin)
+			if(sp != input->begin_line)
 				return 0;
 			continue;
 		case Eol:
@@ -38,6 +38,41 @@
 
 #include "tinf.h"
 
+#if TINF_CRC32_SLICE8
+
+#include "crc32tab.h"
+
+/* crc is previous value for incremental computation, 0xffffffff initially */
+uint32_t uzlib_crc32(const void *data, unsigned int length, uint32_t crc)
+{
+   const unsigned char *buf = (const unsigned char *)data;
+
+   /* eight bytes per step: the register and the next four bytes each go
+      through their own table, so the lookups don't depend on each other;
+      words are assembled from bytes so any alignment and endianness work */
+   while (length >= 8)
+   {
+      uint32_t lo = crc ^ (buf[0] | buf[1] << 8 | buf[2] << 16 | (uint32_t)buf[3] << 24);
+      uint32_t hi = buf[4] | buf[5] << 8 | buf[6] << 16 | (uint32_t)buf[7] << 24;
+      crc = tinf_crc32tab8[7][lo & 0xff] ^ tinf_crc32tab8[6][(lo >> 8) & 0xff]
+          ^ tinf_crc32tab8[5][(lo >> 16) & 0xff] ^ tinf_crc32tab8[4][lo >> 24]
+          ^ tinf_crc32tab8[3][hi & 0xff] ^ tinf_crc32tab8[2][(hi >> 8) & 0xff]
+          ^ tinf_crc32tab8[1][(hi >> 16) & 0xff] ^ tinf_crc32tab8[0][hi >> 24];
+      buf += 8;
+      length -= 8;
+   }
+
+   while (length--)
+   {
+      crc = tinf_crc32tab8[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+   }
+
+   // return value suitable for passing in next time, for final value invert it
+   return crc;
+}
+
+#else
+
 static const unsigned int tinf_crc32tab[16] = {
    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190,
    0x6b6b51f4, 0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344,
@@ -61,3 +96,5 @@ uint32_t uzlib_crc32(const void *data, unsigned int length, uint32_t crc)
    // return value suitable for passing in next time, for final value invert it
    return crc/* ^ 0xffffffff*/;
 }
+
+#endif
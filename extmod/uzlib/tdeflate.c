@@ -0,0 +1,409 @@
+/*
+ * tdeflate  -  tiny deflate
+ *
+ * Small-footprint DEFLATE compressor for uzlib: greedy LZ77 using hash
+ * chains over a caller-supplied history buffer, encoded with the fixed
+ * Huffman trees of RFC 1951. All memory is provided by the caller, so the
+ * window size (and thus RAM usage) can be chosen to suit the target.
+ *
+ * This software is provided 'as-is', without any express
+ * or implied warranty.  In no event will the authors be
+ * held liable for any damages arising from the use of
+ * this software.
+ *
+ * Permission is granted to anyone to use this software
+ * for any purpose, including commercial applications,
+ * and to alter it and redistribute it freely, subject to
+ * the following restrictions:
+ *
+ * 1. The origin of this software must not be
+ *    misrepresented; you must not claim that you
+ *    wrote the original software. If you use this
+ *    software in a product, an acknowledgment in
+ *    the product documentation would be appreciated
+ *    but is not required.
+ *
+ * 2. Altered source versions must be plainly marked
+ *    as such, and must not be misrepresented as
+ *    being the original software.
+ *
+ * 3. This notice may not be removed or altered from
+ *    any source distribution.
+ */
+
+#include <string.h>
+#include "tinf.h"
+
+/* hash chain terminator; a match against position 0 is never found */
+#define HASH_NIL 0
+
+/* values of block_open */
+#define BLOCK_NONE  0
+#define BLOCK_OPEN  1
+#define BLOCK_FINAL 2
+
+/* ----------------------- *
+ * -- bit output        -- *
+ * ----------------------- */
+
+static void tdefl_outbyte(UZLIB_COMP *c, unsigned char b)
+{
+    if (c->outlen == c->outsize) {
+        c->outbuf_full(c);
+    }
+    c->outbuf[c->outlen++] = b;
+}
+
+/* write nbits (up to 24) of value, least significant bit first */
+static void tdefl_outbits(UZLIB_COMP *c, uint32_t value, int nbits)
+{
+    c->outbits |= value << c->noutbits;
+    c->noutbits += nbits;
+    while (c->noutbits >= 8) {
+        tdefl_outbyte(c, c->outbits & 0xff);
+        c->outbits >>= 8;
+        c->noutbits -= 8;
+    }
+}
+
+static void tdefl_align(UZLIB_COMP *c)
+{
+    if (c->noutbits) {
+        tdefl_outbits(c, 0, 8 - c->noutbits);
+    }
+}
+
+/* Huffman codes are stored MSB first, so reverse them (n <= 12) */
+static unsigned int tdefl_bitrev(unsigned int v, int n)
+{
+    static const unsigned char rev4[16] = {
+        0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
+        0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf
+    };
+    unsigned int r = rev4[v & 15] << 8 | rev4[(v >> 4) & 15] << 4 | rev4[(v >> 8) & 15];
+    return r >> (12 - n);
+}
+
+static int tdefl_log2(unsigned int v)
+{
+    int r = 0;
+    while (v >>= 1) {
+        r++;
+    }
+    return r;
+}
+
+/* ----------------------- *
+ * -- fixed huffman     -- *
+ * ----------------------- */
+
+static void tdefl_literal(UZLIB_COMP *c, unsigned char lit)
+{
+    if (lit < 144) {
+        tdefl_outbits(c, tdefl_bitrev(0x30 + lit, 8), 8);
+    } else {
+        tdefl_outbits(c, tdefl_bitrev(0x190 + lit - 144, 9), 9);
+    }
+}
+
+/* symbols 256..287: end of block and length codes */
+static void tdefl_symbol(UZLIB_COMP *c, unsigned int sym)
+{
+    if (sym < 280) {
+        tdefl_outbits(c, tdefl_bitrev(sym - 256, 7), 7);
+    } else {
+        tdefl_outbits(c, tdefl_bitrev(0xc0 + sym - 280, 8), 8);
+    }
+}
+
+static void tdefl_match(UZLIB_COMP *c, unsigned int len, unsigned int dist)
+{
+    /* length: 3..10 have their own codes, then 4 codes per extra bit */
+    if (len == UZLIB_MAX_MATCH) {
+        tdefl_symbol(c, 285);
+    } else if (len <= 10) {
+        tdefl_symbol(c, 257 + len - 3);
+    } else {
+        unsigned int l = len - 3;
+        int bits = tdefl_log2(l) - 2;
+        tdefl_symbol(c, 257 + 4 + 4 * bits + ((l >> bits) & 3));
+        tdefl_outbits(c, l & ((1 << bits) - 1), bits);
+    }
+
+    /* distance: 1..4 have their own codes, then 2 codes per extra bit */
+    dist -= 1;
+    if (dist < 4) {
+        tdefl_outbits(c, tdefl_bitrev(dist, 5), 5);
+    } else {
+        int lg = tdefl_log2(dist);
+        int bits = lg - 1;
+        tdefl_outbits(c, tdefl_bitrev(2 * lg + ((dist >> bits) & 1), 5), 5);
+        tdefl_outbits(c, dist & ((1 << bits) - 1), bits);
+    }
+}
+
+static void tdefl_start_block(UZLIB_COMP *c, int final)
+{
+    /* BFINAL, then BTYPE=01 (fixed Huffman) */
+    tdefl_outbits(c, final | 1 << 1, 3);
+    c->block_open = final ? BLOCK_FINAL : BLOCK_OPEN;
+}
+
+static void tdefl_end_block(UZLIB_COMP *c)
+{
+    tdefl_symbol(c, 256);
+    c->block_open = BLOCK_NONE;
+}
+
+/* ----------------------- *
+ * -- LZ77              -- *
+ * ----------------------- */
+
+static unsigned int tdefl_hash(UZLIB_COMP *c, const unsigned char *p)
+{
+    uint32_t v = p[0] | p[1] << 8 | p[2] << 16;
+    return (v * 2654435761u) >> (32 - c->hash_bits);
+}
+
+static void tdefl_insert(UZLIB_COMP *c, unsigned int pos)
+{
+    unsigned int h = tdefl_hash(c, c->hist + pos);
+    c->hash_prev[pos & ((1 << c->window_bits) - 1)] = c->hash_head[h];
+    c->hash_head[h] = pos;
+}
+
+/* find longest match for data at pos, at most max_len long; 0 if none */
+static unsigned int tdefl_find_match(UZLIB_COMP *c, unsigned int pos, unsigned int max_len, unsigned int *dist)
+{
+    unsigned int wmask = (1 << c->window_bits) - 1;
+    unsigned int limit = pos > wmask + 1 ? pos - (wmask + 1) : 0;
+    unsigned int chain = c->max_chain;
+    unsigned int best = 2;
+    const unsigned char *s = c->hist + pos;
+    unsigned int p = c->hash_head[tdefl_hash(c, s)];
+
+    while (p != HASH_NIL && p >= limit && p < pos && chain-- != 0) {
+        const unsigned char *m = c->hist + p;
+        if (m[best] == s[best] && m[0] == s[0] && m[1] == s[1]) {
+            unsigned int l = 2;
+            while (l < max_len && m[l] == s[l]) {
+                l++;
+            }
+            if (l > best) {
+                best = l;
+                *dist = pos - p;
+                if (l == max_len) {
+                    break;
+                }
+            }
+        }
+        unsigned int next = c->hash_prev[p & wmask];
+        if (next >= p) {
+            break;
+        }
+        p = next;
+    }
+
+    return best >= 3 ? best : 0;
+}
+
+/* encode history data from pos up to end, opening a block if needed */
+static void tdefl_encode(UZLIB_COMP *c, unsigned int end, int final)
+{
+    if (c->max_chain == 0) {
+        /* stored blocks, BFINAL is left to uzlib_compress_finish */
+        while (c->pos < end) {
+            unsigned int n = end - c->pos;
+            if (n > 0xffff) {
+                n = 0xffff;
+            }
+            tdefl_outbits(c, 0, 3);
+            tdefl_align(c);
+            tdefl_outbits(c, n, 16);
+            tdefl_outbits(c, ~n & 0xffff, 16);
+            for (; n; n--) {
+                tdefl_outbyte(c, c->hist[c->pos++]);
+            }
+        }
+        return;
+    }
+
+    if (c->pos < end && c->block_open == BLOCK_NONE) {
+        tdefl_start_block(c, final);
+    }
+
+    while (c->pos < end) {
+        unsigned int avail = c->fill - c->pos;
+        unsigned int len = 0, dist = 0;
+        if (avail >= 3) {
+            if (avail > UZLIB_MAX_MATCH) {
+                avail = UZLIB_MAX_MATCH;
+            }
+            len = tdefl_find_match(c, c->pos, avail, &dist);
+            tdefl_insert(c, c->pos);
+        }
+        if (len) {
+            unsigned int stop = c->pos + len;
+            tdefl_match(c, len, dist);
+            while (++c->pos < stop) {
+                if (c->pos + 3 <= c->fill) {
+                    tdefl_insert(c, c->pos);
+                }
+            }
+        } else {
+            tdefl_literal(c, c->hist[c->pos++]);
+        }
+    }
+}
+
+/* drop the oldest window from the history buffer */
+static void tdefl_slide(UZLIB_COMP *c)
+{
+    unsigned int wsize = 1 << c->window_bits;
+    unsigned int i;
+
+    if (c->max_chain == 0) {
+        /* stored blocks don't refer back, all data has been output */
+        c->fill = c->pos = 0;
+        return;
+    }
+
+    memmove(c->hist, c->hist + wsize, c->fill - wsize);
+    c->fill -= wsize;
+    c->pos -= wsize;
+
+    for (i = 0; i < (1u << c->hash_bits); i++) {
+        unsigned int p = c->hash_head[i];
+        c->hash_head[i] = p >= wsize ? p - wsize : HASH_NIL;
+    }
+    for (i = 0; i < wsize; i++) {
+        unsigned int p = c->hash_prev[i];
+        c->hash_prev[i] = p >= wsize ? p - wsize : HASH_NIL;
+    }
+}
+
+/* ---------------------- *
+ * -- public functions -- *
+ * ---------------------- */
+
+/* hist must hold 2 << window_bits bytes, hash_head 1 << hash_bits entries
+   and hash_prev 1 << window_bits entries; the hash tables are unused (and
+   may be NULL) when max_chain is 0. window_bits must be 9..15 */
+void uzlib_compress_init(UZLIB_COMP *c, unsigned char *hist, unsigned int window_bits,
+    unsigned short *hash_head, unsigned int hash_bits, unsigned short *hash_prev,
+    unsigned int max_chain, char checksum_type)
+{
+    c->outbits = 0;
+    c->noutbits = 0;
+    c->block_open = BLOCK_NONE;
+    c->hist = hist;
+    c->window_bits = window_bits;
+    c->fill = 0;
+    c->pos = 0;
+    c->hash_head = hash_head;
+    c->hash_prev = hash_prev;
+    c->hash_bits = hash_bits;
+    c->max_chain = max_chain;
+    c->checksum_type = checksum_type;
+    c->checksum = checksum_type == TINF_CHKSUM_CRC ? ~0 : 1;
+    c->in_len = 0;
+    if (max_chain) {
+        memset(hash_head, 0, sizeof(*hash_head) << hash_bits);
+        memset(hash_prev, 0, sizeof(*hash_prev) << window_bits);
+    }
+}
+
+/* write zlib or gzip header, according to checksum type */
+void uzlib_compress_header(UZLIB_COMP *c)
+{
+    if (c->checksum_type == TINF_CHKSUM_ADLER) {
+        unsigned int cmf = (c->window_bits - 8) << 4 | 8;
+        /* FLEVEL: 0 for stored, 2 (default) otherwise */
+        unsigned int flg = c->max_chain ? 2 << 6 : 0;
+        flg |= (31 - (cmf * 256 + flg) % 31) % 31;
+        tdefl_outbyte(c, cmf);
+        tdefl_outbyte(c, flg);
+    } else if (c->checksum_type == TINF_CHKSUM_CRC) {
+        static const unsigned char gz_header[10] = {
+            0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff
+        };
+        int i;
+        for (i = 0; i < 10; i++) {
+            tdefl_outbyte(c, gz_header[i]);
+        }
+    }
+}
+
+/* feed data to the compressor; output is produced as history fills up */
+void uzlib_compress(UZLIB_COMP *c, const uint8_t *src, unsigned slen)
+{
+    unsigned int size = 2 << c->window_bits;
+
+    if (c->checksum_type == TINF_CHKSUM_ADLER) {
+        c->checksum = uzlib_adler32(src, slen, c->checksum);
+    } else if (c->checksum_type == TINF_CHKSUM_CRC) {
+        c->checksum = uzlib_crc32(src, slen, c->checksum);
+    }
+    c->in_len += slen;
+
+    while (slen) {
+        unsigned int n = size - c->fill;
+        if (n > slen) {
+            n = slen;
+        }
+        memcpy(c->hist + c->fill, src, n);
+        c->fill += n;
+        src += n;
+        slen -= n;
+        if (c->fill == size) {
+            /* keep a full match of lookahead for when more data comes */
+            tdefl_encode(c, c->max_chain ? size - UZLIB_MAX_MATCH : size, 0);
+            tdefl_slide(c);
+        }
+    }
+}
+
+/* encode all data fed so far and byte-align the output, so that a
+   decompressor can reproduce it (like zlib's Z_SYNC_FLUSH) */
+void uzlib_compress_flush(UZLIB_COMP *c)
+{
+    tdefl_encode(c, c->fill, 0);
+    if (c->block_open != BLOCK_NONE) {
+        tdefl_end_block(c);
+    }
+    /* empty stored block: LEN = 0, NLEN = 0xffff */
+    tdefl_outbits(c, 0, 3);
+    tdefl_align(c);
+    tdefl_outbits(c, 0, 16);
+    tdefl_outbits(c, 0xffff, 16);
+}
+
+/* encode remaining data, terminate the stream and write the trailer */
+void uzlib_compress_finish(UZLIB_COMP *c)
+{
+    int i;
+
+    tdefl_encode(c, c->fill, 1);
+    if (c->block_open != BLOCK_FINAL) {
+        if (c->block_open != BLOCK_NONE) {
+            tdefl_end_block(c);
+        }
+        tdefl_start_block(c, 1);
+    }
+    tdefl_end_block(c);
+    tdefl_align(c);
+
+    if (c->checksum_type == TINF_CHKSUM_ADLER) {
+        for (i = 24; i >= 0; i -= 8) {
+            tdefl_outbyte(c, c->checksum >> i);
+        }
+    } else if (c->checksum_type == TINF_CHKSUM_CRC) {
+        uint32_t crc = ~c->checksum;
+        for (i = 0; i < 32; i += 8) {
+            tdefl_outbyte(c, crc >> i);
+        }
+        for (i = 0; i < 32; i += 8) {
+            tdefl_outbyte(c, c->in_len >> i);
+        }
+    }
+}
@@ -41,18 +41,40 @@ extern "C" {
 
 /* data structures */
 
+/* number of bits decoded at once by table lookup, 0 to disable */
+#ifndef TINF_FAST_BITS
+#define TINF_FAST_BITS 9
+#endif
+
+/* CRC32 eight bytes at a time using 8KB of constant tables, or 0 for four
+   bits at a time using 64 bytes */
+#ifndef TINF_CRC32_SLICE8
+#define TINF_CRC32_SLICE8 0
+#endif
+
 typedef struct {
    unsigned short table[16];  /* table of code length counts */
    unsigned short trans[288]; /* code -> symbol translation table */
+#if TINF_FAST_BITS
+   /* next TINF_FAST_BITS bits of input -> symbol | code length << 9,
+      or 0 if the code is longer */
+   unsigned short fast[1 << TINF_FAST_BITS];
+#endif
 } TINF_TREE;
 
 struct TINF_DATA;
 typedef struct TINF_DATA {
+   /* Input data, up to source_limit */
    const unsigned char *source;
-   /* If source above is NULL, this function will be used to read
-      next byte from source stream */
+   const unsigned char *source_limit;
+   /* If source above is exhausted, this function will be used to read
+      next byte from source stream. It may also refill source and
+      source_limit with a block of data, returning its first byte */
    unsigned char (*readSource)(struct TINF_DATA *data);
+   /* set when the input ran out without readSource */
+   char eof;
 
+   /* bit buffer: bitcount bits, next one in the LSB */
    unsigned int tag;
    unsigned int bitcount;
 
@@ -101,7 +123,49 @@ int TINFCC uzlib_gzip_parse_header(TINF_DATA *d);
 
 /* Compression API */
 
-void TINFCC uzlib_compress(void *data, const uint8_t *src, unsigned slen);
+/* longest match and size of lookahead kept in the history buffer */
+#define UZLIB_MAX_MATCH 258
+
+typedef struct UZLIB_COMP {
+    /* Output buffer. When it fills up, outbuf_full is called, which must
+       either consume the data and reset outlen, or make the buffer larger */
+    unsigned char *outbuf;
+    unsigned int outlen;
+    unsigned int outsize;
+    void (*outbuf_full)(struct UZLIB_COMP *c);
+
+    /* bit accumulator, LSB first as required by deflate */
+    uint32_t outbits;
+    int noutbits;
+    int block_open;
+
+    /* History buffer of 2 windows: the LZ77 window and incoming data */
+    unsigned char *hist;
+    unsigned int window_bits;
+    unsigned int fill;
+    unsigned int pos;
+
+    /* Hash chains: hash_head is indexed by hash of next 3 bytes, hash_prev
+       by position modulo window size. 0 terminates a chain. 0 max_chain
+       selects stored (uncompressed) blocks */
+    unsigned short *hash_head;
+    unsigned short *hash_prev;
+    unsigned int hash_bits;
+    unsigned int max_chain;
+
+    /* Accumulating checksum and uncompressed length */
+    uint32_t checksum;
+    uint32_t in_len;
+    char checksum_type;
+} UZLIB_COMP;
+
+void TINFCC uzlib_compress_init(UZLIB_COMP *c, unsigned char *hist, unsigned int window_bits,
+    unsigned short *hash_head, unsigned int hash_bits, unsigned short *hash_prev,
+    unsigned int max_chain, char checksum_type);
+void TINFCC uzlib_compress_header(UZLIB_COMP *c);
+void TINFCC uzlib_compress(UZLIB_COMP *c, const uint8_t *src, unsigned slen);
+void TINFCC uzlib_compress_flush(UZLIB_COMP *c);
+void TINFCC uzlib_compress_finish(UZLIB_COMP *c);
 
 /* Checksum API */
 
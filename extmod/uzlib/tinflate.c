@@ -33,6 +33,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "tinf.h"
 
 uint32_t tinf_get_le_uint32(TINF_DATA *d);
@@ -112,6 +113,37 @@ static void tinf_build_bits_base(unsigned char *bits, unsigned short *base, int
 }
 #endif
 
+#if TINF_FAST_BITS
+/* build lookup table for codes of up to TINF_FAST_BITS bits */
+static void tinf_build_fast(TINF_TREE *t)
+{
+   unsigned int len, i, j, idx = 0, code = 0;
+
+   memset(t->fast, 0, sizeof(t->fast));
+
+   /* canonical codes are assigned in order of trans */
+   for (len = 1; len <= TINF_FAST_BITS; ++len)
+   {
+      for (i = 0; i < t->table[len]; ++i, ++idx, ++code)
+      {
+         unsigned int rev = 0, c = code;
+         unsigned short entry = t->trans[idx] | len << 9;
+
+         /* over-subscribed set of lengths */
+         if (code >> len) return;
+
+         /* codes are sent MSB first, so index by reversed code */
+         for (j = 0; j < len; ++j, c >>= 1) rev = (rev << 1) | (c & 1);
+
+         for (j = rev; j < (1 << TINF_FAST_BITS); j += 1 << len) t->fast[j] = entry;
+      }
+      code <<= 1;
+   }
+}
+#else
+#define tinf_build_fast(t)
+#endif
+
 /* build the fixed huffman trees */
 static void tinf_build_fixed_trees(TINF_TREE *lt, TINF_TREE *dt)
 {
@@ -135,6 +167,9 @@ static void tinf_build_fixed_trees(TINF_TREE *lt, TINF_TREE *dt)
    dt->table[5] = 32;
 
    for (i = 0; i < 32; ++i) dt->trans[i] = i;
+
+   tinf_build_fast(lt);
+   tinf_build_fast(dt);
 }
 
 /* given an array of code lengths, build a tree */
@@ -163,18 +198,34 @@ static void tinf_build_tree(TINF_TREE *t, const unsigned char *lengths, unsigned
    {
       if (lengths[i]) t->trans[offs[lengths[i]]++] = i;
    }
+
+   tinf_build_fast(t);
 }
 
 /* ---------------------- *
  * -- decode functions -- *
  * ---------------------- */
 
+/* get next byte of input, skipping remaining bits of the current byte */
 unsigned char uzlib_get_byte(TINF_DATA *d)
 {
-    if (d->source) {
+    /* whole bytes already loaded into the bit buffer come first */
+    d->tag >>= d->bitcount & 7;
+    d->bitcount &= ~7;
+    if (d->bitcount) {
+        unsigned char c = d->tag;
+        d->tag >>= 8;
+        d->bitcount -= 8;
+        return c;
+    }
+    if (d->source < d->source_limit) {
         return *d->source++;
     }
-    return d->readSource(d);
+    if (d->readSource) {
+        return d->readSource(d);
+    }
+    d->eof = 1;
+    return 0;
 }
 
 uint32_t tinf_get_le_uint32(TINF_DATA *d)
@@ -197,22 +248,33 @@ uint32_t tinf_get_be_uint32(TINF_DATA *d)
     return val;
 }
 
+/* load the bit buffer from data already in the source buffer; this never
+   calls readSource, so doesn't read more of the stream than needed */
+static void tinf_refill(TINF_DATA *d)
+{
+    while (d->bitcount <= 24 && d->source < d->source_limit) {
+        d->tag |= (unsigned int)*d->source++ << d->bitcount;
+        d->bitcount += 8;
+    }
+}
+
 /* get one bit from source stream */
 static int tinf_getbit(TINF_DATA *d)
 {
    unsigned int bit;
 
    /* check if tag is empty */
-   if (!d->bitcount--)
+   if (!d->bitcount)
    {
       /* load next tag */
       d->tag = uzlib_get_byte(d);
-      d->bitcount = 7;
+      d->bitcount = 8;
    }
 
    /* shift bit out of tag */
    bit = d->tag & 0x01;
    d->tag >>= 1;
+   d->bitcount--;
 
    return bit;
 }
@@ -222,6 +284,15 @@ static unsigned int tinf_read_bits(TINF_DATA *d, int num, int base)
 {
    unsigned int val = 0;
 
+   tinf_refill(d);
+   if (d->bitcount >= (unsigned int)num)
+   {
+      val = d->tag & ((1 << num) - 1);
+      d->tag >>= num;
+      d->bitcount -= num;
+      return val + base;
+   }
+
    /* read num bits */
    if (num)
    {
@@ -240,6 +311,20 @@ static int tinf_decode_symbol(TINF_DATA *d, TINF_TREE *t)
 {
    int sum = 0, cur = 0, len = 0;
 
+#if TINF_FAST_BITS
+   unsigned int entry;
+
+   tinf_refill(d);
+   entry = t->fast[d->tag & ((1 << TINF_FAST_BITS) - 1)];
+   /* bits above bitcount are zero, so check the code is all there */
+   if (entry && (entry >> 9) <= d->bitcount)
+   {
+      d->tag >>= entry >> 9;
+      d->bitcount -= entry >> 9;
+      return entry & 0x1ff;
+   }
+#endif
+
    /* get more bits while code value is above sum */
    do {
 
@@ -373,17 +458,24 @@ static int tinf_inflate_block_data(TINF_DATA *d, TINF_TREE *lt, TINF_TREE *dt)
         }
     }
 
-    /* copy next byte from dict substring */
+    /* copy as much of dict substring as fits in the output; the caller
+       accounts for the last byte */
+    unsigned int n = d->curlen < d->destSize ? d->curlen : d->destSize;
+    d->curlen -= n;
+    d->destSize -= n - 1;
     if (d->dict_ring) {
-        TINF_PUT(d, d->dict_ring[d->lzOff]);
-        if ((unsigned)++d->lzOff == d->dict_size) {
-            d->lzOff = 0;
+        while (n--) {
+            TINF_PUT(d, d->dict_ring[d->lzOff]);
+            if ((unsigned)++d->lzOff == d->dict_size) {
+                d->lzOff = 0;
+            }
         }
     } else {
-        d->dest[0] = d->dest[d->lzOff];
-        d->dest++;
+        while (n--) {
+            d->dest[0] = d->dest[d->lzOff];
+            d->dest++;
+        }
     }
-    d->curlen--;
     return TINF_OK;
 }
 
@@ -403,9 +495,6 @@ static int tinf_inflate_uncompressed_block(TINF_DATA *d)
         /* increment length to properly return TINF_DONE below, without
            producing data at the same time */
         d->curlen = length + 1;
-
-        /* make sure we start next block on a byte boundary */
-        d->bitcount = 0;
     }
 
     if (--d->curlen == 0) {
@@ -438,7 +527,9 @@ void uzlib_init(void)
 /* initialize decompression structure */
 void uzlib_uncompress_init(TINF_DATA *d, void *dict, unsigned int dictLen)
 {
+   d->tag = 0;
    d->bitcount = 0;
+   d->eof = 0;
    d->bfinal = 0;
    d->btype = -1;
    d->dict_size = dictLen;
@@ -489,6 +580,11 @@ next_blk:
             return TINF_DATA_ERROR;
         }
 
+        /* ran out of input data */
+        if (d->eof) {
+            return TINF_DATA_ERROR;
+        }
+
         if (res == TINF_DONE && !d->bfinal) {
             /* the block has ended (without producing more data), but we
                can't return without data, so start procesing next block */
@@ -545,6 +641,10 @@ int uzlib_uncompress_chksum(TINF_DATA *d)
             val = tinf_get_le_uint32(d);
             break;
         }
+
+        if (d->eof) {
+            return TINF_DATA_ERROR;
+        }
     }
 
     return res;
@@ -236,6 +236,41 @@ STATIC void extract_prelude(const byte **ip, const byte **ip2, bytecode_prelude_
 #include "py/parsenum.h"
 #include "py/bc0.h"
 
+typedef struct _mp_mem_reader_t {
+    const byte *cur;
+    const byte *end;
+} mp_mem_reader_t;
+
+STATIC mp_uint_t mp_mem_reader_next_byte(void *br_in) {
+    mp_mem_reader_t *br = br_in;
+    if (br->cur < br->end) {
+        return *br->cur++;
+    } else {
+        return (mp_uint_t)-1;
+    }
+}
+
+#if MICROPY_PERSISTENT_CODE_LOAD_XIP
+// State used when executing bytecode in place from a caller-provided buffer.
+// The reader's data always points to mem.
+typedef struct _mp_xip_loader_t {
+    mp_mem_reader_t mem;
+    bool writable;
+} mp_xip_loader_t;
+
+// Return a pointer to the next len bytes of the buffer and skip over them.
+STATIC const byte *xip_take(mp_xip_loader_t *xip, size_t len) {
+    if ((size_t)(xip->mem.end - xip->mem.cur) < len) {
+        mp_raise_ValueError("invalid .mpy file");
+    }
+    const byte *ptr = xip->mem.cur;
+    xip->mem.cur += len;
+    return ptr;
+}
+#else
+typedef void mp_xip_loader_t;
+#endif
+
 STATIC int read_byte(mp_reader_t *reader) {
     return reader->read_byte(reader->data);
 }
@@ -258,8 +293,16 @@ STATIC mp_uint_t read_uint(mp_reader_t *reader) {
     return unum;
 }
 
-STATIC qstr load_qstr(mp_reader_t *reader) {
+STATIC qstr load_qstr(mp_reader_t *reader, mp_xip_loader_t *xip) {
     mp_uint_t len = read_uint(reader);
+    #if MICROPY_PERSISTENT_CODE_LOAD_XIP
+    if (xip != NULL) {
+        // intern straight from the buffer, no need for a temporary copy
+        return qstr_from_strn((const char*)xip_take(xip, len), len);
+    }
+    #else
+    (void)xip;
+    #endif
     char *str = m_new(char, len);
     read_bytes(reader, (byte*)str, len);
     qstr qst = qstr_from_strn(str, len);
@@ -292,7 +335,7 @@ STATIC void load_bytecode_qstrs(mp_reader_t *reader, byte *ip, byte *ip_top) {
         size_t sz;
         uint f = mp_opcode_format(ip, &sz);
         if (f == MP_OPCODE_QSTR) {
-            qstr qst = load_qstr(reader);
+            qstr qst = load_qstr(reader, NULL);
             ip[1] = qst;
             ip[2] = qst >> 8;
         }
@@ -300,11 +343,87 @@ STATIC void load_bytecode_qstrs(mp_reader_t *reader, byte *ip, byte *ip_top) {
     }
 }
 
-STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
+#if MICROPY_PERSISTENT_CODE_LOAD_XIP
+STATIC inline bool xip_qstr_linked(const byte *p, qstr qst) {
+    return p[0] == (qst & 0xff) && p[1] == (qst >> 8);
+}
+
+// Link the qstrs of bytecode that lives in the XIP buffer.  All qstrs are
+// first resolved into a side table; the bytecode is then only written to if
+// a slot doesn't already hold the right id.  If the buffer is read-only (eg
+// flash) and a slot differs, this function's bytecode is copied to RAM.  It
+// is also copied if the VM writes its map lookup caches into the bytecode.
+STATIC const byte *load_bytecode_qstrs_xip(mp_reader_t *reader, mp_xip_loader_t *xip,
+    const byte *bytecode, size_t bc_len, const byte *ip, const byte *ip2) {
+
+    // count the qstr slots in the opcodes
+    size_t n_qstr = 2; // simple_name and source_file
+    for (const byte *p = ip; p < bytecode + bc_len;) {
+        size_t sz;
+        if (mp_opcode_format(p, &sz) == MP_OPCODE_QSTR) {
+            ++n_qstr;
+        }
+        p += sz;
+    }
+
+    // resolve all qstrs, recording whether the bytecode is already linked
+    qstr *table = m_new(qstr, n_qstr);
+    table[0] = load_qstr(reader, xip);
+    table[1] = load_qstr(reader, xip);
+    bool linked = xip_qstr_linked(ip2, table[0]) && xip_qstr_linked(ip2 + 2, table[1]);
+    size_t i = 2;
+    for (const byte *p = ip; p < bytecode + bc_len;) {
+        size_t sz;
+        if (mp_opcode_format(p, &sz) == MP_OPCODE_QSTR) {
+            table[i] = load_qstr(reader, xip);
+            linked = linked && xip_qstr_linked(p + 1, table[i]);
+            ++i;
+        }
+        p += sz;
+    }
+
+    bool copy = !xip->writable && (!linked || MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE);
+    if (!linked || copy) {
+        byte *bc = (byte*)bytecode;
+        if (copy) {
+            bc = m_new(byte, bc_len);
+            memcpy(bc, bytecode, bc_len);
+        }
+        byte *p2 = bc + (ip2 - bytecode);
+        p2[0] = table[0]; p2[1] = table[0] >> 8;
+        p2[2] = table[1]; p2[3] = table[1] >> 8;
+        i = 2;
+        for (byte *p = bc + (ip - bytecode); p < bc + bc_len;) {
+            size_t sz;
+            if (mp_opcode_format(p, &sz) == MP_OPCODE_QSTR) {
+                p[1] = table[i];
+                p[2] = table[i] >> 8;
+                ++i;
+            }
+            p += sz;
+        }
+        bytecode = bc;
+    }
+
+    m_del(qstr, table, n_qstr);
+    return bytecode;
+}
+#endif
+
+STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader, mp_xip_loader_t *xip) {
     // load bytecode
     mp_uint_t bc_len = read_uint(reader);
-    byte *bytecode = m_new(byte, bc_len);
-    read_bytes(reader, bytecode, bc_len);
+    byte *bytecode;
+    #if MICROPY_PERSISTENT_CODE_LOAD_XIP
+    if (xip != NULL) {
+        // reference the bytecode directly in the buffer
+        bytecode = (byte*)xip_take(xip, bc_len);
+    } else
+    #endif
+    {
+        bytecode = m_new(byte, bc_len);
+        read_bytes(reader, bytecode, bc_len);
+    }
 
     // extract prelude
     const byte *ip = bytecode;
@@ -313,11 +432,18 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     extract_prelude(&ip, &ip2, &prelude);
 
     // load qstrs and link global qstr ids into bytecode
-    qstr simple_name = load_qstr(reader);
-    qstr source_file = load_qstr(reader);
-    ((byte*)ip2)[0] = simple_name; ((byte*)ip2)[1] = simple_name >> 8;
-    ((byte*)ip2)[2] = source_file; ((byte*)ip2)[3] = source_file >> 8;
-    load_bytecode_qstrs(reader, (byte*)ip, bytecode + bc_len);
+    #if MICROPY_PERSISTENT_CODE_LOAD_XIP
+    if (xip != NULL) {
+        bytecode = (byte*)load_bytecode_qstrs_xip(reader, xip, bytecode, bc_len, ip, ip2);
+    } else
+    #endif
+    {
+        qstr simple_name = load_qstr(reader, NULL);
+        qstr source_file = load_qstr(reader, NULL);
+        ((byte*)ip2)[0] = simple_name; ((byte*)ip2)[1] = simple_name >> 8;
+        ((byte*)ip2)[2] = source_file; ((byte*)ip2)[3] = source_file >> 8;
+        load_bytecode_qstrs(reader, (byte*)ip, bytecode + bc_len);
+    }
 
     // load constant table
     mp_uint_t n_obj = read_uint(reader);
@@ -325,13 +451,13 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     mp_uint_t *const_table = m_new(mp_uint_t, prelude.n_pos_args + prelude.n_kwonly_args + n_obj + n_raw_code);
     mp_uint_t *ct = const_table;
     for (mp_uint_t i = 0; i < prelude.n_pos_args + prelude.n_kwonly_args; ++i) {
-        *ct++ = (mp_uint_t)MP_OBJ_NEW_QSTR(load_qstr(reader));
+        *ct++ = (mp_uint_t)MP_OBJ_NEW_QSTR(load_qstr(reader, xip));
     }
     for (mp_uint_t i = 0; i < n_obj; ++i) {
         *ct++ = (mp_uint_t)load_obj(reader);
     }
     for (mp_uint_t i = 0; i < n_raw_code; ++i) {
-        *ct++ = (mp_uint_t)(uintptr_t)load_raw_code(reader);
+        *ct++ = (mp_uint_t)(uintptr_t)load_raw_code(reader, xip);
     }
 
     // create raw_code and return it
@@ -344,7 +470,7 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     return rc;
 }
 
-mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
+STATIC void load_header(mp_reader_t *reader) {
     byte header[4];
     read_bytes(reader, header, sizeof(header));
     if (strncmp((char*)header, "M\x00", 2) != 0) {
@@ -353,21 +479,11 @@ mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
     if (header[2] != MPY_FEATURE_FLAGS || header[3] > mp_small_int_bits()) {
         mp_raise_ValueError("incompatible .mpy file");
     }
-    return load_raw_code(reader);
 }
 
-typedef struct _mp_mem_reader_t {
-    const byte *cur;
-    const byte *end;
-} mp_mem_reader_t;
-
-STATIC mp_uint_t mp_mem_reader_next_byte(void *br_in) {
-    mp_mem_reader_t *br = br_in;
-    if (br->cur < br->end) {
-        return *br->cur++;
-    } else {
-        return (mp_uint_t)-1;
-    }
+mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
+    load_header(reader);
+    return load_raw_code(reader, NULL);
 }
 
 mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len) {
@@ -376,6 +492,15 @@ mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len) {
     return mp_raw_code_load(&reader);
 }
 
+#if MICROPY_PERSISTENT_CODE_LOAD_XIP
+mp_raw_code_t *mp_raw_code_load_mem_xip(const byte *buf, size_t len, bool writable) {
+    mp_xip_loader_t xip = {{buf, buf + len}, writable};
+    mp_reader_t reader = {&xip.mem, mp_mem_reader_next_byte};
+    load_header(&reader);
+    return load_raw_code(&reader, &xip);
+}
+#endif
+
 // here we define mp_raw_code_load_file depending on the port
 // TODO abstract this away properly
 
@@ -386,6 +511,45 @@ mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len) {
 #include <fcntl.h>
 #include <unistd.h>
 
+#if MICROPY_PERSISTENT_CODE_LOAD_XIP
+
+#include <sys/mman.h>
+
+// Map the file privately and execute the bytecode in place.  Pages are only
+// copied by the kernel if qstr linking has to write to them.  Once loaded the
+// mapping is never released because the code may be referenced indefinitely,
+// but it is if the file turns out to be invalid.  The file must not change
+// while its code is in use: pages not yet copied still read from the file, so
+// rewriting it changes the running code, and truncating it makes accesses
+// past the new end fault with SIGBUS.  Replace a .mpy by renaming a new file
+// over it, which leaves the mapped one intact.
+mp_raw_code_t *mp_raw_code_load_file(const char *filename) {
+    int fd = open(filename, O_RDONLY, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        mp_raise_ValueError("invalid .mpy file");
+    }
+    void *buf = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED) {
+        mp_raise_ValueError("invalid .mpy file");
+    }
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_raw_code_t *rc = mp_raw_code_load_mem_xip(buf, st.st_size, true);
+        nlr_pop();
+        return rc;
+    } else {
+        munmap(buf, st.st_size);
+        nlr_jump(nlr.ret_val);
+    }
+}
+
+#else
+
 typedef struct _mp_lexer_file_buf_t {
     int fd;
     byte buf[20];
@@ -425,6 +589,8 @@ mp_raw_code_t *mp_raw_code_load_file(const char *filename) {
     return rc;
 }
 
+#endif // MICROPY_PERSISTENT_CODE_LOAD_XIP
+
 #elif defined(__thumb2__) || defined(__xtensa__)
 // fatfs file reader (assume thumb2 arch uses fatfs...)
 
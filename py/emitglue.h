@@ -84,6 +84,13 @@ typedef struct _mp_reader_t {
 mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader);
 mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len);
 mp_raw_code_t *mp_raw_code_load_file(const char *filename);
+#if MICROPY_PERSISTENT_CODE_LOAD_XIP
+// Load code that executes in place from buf, which must stay valid for as long
+// as the code is in use.  If writable is false then buf is never written to:
+// bytecode that needs its qstrs linked, or that caches map lookups in place
+// (MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE), is copied to RAM instead.
+mp_raw_code_t *mp_raw_code_load_mem_xip(const byte *buf, size_t len, bool writable);
+#endif
 #endif
 
 #if MICROPY_PERSISTENT_CODE_SAVE
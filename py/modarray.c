@@ -25,12 +25,410 @@
  */
 
 #include "py/builtin.h"
+#include "py/runtime.h"
+#include "py/binary.h"
+#include "py/smallint.h"
+#include "py/objint.h"
+#include "py/objarray.h"
+
+#if MICROPY_PY_BUILTINS_FLOAT
+#include <math.h>
+#endif
 
 #if MICROPY_PY_ARRAY
 
+#if MICROPY_PY_ARRAY_OPS
+
+// Element-wise operations on numeric arrays.  They accept any object with the
+// buffer protocol (array, bytearray, memoryview, bytes) and dispatch once on
+// the typecode to a plain loop over the C element type, which the compiler is
+// free to vectorise.  Integer results wrap around, the same as when storing
+// an out-of-range value to an array element.
+
+// X-macro lists of: typecode, element type, type to do (wrapping) arithmetic
+// in, and the function to convert a scalar argument for this element type
+#define ARRAYOP_INT_TYPES(X) \
+    X('b', signed char, unsigned int, mp_obj_get_int) \
+    X('B', unsigned char, unsigned int, mp_obj_get_int) \
+    X('h', short, unsigned int, mp_obj_get_int) \
+    X('H', unsigned short, unsigned int, mp_obj_get_int) \
+    X('i', int, unsigned int, mp_obj_get_int) \
+    X('I', unsigned int, unsigned int, mp_obj_get_int) \
+    X('l', long, unsigned long, mp_obj_get_int) \
+    X('L', unsigned long, unsigned long, mp_obj_get_int) \
+    X('q', long long, unsigned long long, mp_obj_get_int) \
+    X('Q', unsigned long long, unsigned long long, mp_obj_get_int)
+
+#if MICROPY_PY_BUILTINS_FLOAT
+#define ARRAYOP_FLOAT_TYPES(X) \
+    X('f', float, float, mp_obj_get_float) \
+    X('d', double, double, mp_obj_get_float)
+#else
+#define ARRAYOP_FLOAT_TYPES(X)
+#endif
+
+#define ARRAYOP_ALL_TYPES(X) ARRAYOP_INT_TYPES(X) ARRAYOP_FLOAT_TYPES(X)
+
+typedef struct _arrayop_buf_t {
+    void *items;
+    size_t len; // in elements
+    char typecode;
+} arrayop_buf_t;
+
+STATIC void arrayop_get_buf(mp_obj_t obj, arrayop_buf_t *buf, mp_uint_t flags) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(obj, &bufinfo, flags);
+    char typecode = bufinfo.typecode;
+    if (typecode == BYTEARRAY_TYPECODE) {
+        typecode = 'B';
+    }
+    switch (typecode) {
+        #define ARRAYOP_CASE(tc, T, W, GET) case tc:
+        ARRAYOP_ALL_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+            break;
+        default:
+            mp_raise_TypeError("array must be numeric");
+    }
+    buf->items = bufinfo.buf;
+    buf->len = bufinfo.len / mp_binary_get_size('@', typecode, NULL);
+    buf->typecode = typecode;
+}
+
+STATIC void arrayop_check_match(const arrayop_buf_t *a, const arrayop_buf_t *b) {
+    if (a->typecode != b->typecode) {
+        mp_raise_TypeError("array typecodes must match");
+    }
+    if (a->len != b->len) {
+        mp_raise_ValueError("array lengths must match");
+    }
+}
+
+// Get the destination of an element-wise operation on src: this is out_in
+// if given (it may be src itself) or else a new array of the same type as src
+STATIC mp_obj_t arrayop_get_out(mp_obj_t src_in, const arrayop_buf_t *src, mp_obj_t out_in, arrayop_buf_t *out) {
+    if (out_in == MP_OBJ_NULL) {
+        char typecode = src->typecode;
+        #if MICROPY_PY_BUILTINS_BYTEARRAY
+        if (MP_OBJ_IS_TYPE(src_in, &mp_type_bytearray)) {
+            typecode = BYTEARRAY_TYPECODE;
+        }
+        #endif
+        out_in = mp_obj_new_array(typecode, src->len);
+    }
+    arrayop_get_buf(out_in, out, MP_BUFFER_WRITE);
+    arrayop_check_match(src, out);
+    return out_in;
+}
+
+STATIC mp_obj_t arrayop_new_int(unsigned long long val, bool is_signed) {
+    if (is_signed) {
+        long long sval = val;
+        if (MP_SMALL_INT_MIN <= sval && sval <= MP_SMALL_INT_MAX) {
+            return MP_OBJ_NEW_SMALL_INT(sval);
+        }
+        return mp_obj_new_int_from_ll(sval);
+    } else {
+        if (val <= MP_SMALL_INT_MAX) {
+            return MP_OBJ_NEW_SMALL_INT(val);
+        }
+        return mp_obj_new_int_from_ull(val);
+    }
+}
+
+// range of an integer element type
+#define ARRAYOP_IS_SIGNED(T) ((T)-1 < 0)
+#define ARRAYOP_MAX(T) (ARRAYOP_IS_SIGNED(T) ? (T)((1ULL << (sizeof(T) * 8 - 1)) - 1) : (T)-1)
+#define ARRAYOP_MIN(T) (ARRAYOP_IS_SIGNED(T) ? (T)(-ARRAYOP_MAX(T) - 1) : (T)0)
+
+// Get an integer argument as an element of the given size and signedness,
+// saturated to the range of that element type; the result is to be cast to
+// the element type
+STATIC unsigned long long arrayop_get_int_sat(mp_obj_t o, size_t size, bool is_signed) {
+    unsigned long long max = size == 8 ? ~0ULL : (1ULL << (size * 8)) - 1;
+    if (is_signed) {
+        max >>= 1;
+    }
+    long long min = is_signed ? -(long long)max - 1 : 0;
+    #if MICROPY_LONGINT_IMPL != MICROPY_LONGINT_IMPL_NONE
+    if (MP_OBJ_IS_TYPE(o, &mp_type_int)) {
+        // too big for a small int, but may fit a long long element
+        int sign = mp_obj_int_sign(o);
+        byte buf[8];
+        if (sign < 0 && !is_signed) {
+            return 0;
+        }
+        if (!mp_obj_int_to_bytes_impl(o, false, is_signed, size, buf)) {
+            return sign < 0 ? (unsigned long long)min : max;
+        }
+        return mp_binary_get_int(size, is_signed, false, buf);
+    }
+    #endif
+    long long v = mp_obj_get_int(o);
+    if (v < min) {
+        return min;
+    }
+    if (v > 0 && (unsigned long long)v > max) {
+        return max;
+    }
+    return v;
+}
+
+enum {
+    ARRAYOP_ADD,
+    ARRAYOP_SUB,
+    ARRAYOP_MUL,
+};
+
+STATIC mp_obj_t arrayop_binary(int op, size_t n_args, const mp_obj_t *args) {
+    arrayop_buf_t a, b, out;
+    arrayop_get_buf(args[0], &a, MP_BUFFER_READ);
+    arrayop_get_buf(args[1], &b, MP_BUFFER_READ);
+    arrayop_check_match(&a, &b);
+    mp_obj_t out_in = arrayop_get_out(args[0], &a, n_args > 2 ? args[2] : MP_OBJ_NULL, &out);
+    size_t n = a.len;
+    switch (a.typecode) {
+        #define ARRAYOP_CASE(tc, T, W, GET) \
+        case tc: { \
+            const T *x = a.items; \
+            const T *y = b.items; \
+            T *z = out.items; \
+            if (op == ARRAYOP_ADD) { \
+                for (size_t i = 0; i < n; i++) { z[i] = (W)x[i] + (W)y[i]; } \
+            } else if (op == ARRAYOP_SUB) { \
+                for (size_t i = 0; i < n; i++) { z[i] = (W)x[i] - (W)y[i]; } \
+            } else { \
+                for (size_t i = 0; i < n; i++) { z[i] = (W)x[i] * (W)y[i]; } \
+            } \
+            break; \
+        }
+        ARRAYOP_ALL_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+    }
+    return out_in;
+}
+
+STATIC mp_obj_t arrayop_add(size_t n_args, const mp_obj_t *args) {
+    return arrayop_binary(ARRAYOP_ADD, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(arrayop_add_obj, 2, 3, arrayop_add);
+
+STATIC mp_obj_t arrayop_sub(size_t n_args, const mp_obj_t *args) {
+    return arrayop_binary(ARRAYOP_SUB, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(arrayop_sub_obj, 2, 3, arrayop_sub);
+
+STATIC mp_obj_t arrayop_mul(size_t n_args, const mp_obj_t *args) {
+    return arrayop_binary(ARRAYOP_MUL, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(arrayop_mul_obj, 2, 3, arrayop_mul);
+
+STATIC mp_obj_t arrayop_scale(size_t n_args, const mp_obj_t *args) {
+    arrayop_buf_t a, out;
+    arrayop_get_buf(args[0], &a, MP_BUFFER_READ);
+    mp_obj_t out_in = arrayop_get_out(args[0], &a, n_args > 2 ? args[2] : MP_OBJ_NULL, &out);
+    size_t n = a.len;
+    #if MICROPY_PY_BUILTINS_FLOAT
+    if (mp_obj_is_float(args[1])) {
+        // integers are scaled by a float factor rounding to the nearest,
+        // and saturating
+        mp_float_t k = mp_obj_get_float(args[1]);
+        switch (a.typecode) {
+            #define ARRAYOP_CASE(tc, T, W, GET) \
+            case tc: { \
+                const T *x = a.items; \
+                T *z = out.items; \
+                for (size_t i = 0; i < n; i++) { \
+                    mp_float_t v = MICROPY_FLOAT_C_FUN(round)(x[i] * k); \
+                    if (v != v) { \
+                        z[i] = 0; \
+                    } else if (v <= (mp_float_t)ARRAYOP_MIN(T)) { \
+                        z[i] = ARRAYOP_MIN(T); \
+                    } else if (v >= (mp_float_t)ARRAYOP_MAX(T)) { \
+                        z[i] = ARRAYOP_MAX(T); \
+                    } else { \
+                        z[i] = (T)v; \
+                    } \
+                } \
+                return out_in; \
+            }
+            ARRAYOP_INT_TYPES(ARRAYOP_CASE)
+            #undef ARRAYOP_CASE
+        }
+    }
+    #endif
+    switch (a.typecode) {
+        #define ARRAYOP_CASE(tc, T, W, GET) \
+        case tc: { \
+            const T *x = a.items; \
+            T *z = out.items; \
+            W k = GET(args[1]); \
+            for (size_t i = 0; i < n; i++) { z[i] = (W)x[i] * k; } \
+            break; \
+        }
+        ARRAYOP_ALL_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+    }
+    return out_in;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(arrayop_scale_obj, 2, 3, arrayop_scale);
+
+STATIC mp_obj_t arrayop_clip(size_t n_args, const mp_obj_t *args) {
+    arrayop_buf_t a, out;
+    arrayop_get_buf(args[0], &a, MP_BUFFER_READ);
+    mp_obj_t out_in = arrayop_get_out(args[0], &a, n_args > 3 ? args[3] : MP_OBJ_NULL, &out);
+    size_t n = a.len;
+    switch (a.typecode) {
+        // the bounds are saturated to the element type before comparing
+        #define ARRAYOP_CLIP(tc, T, lo_expr, hi_expr) \
+        case tc: { \
+            const T *x = a.items; \
+            T *z = out.items; \
+            T lo = lo_expr; \
+            T hi = hi_expr; \
+            for (size_t i = 0; i < n; i++) { \
+                T v = x[i]; \
+                v = v < lo ? lo : v; \
+                z[i] = v > hi ? hi : v; \
+            } \
+            break; \
+        }
+        #define ARRAYOP_CASE(tc, T, W, GET) ARRAYOP_CLIP(tc, T, \
+            (T)arrayop_get_int_sat(args[1], sizeof(T), ARRAYOP_IS_SIGNED(T)), \
+            (T)arrayop_get_int_sat(args[2], sizeof(T), ARRAYOP_IS_SIGNED(T)))
+        ARRAYOP_INT_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+        #define ARRAYOP_CASE(tc, T, W, GET) ARRAYOP_CLIP(tc, T, GET(args[1]), GET(args[2]))
+        ARRAYOP_FLOAT_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+        #undef ARRAYOP_CLIP
+    }
+    return out_in;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(arrayop_clip_obj, 3, 4, arrayop_clip);
+
+// Sum of the elements, or of the products of corresponding elements if b is
+// given.  Integer types are accumulated modulo 2**64, so the result is exact
+// provided it fits in a long long.
+STATIC mp_obj_t arrayop_reduce_sum(const arrayop_buf_t *a, const arrayop_buf_t *b) {
+    size_t n = a->len;
+    switch (a->typecode) {
+        #define ARRAYOP_CASE(tc, T, W, GET) \
+        case tc: { \
+            const T *x = a->items; \
+            unsigned long long acc = 0; \
+            if (b == NULL) { \
+                for (size_t i = 0; i < n; i++) { acc += (unsigned long long)x[i]; } \
+            } else { \
+                const T *y = b->items; \
+                for (size_t i = 0; i < n; i++) { acc += (unsigned long long)x[i] * (unsigned long long)y[i]; } \
+            } \
+            return arrayop_new_int(acc, (T)-1 < 0); \
+        }
+        ARRAYOP_INT_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+        #if MICROPY_PY_BUILTINS_FLOAT
+        #define ARRAYOP_CASE(tc, T, W, GET) \
+        case tc: { \
+            const T *x = a->items; \
+            mp_float_t acc = 0; \
+            if (b == NULL) { \
+                for (size_t i = 0; i < n; i++) { acc += x[i]; } \
+            } else { \
+                const T *y = b->items; \
+                for (size_t i = 0; i < n; i++) { acc += (mp_float_t)x[i] * y[i]; } \
+            } \
+            return mp_obj_new_float(acc); \
+        }
+        ARRAYOP_FLOAT_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+        #endif
+    }
+    return mp_const_none;
+}
+
+STATIC mp_obj_t arrayop_sum(mp_obj_t a_in) {
+    arrayop_buf_t a;
+    arrayop_get_buf(a_in, &a, MP_BUFFER_READ);
+    return arrayop_reduce_sum(&a, NULL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayop_sum_obj, arrayop_sum);
+
+STATIC mp_obj_t arrayop_dot(mp_obj_t a_in, mp_obj_t b_in) {
+    arrayop_buf_t a, b;
+    arrayop_get_buf(a_in, &a, MP_BUFFER_READ);
+    arrayop_get_buf(b_in, &b, MP_BUFFER_READ);
+    arrayop_check_match(&a, &b);
+    return arrayop_reduce_sum(&a, &b);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(arrayop_dot_obj, arrayop_dot);
+
+#if MICROPY_PY_BUILTINS_FLOAT
+STATIC mp_obj_t arrayop_mean(mp_obj_t a_in) {
+    arrayop_buf_t a;
+    arrayop_get_buf(a_in, &a, MP_BUFFER_READ);
+    if (a.len == 0) {
+        mp_raise_ValueError("arg is an empty sequence");
+    }
+    return mp_obj_new_float(mp_obj_get_float(arrayop_reduce_sum(&a, NULL)) / a.len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayop_mean_obj, arrayop_mean);
+#endif
+
+STATIC mp_obj_t arrayop_minmax(mp_obj_t a_in, bool is_max) {
+    arrayop_buf_t a;
+    arrayop_get_buf(a_in, &a, MP_BUFFER_READ);
+    if (a.len == 0) {
+        mp_raise_ValueError("arg is an empty sequence");
+    }
+    size_t n = a.len;
+    switch (a.typecode) {
+        #define ARRAYOP_CASE(tc, T, W, GET) \
+        case tc: { \
+            const T *x = a.items; \
+            T m = x[0]; \
+            if (is_max) { \
+                for (size_t i = 1; i < n; i++) { m = x[i] > m ? x[i] : m; } \
+            } else { \
+                for (size_t i = 1; i < n; i++) { m = x[i] < m ? x[i] : m; } \
+            } \
+            return mp_binary_get_val_array(tc, &m, 0); \
+        }
+        ARRAYOP_ALL_TYPES(ARRAYOP_CASE)
+        #undef ARRAYOP_CASE
+    }
+    return mp_const_none;
+}
+
+STATIC mp_obj_t arrayop_min(mp_obj_t a_in) {
+    return arrayop_minmax(a_in, false);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayop_min_obj, arrayop_min);
+
+STATIC mp_obj_t arrayop_max(mp_obj_t a_in) {
+    return arrayop_minmax(a_in, true);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayop_max_obj, arrayop_max);
+
+#endif // MICROPY_PY_ARRAY_OPS
+
 STATIC const mp_rom_map_elem_t mp_module_array_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_array) },
     { MP_ROM_QSTR(MP_QSTR_array), MP_ROM_PTR(&mp_type_array) },
+    #if MICROPY_PY_ARRAY_OPS
+    { MP_ROM_QSTR(MP_QSTR_add), MP_ROM_PTR(&arrayop_add_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sub), MP_ROM_PTR(&arrayop_sub_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mul), MP_ROM_PTR(&arrayop_mul_obj) },
+    { MP_ROM_QSTR(MP_QSTR_scale), MP_ROM_PTR(&arrayop_scale_obj) },
+    { MP_ROM_QSTR(MP_QSTR_clip), MP_ROM_PTR(&arrayop_clip_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sum), MP_ROM_PTR(&arrayop_sum_obj) },
+    { MP_ROM_QSTR(MP_QSTR_dot), MP_ROM_PTR(&arrayop_dot_obj) },
+    #if MICROPY_PY_BUILTINS_FLOAT
+    { MP_ROM_QSTR(MP_QSTR_mean), MP_ROM_PTR(&arrayop_mean_obj) },
+    #endif
+    { MP_ROM_QSTR(MP_QSTR_min), MP_ROM_PTR(&arrayop_min_obj) },
+    { MP_ROM_QSTR(MP_QSTR_max), MP_ROM_PTR(&arrayop_max_obj) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_array_globals, mp_module_array_globals_table);
@@ -378,7 +378,13 @@ MP_DEFINE_CONST_FUN_OBJ_1(mp_builtin_ord_obj, mp_builtin_ord);
 STATIC mp_obj_t mp_builtin_pow(size_t n_args, const mp_obj_t *args) {
     switch (n_args) {
         case 2: return mp_binary_op(MP_BINARY_OP_POWER, args[0], args[1]);
-        default: return mp_binary_op(MP_BINARY_OP_MODULO, mp_binary_op(MP_BINARY_OP_POWER, args[0], args[1]), args[2]); // TODO optimise...
+        default:
+            #if MICROPY_PY_BUILTINS_POW3 && MICROPY_LONGINT_IMPL == MICROPY_LONGINT_IMPL_MPZ
+            if (MP_OBJ_IS_INT(args[0]) && MP_OBJ_IS_INT(args[1]) && MP_OBJ_IS_INT(args[2])) {
+                return mp_obj_int_pow3(args[0], args[1], args[2]);
+            }
+            #endif
+            return mp_binary_op(MP_BINARY_OP_MODULO, mp_binary_op(MP_BINARY_OP_POWER, args[0], args[1]), args[2]);
     }
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_builtin_pow_obj, 2, 3, mp_builtin_pow);
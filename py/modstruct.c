@@ -250,6 +250,277 @@ STATIC mp_obj_t struct_pack_into(size_t n_args, const mp_obj_t *args) {
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_pack_into_obj, 3, MP_OBJ_FUN_ARGS_MAX, struct_pack_into);
 
+#if MICROPY_PY_STRUCT_STRUCT
+
+/******************************************************************************/
+// Struct type
+//
+// A Struct parses its format string once, into a list of ops that each
+// describe a run of values of the same type, so packing and unpacking only
+// need to walk that list.
+
+typedef struct _struct_op_t {
+    mp_uint_t count; // number of values, or length of the bytes for 's'
+    byte type;
+    byte size; // of each value in bytes
+    byte align;
+} struct_op_t;
+
+typedef struct _mp_obj_struct_t {
+    mp_obj_base_t base;
+    mp_obj_t format;
+    char fmt_type;
+    mp_uint_t size;
+    mp_uint_t num_items;
+    mp_uint_t num_ops;
+    struct_op_t ops[];
+} mp_obj_struct_t;
+
+STATIC mp_obj_t struct_struct_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+
+    const char *fmt = mp_obj_str_get_str(args[0]);
+    char fmt_type = get_fmt_type(&fmt);
+    mp_uint_t num_ops = 0;
+    for (const char *f = fmt; *f; f++) {
+        if (!unichar_isdigit(*f)) {
+            num_ops++;
+        }
+    }
+
+    mp_obj_struct_t *o = m_new_obj_var(mp_obj_struct_t, struct_op_t, num_ops);
+    o->base.type = type;
+    o->format = args[0];
+    o->fmt_type = fmt_type;
+    o->num_ops = num_ops;
+    mp_uint_t size = 0;
+    mp_uint_t num_items = 0;
+    for (struct_op_t *op = o->ops; *fmt; fmt++, op++) {
+        mp_uint_t cnt = 1;
+        if (unichar_isdigit(*fmt)) {
+            cnt = get_fmt_num(&fmt);
+            if (*fmt == '\0') {
+                mp_raise_ValueError("unsupported format");
+            }
+        }
+        op->count = cnt;
+        op->type = *fmt;
+        if (*fmt == 's') {
+            op->size = 1;
+            op->align = 1;
+            size += cnt;
+            num_items += 1;
+        } else {
+            mp_uint_t align;
+            size_t sz = mp_binary_get_size(fmt_type, *fmt, &align);
+            if (sz == 0) {
+                mp_raise_ValueError("unsupported format");
+            }
+            op->size = sz;
+            op->align = align;
+            size = (size + align - 1) & ~(align - 1);
+            size += cnt * sz;
+            num_items += cnt;
+        }
+    }
+    o->size = size;
+    o->num_items = num_items;
+
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC void struct_struct_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void)kind;
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "Struct(%R)", self->format);
+}
+
+// Get the buffer of buf_in starting at offset_in, checking it holds at least
+// size bytes.  A negative offset is relative to the end of the buffer.
+STATIC byte *struct_get_buffer(mp_obj_t buf_in, mp_obj_t offset_in, mp_uint_t size, mp_uint_t flags, byte **end_p) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, flags);
+    mp_int_t offset = 0;
+    if (offset_in != MP_OBJ_NULL) {
+        offset = mp_obj_get_int(offset_in);
+        if (offset < 0) {
+            offset += bufinfo.len;
+        }
+    }
+    if (offset < 0 || (mp_uint_t)offset > bufinfo.len || bufinfo.len - offset < size) {
+        mp_raise_ValueError("buffer too small");
+    }
+    *end_p = (byte*)bufinfo.buf + bufinfo.len;
+    return (byte*)bufinfo.buf + offset;
+}
+
+// Align p for the given op and check that all its values fit before end_p.
+// The size check done by struct_get_buffer covers everything except native
+// alignment, which is relative to the memory address, as in mp_binary_get_val.
+STATIC byte *struct_op_start(const mp_obj_struct_t *self, const struct_op_t *op, byte *p, byte *end_p) {
+    if (self->fmt_type == '@') {
+        p = (byte*)MP_ALIGN(p, (size_t)op->align);
+        if ((mp_uint_t)(end_p - p) < op->count * op->size) {
+            mp_raise_ValueError("buffer too small");
+        }
+    }
+    return p;
+}
+
+STATIC mp_obj_t struct_struct_unpack_internal(const mp_obj_struct_t *self, byte *p, byte *end_p) {
+    mp_obj_tuple_t *res = MP_OBJ_TO_PTR(mp_obj_new_tuple(self->num_items, NULL));
+    mp_obj_t *item = res->items;
+    for (const struct_op_t *op = self->ops, *top = op + self->num_ops; op < top; op++) {
+        p = struct_op_start(self, op, p, end_p);
+        if (op->type == 's') {
+            *item++ = mp_obj_new_bytes(p, op->count);
+            p += op->count;
+        } else {
+            for (mp_uint_t n = op->count; n > 0; n--) {
+                *item++ = mp_binary_get_val(self->fmt_type, op->type, &p);
+            }
+        }
+    }
+    return MP_OBJ_FROM_PTR(res);
+}
+
+STATIC void struct_struct_pack_internal(const mp_obj_struct_t *self, byte *p, byte *end_p, size_t n_args, const mp_obj_t *args) {
+    if (n_args != self->num_items) {
+        mp_raise_ValueError("wrong number of values to pack");
+    }
+    for (const struct_op_t *op = self->ops, *top = op + self->num_ops; op < top; op++) {
+        p = struct_op_start(self, op, p, end_p);
+        if (op->type == 's') {
+            mp_buffer_info_t bufinfo;
+            mp_get_buffer_raise(*args++, &bufinfo, MP_BUFFER_READ);
+            mp_uint_t to_copy = MIN(bufinfo.len, op->count);
+            memcpy(p, bufinfo.buf, to_copy);
+            memset(p + to_copy, 0, op->count - to_copy);
+            p += op->count;
+        } else {
+            for (mp_uint_t n = op->count; n > 0; n--) {
+                mp_binary_set_val(self->fmt_type, op->type, *args++, &p);
+            }
+        }
+    }
+}
+
+STATIC mp_obj_t struct_struct_pack(size_t n_args, const mp_obj_t *args) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(args[0]);
+    vstr_t vstr;
+    vstr_init_len(&vstr, self->size);
+    byte *p = (byte*)vstr.buf;
+    memset(p, 0, self->size);
+    struct_struct_pack_internal(self, p, p + self->size, n_args - 1, args + 1);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_pack_obj, 1, MP_OBJ_FUN_ARGS_MAX, struct_struct_pack);
+
+STATIC mp_obj_t struct_struct_pack_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(args[0]);
+    byte *end_p;
+    byte *p = struct_get_buffer(args[1], args[2], self->size, MP_BUFFER_WRITE, &end_p);
+    struct_struct_pack_internal(self, p, end_p, n_args - 3, args + 3);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_pack_into_obj, 3, MP_OBJ_FUN_ARGS_MAX, struct_struct_pack_into);
+
+STATIC mp_obj_t struct_struct_unpack_from(size_t n_args, const mp_obj_t *args) {
+    // as with the unpack function, unpack only requires the buffer be big enough
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(args[0]);
+    byte *end_p;
+    byte *p = struct_get_buffer(args[1], n_args > 2 ? args[2] : MP_OBJ_NULL, self->size, MP_BUFFER_READ, &end_p);
+    return struct_struct_unpack_internal(self, p, end_p);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_unpack_from_obj, 2, 3, struct_struct_unpack_from);
+
+typedef struct _mp_obj_struct_it_t {
+    mp_obj_base_t base;
+    mp_obj_struct_t *st;
+    mp_obj_t buf;
+    mp_uint_t offset;
+} mp_obj_struct_it_t;
+
+STATIC mp_obj_t struct_it_iternext(mp_obj_t self_in) {
+    mp_obj_struct_it_t *self = MP_OBJ_TO_PTR(self_in);
+    // get the buffer each time, in case it was resized
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(self->buf, &bufinfo, MP_BUFFER_READ);
+    if (bufinfo.len < self->offset || bufinfo.len - self->offset < self->st->size) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    byte *p = (byte*)bufinfo.buf + self->offset;
+    self->offset += self->st->size;
+    return struct_struct_unpack_internal(self->st, p, (byte*)bufinfo.buf + bufinfo.len);
+}
+
+STATIC const mp_obj_type_t struct_it_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_iterator,
+    .getiter = mp_identity,
+    .iternext = struct_it_iternext,
+};
+
+STATIC mp_obj_t struct_struct_iter_unpack(mp_obj_t self_in, mp_obj_t buf_in) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+    if (self->size == 0) {
+        mp_raise_ValueError("cannot iteratively unpack with a struct of length 0");
+    }
+    if (bufinfo.len % self->size != 0) {
+        mp_raise_ValueError("buffer size must be a multiple of the struct size");
+    }
+    mp_obj_struct_it_t *o = m_new_obj(mp_obj_struct_it_t);
+    o->base.type = &struct_it_type;
+    o->st = self;
+    o->buf = buf_in;
+    o->offset = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(struct_struct_iter_unpack_obj, struct_struct_iter_unpack);
+
+STATIC const mp_rom_map_elem_t struct_struct_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_pack), MP_ROM_PTR(&struct_struct_pack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pack_into), MP_ROM_PTR(&struct_struct_pack_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&struct_struct_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack_from), MP_ROM_PTR(&struct_struct_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iter_unpack), MP_ROM_PTR(&struct_struct_iter_unpack_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(struct_struct_locals_dict, struct_struct_locals_dict_table);
+
+STATIC void struct_struct_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
+    if (dest[0] != MP_OBJ_NULL) {
+        // not load attribute
+        return;
+    }
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(self_in);
+    if (attr == MP_QSTR_size) {
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->size);
+    } else if (attr == MP_QSTR_format) {
+        dest[0] = self->format;
+    } else {
+        // look up a method
+        mp_map_elem_t *elem = mp_map_lookup((mp_map_t*)&struct_struct_locals_dict.map, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP);
+        if (elem != NULL) {
+            dest[0] = elem->value;
+            dest[1] = self_in;
+        }
+    }
+}
+
+STATIC const mp_obj_type_t struct_struct_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Struct,
+    .print = struct_struct_print,
+    .make_new = struct_struct_make_new,
+    .attr = struct_struct_attr,
+    .locals_dict = (mp_obj_dict_t*)&struct_struct_locals_dict,
+};
+
+#endif // MICROPY_PY_STRUCT_STRUCT
+
 STATIC const mp_rom_map_elem_t mp_module_struct_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ustruct) },
     { MP_ROM_QSTR(MP_QSTR_calcsize), MP_ROM_PTR(&struct_calcsize_obj) },
@@ -257,6 +528,9 @@ STATIC const mp_rom_map_elem_t mp_module_struct_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_pack_into), MP_ROM_PTR(&struct_pack_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&struct_unpack_from_obj) },
     { MP_ROM_QSTR(MP_QSTR_unpack_from), MP_ROM_PTR(&struct_unpack_from_obj) },
+    #if MICROPY_PY_STRUCT_STRUCT
+    { MP_ROM_QSTR(MP_QSTR_Struct), MP_ROM_PTR(&struct_struct_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_struct_globals, mp_module_struct_globals_table);
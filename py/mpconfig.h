@@ -242,6 +242,12 @@
 #define MICROPY_PERSISTENT_CODE_LOAD (0)
 #endif
 
+// Whether persistent code loaded from a buffer (or mmap'd file) can execute
+// in place, with only qstr linking done at load time
+#ifndef MICROPY_PERSISTENT_CODE_LOAD_XIP
+#define MICROPY_PERSISTENT_CODE_LOAD_XIP (0)
+#endif
+
 // Whether to support saving of persistent code
 #ifndef MICROPY_PERSISTENT_CODE_SAVE
 #define MICROPY_PERSISTENT_CODE_SAVE (0)
@@ -378,6 +384,12 @@
 #define MICROPY_OPT_MPZ_BITWISE (0)
 #endif
 
+// Whether to multiply large mpz integers using Karatsuba's method instead of
+// the schoolbook method.  See MPZ_KARATSUBA_THRESHOLD in py/mpz.h.
+#ifndef MICROPY_OPT_MPZ_KARATSUBA
+#define MICROPY_OPT_MPZ_KARATSUBA (0)
+#endif
+
 /*****************************************************************************/
 /* Python internal features                                                  */
 
@@ -623,6 +635,12 @@ typedef double mp_float_t;
 #define MICROPY_PY_BUILTINS_STR_UNICODE (0)
 #endif
 
+// Whether str/bytes concatenation of long operands is deferred until the
+// data is needed, making repeated s += x linear instead of quadratic
+#ifndef MICROPY_PY_BUILTINS_STR_LAZY_CONCAT
+#define MICROPY_PY_BUILTINS_STR_LAZY_CONCAT (0)
+#endif
+
 // Whether str.center() method provided
 #ifndef MICROPY_PY_BUILTINS_STR_CENTER
 #define MICROPY_PY_BUILTINS_STR_CENTER (0)
@@ -732,6 +750,13 @@ typedef double mp_float_t;
 #define MICROPY_PY_BUILTINS_MIN_MAX (1)
 #endif
 
+// Whether 3-arg pow(a, b, c) on integers is computed as a modular power
+// (with Montgomery reduction for odd moduli) rather than as (a ** b) % c.
+// Requires MICROPY_LONGINT_IMPL_MPZ.
+#ifndef MICROPY_PY_BUILTINS_POW3
+#define MICROPY_PY_BUILTINS_POW3 (0)
+#endif
+
 // Whether to set __file__ for imported modules
 #ifndef MICROPY_PY___FILE__
 #define MICROPY_PY___FILE__ (1)
@@ -755,6 +780,12 @@ typedef double mp_float_t;
 #define MICROPY_PY_ARRAY_SLICE_ASSIGN (0)
 #endif
 
+// Whether to provide element-wise operations (add, sum, dot, clip, etc)
+// as functions in the array module
+#ifndef MICROPY_PY_ARRAY_OPS
+#define MICROPY_PY_ARRAY_OPS (0)
+#endif
+
 // Whether to support attrtuple type (MicroPython extension)
 // It provides space-efficient tuples with attribute access
 #ifndef MICROPY_PY_ATTRTUPLE
@@ -821,6 +852,11 @@ typedef double mp_float_t;
 #define MICROPY_PY_STRUCT (1)
 #endif
 
+// Whether to provide "ustruct.Struct" type, which compiles a format once
+#ifndef MICROPY_PY_STRUCT_STRUCT
+#define MICROPY_PY_STRUCT_STRUCT (0)
+#endif
+
 // Whether to provide "sys" module
 #ifndef MICROPY_PY_SYS
 #define MICROPY_PY_SYS (1)
@@ -906,31 +942,113 @@ typedef double mp_float_t;
 #define MICROPY_PY_UZLIB (0)
 #endif
 
+// Whether to provide uzlib.compress and uzlib.CompIO
+#ifndef MICROPY_PY_UZLIB_COMPRESS
+#define MICROPY_PY_UZLIB_COMPRESS (0)
+#endif
+
+// Size of the buffer in a uzlib.DecompIO object that the source stream is
+// read into
+#ifndef MICROPY_PY_UZLIB_DECOMPIO_BUF_SIZE
+#define MICROPY_PY_UZLIB_DECOMPIO_BUF_SIZE (128)
+#endif
+
+// Size of the buffer in a uzlib.CompIO object that collects compressed
+// output before writing it to the destination stream
+#ifndef MICROPY_PY_UZLIB_COMPIO_BUF_SIZE
+#define MICROPY_PY_UZLIB_COMPIO_BUF_SIZE (64)
+#endif
+
+// Whether CRC32 is computed eight bytes at a time, which is several times
+// faster but takes 8KB of constant tables instead of 64 bytes
+#ifndef MICROPY_PY_UZLIB_CRC32_SLICE8
+#define MICROPY_PY_UZLIB_CRC32_SLICE8 (0)
+#endif
+
 #ifndef MICROPY_PY_UJSON
 #define MICROPY_PY_UJSON (0)
 #endif
 
+// Size of the buffer on the C stack that ujson.dump uses to collect output
+// before writing it to the stream
+#ifndef MICROPY_PY_UJSON_DUMP_BUF_SIZE
+#define MICROPY_PY_UJSON_DUMP_BUF_SIZE (128)
+#endif
+
+// Size of the buffer that ujson.load and ujson.iterload read the stream into
+#ifndef MICROPY_PY_UJSON_LOAD_BUF_SIZE
+#define MICROPY_PY_UJSON_LOAD_BUF_SIZE (64)
+#endif
+
 #ifndef MICROPY_PY_URE
 #define MICROPY_PY_URE (0)
 #endif
 
+// Whether to provide the linear-time matcher, selected with the ure.LINEAR
+// flag to ure.compile
+#ifndef MICROPY_PY_URE_LINEAR
+#define MICROPY_PY_URE_LINEAR (0)
+#endif
+
+// Whether to provide ure.sub and ure.finditer
+#ifndef MICROPY_PY_URE_SUB
+#define MICROPY_PY_URE_SUB (0)
+#endif
+
 #ifndef MICROPY_PY_UHEAPQ
 #define MICROPY_PY_UHEAPQ (0)
 #endif
 
+// Whether to provide the utimeq module of scheduler queues
+#ifndef MICROPY_PY_UTIMEQ
+#define MICROPY_PY_UTIMEQ (0)
+#endif
+
 #ifndef MICROPY_PY_UHASHLIB
 #define MICROPY_PY_UHASHLIB (0)
 #endif
 
+// Whether to provide uhashlib.sha512
+#ifndef MICROPY_PY_UHASHLIB_SHA512
+#define MICROPY_PY_UHASHLIB_SHA512 (0)
+#endif
+
+// Whether to provide uhashlib.hmac
+#ifndef MICROPY_PY_UHASHLIB_HMAC
+#define MICROPY_PY_UHASHLIB_HMAC (0)
+#endif
+
+// Size of the buffer, on the C stack, that hash.update_from reads into
+#ifndef MICROPY_PY_UHASHLIB_STREAM_BUF_SIZE
+#define MICROPY_PY_UHASHLIB_STREAM_BUF_SIZE (256)
+#endif
+
 #ifndef MICROPY_PY_UBINASCII
 #define MICROPY_PY_UBINASCII (0)
 #endif
 
+// Whether to provide the _into variants of the ubinascii functions, which
+// write to a given buffer
+#ifndef MICROPY_PY_UBINASCII_INTO
+#define MICROPY_PY_UBINASCII_INTO (0)
+#endif
+
 // Depends on MICROPY_PY_UZLIB
 #ifndef MICROPY_PY_UBINASCII_CRC32
 #define MICROPY_PY_UBINASCII_CRC32 (0)
 #endif
 
+// Whether to provide ubinascii.CRC, for CRCs with any parameters
+#ifndef MICROPY_PY_UBINASCII_CRC
+#define MICROPY_PY_UBINASCII_CRC (0)
+#endif
+
+// Bits of input a ubinascii.CRC object handles per table lookup, 4 or 8;
+// its table takes 4 bytes times 2 to the power of this
+#ifndef MICROPY_PY_UBINASCII_CRC_TABLE_BITS
+#define MICROPY_PY_UBINASCII_CRC_TABLE_BITS (8)
+#endif
+
 #ifndef MICROPY_PY_URANDOM
 #define MICROPY_PY_URANDOM (0)
 #endif
@@ -424,7 +424,7 @@ STATIC mp_uint_t mpn_mul_dig_add_dig(mpz_dig_t *idig, mp_uint_t ilen, mpz_dig_t
    assumes enough memory in i; assumes i is zeroed; assumes normalised j, k
    can have j, k point to same memory
 */
-STATIC mp_uint_t mpn_mul(mpz_dig_t *idig, mpz_dig_t *jdig, mp_uint_t jlen, mpz_dig_t *kdig, mp_uint_t klen) {
+STATIC mp_uint_t mpn_mul(mpz_dig_t *idig, const mpz_dig_t *jdig, mp_uint_t jlen, const mpz_dig_t *kdig, mp_uint_t klen) {
     mpz_dig_t *oidig = idig;
     mp_uint_t ilen = 0;
 
@@ -433,7 +433,7 @@ STATIC mp_uint_t mpn_mul(mpz_dig_t *idig, mpz_dig_t *jdig, mp_uint_t jlen, mpz_d
         mpz_dbl_dig_t carry = 0;
 
         mp_uint_t jl = jlen;
-        for (mpz_dig_t *jd = jdig; jl > 0; --jl, ++jd, ++id) {
+        for (const mpz_dig_t *jd = jdig; jl > 0; --jl, ++jd, ++id) {
             carry += (mpz_dbl_dig_t)*id + (mpz_dbl_dig_t)*jd * (mpz_dbl_dig_t)*kdig; // will never overflow so long as DIG_SIZE <= 8*sizeof(mpz_dbl_dig_t)/2
             *id = carry & DIG_MASK;
             carry >>= DIG_SIZE;
@@ -449,6 +449,191 @@ STATIC mp_uint_t mpn_mul(mpz_dig_t *idig, mpz_dig_t *jdig, mp_uint_t jlen, mpz_d
     return ilen;
 }
 
+/* computes i = j * j
+   i gets exactly 2 * jlen digits; j need not be normalised
+   each cross product j[a] * j[b] is computed once and doubled, so this does
+   about half the digit multiplications of mpn_mul
+*/
+STATIC void mpn_sqr(mpz_dig_t *idig, const mpz_dig_t *jdig, mp_uint_t jlen) {
+    memset(idig, 0, 2 * jlen * sizeof(mpz_dig_t));
+
+    // sum of j[a] * j[b] for a < b
+    for (mp_uint_t a = 0; a + 1 < jlen; ++a) {
+        mpz_dig_t *id = idig + 2 * a + 1;
+        mpz_dbl_dig_t carry = 0;
+        for (mp_uint_t b = a + 1; b < jlen; ++b, ++id) {
+            carry += (mpz_dbl_dig_t)*id + (mpz_dbl_dig_t)jdig[a] * (mpz_dbl_dig_t)jdig[b];
+            *id = carry & DIG_MASK;
+            carry >>= DIG_SIZE;
+        }
+        *id = carry;
+    }
+
+    // double it
+    mpz_dig_t top = 0;
+    for (mp_uint_t a = 0; a < 2 * jlen; ++a) {
+        mpz_dig_t d = idig[a];
+        idig[a] = ((d << 1) | top) & DIG_MASK;
+        top = d >> (DIG_SIZE - 1);
+    }
+
+    // add the squares on the diagonal
+    mpz_dbl_dig_t carry = 0;
+    for (mp_uint_t a = 0; a < jlen; ++a) {
+        mpz_dbl_dig_t sq = (mpz_dbl_dig_t)jdig[a] * (mpz_dbl_dig_t)jdig[a];
+        carry += (mpz_dbl_dig_t)idig[2 * a] + (sq & DIG_MASK);
+        idig[2 * a] = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+        carry += (mpz_dbl_dig_t)idig[2 * a + 1] + (sq >> DIG_SIZE);
+        idig[2 * a + 1] = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+    }
+}
+
+#if MICROPY_OPT_MPZ_KARATSUBA || MICROPY_PY_BUILTINS_POW3
+
+/* computes i = j + k over exactly jlen digits
+   returns the carry out of the top digit
+   assumes jlen >= klen; j, k need not be normalised
+   can have i, j, k pointing to same memory
+*/
+STATIC mpz_dig_t mpn_add_fixed(mpz_dig_t *idig, const mpz_dig_t *jdig, mp_uint_t jlen, const mpz_dig_t *kdig, mp_uint_t klen) {
+    mpz_dbl_dig_t carry = 0;
+    mp_uint_t a = 0;
+    for (; a < klen; ++a) {
+        carry += (mpz_dbl_dig_t)jdig[a] + (mpz_dbl_dig_t)kdig[a];
+        idig[a] = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+    }
+    for (; a < jlen; ++a) {
+        carry += jdig[a];
+        idig[a] = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+    }
+    return carry;
+}
+
+/* computes i = j - k over exactly jlen digits
+   returns 1 if there was a borrow out of the top digit, 0 otherwise
+   assumes jlen >= klen; j, k need not be normalised
+   can have i, j, k pointing to same memory
+*/
+STATIC mpz_dig_t mpn_sub_fixed(mpz_dig_t *idig, const mpz_dig_t *jdig, mp_uint_t jlen, const mpz_dig_t *kdig, mp_uint_t klen) {
+    mpz_dbl_dig_signed_t borrow = 0;
+    mp_uint_t a = 0;
+    for (; a < klen; ++a) {
+        borrow += (mpz_dbl_dig_t)jdig[a] - (mpz_dbl_dig_t)kdig[a];
+        idig[a] = borrow & DIG_MASK;
+        borrow >>= DIG_SIZE;
+    }
+    for (; a < jlen; ++a) {
+        borrow += jdig[a];
+        idig[a] = borrow & DIG_MASK;
+        borrow >>= DIG_SIZE;
+    }
+    return borrow != 0;
+}
+
+#endif
+
+#if MICROPY_OPT_MPZ_KARATSUBA
+
+#if MPZ_KARATSUBA_THRESHOLD < 4
+#error MPZ_KARATSUBA_THRESHOLD must be at least 4
+#endif
+
+/* returns the number of scratch digits needed by mpn_mul_full to multiply
+   operands of jlen and klen digits
+*/
+STATIC mp_uint_t mpn_mul_scratch(mp_uint_t jlen, mp_uint_t klen) {
+    if (MIN(jlen, klen) < MPZ_KARATSUBA_THRESHOLD) {
+        return 0;
+    }
+    mp_uint_t n = MAX(jlen, klen);
+    mp_uint_t s = 0;
+    while (n >= MPZ_KARATSUBA_THRESHOLD) {
+        n = (n + 1) / 2;
+        s += 4 * n + 4;
+        n += 1;
+    }
+    return s;
+}
+
+#else
+
+#define mpn_mul_scratch(jlen, klen) (0)
+
+#endif
+
+/* computes i = j * k
+   i gets exactly jlen + klen digits and need not be zeroed; j, k need not be normalised
+   scratch must have mpn_mul_scratch(jlen, klen) digits
+   can have j, k point to same memory (then squaring is used); i can't overlap j, k
+
+   Above MPZ_KARATSUBA_THRESHOLD digits the operands are split in halves,
+   j = j1*B^m + j0 and k = k1*B^m + k0, and the product is formed from the three
+   half-size products j0*k0, j1*k1 and (j0+j1)*(k0+k1).  Unbalanced operands
+   are instead cut into pieces the size of the shorter one.
+*/
+STATIC void mpn_mul_full(mpz_dig_t *idig, const mpz_dig_t *jdig, mp_uint_t jlen, const mpz_dig_t *kdig, mp_uint_t klen, mpz_dig_t *scratch) {
+    if (jlen < klen) {
+        const mpz_dig_t *t = jdig; jdig = kdig; kdig = t;
+        mp_uint_t tl = jlen; jlen = klen; klen = tl;
+    }
+
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    if (klen >= MPZ_KARATSUBA_THRESHOLD) {
+        mp_uint_t m = (jlen + 1) / 2;
+        mp_uint_t ilen = jlen + klen;
+
+        if (klen <= m) {
+            // unbalanced: i = (j1 * k) * B^m + j0 * k
+            mpz_dig_t *t = scratch;
+            mpn_mul_full(idig + m, jdig + m, jlen - m, kdig, klen, scratch);
+            mpn_mul_full(t, jdig, m, kdig, klen, scratch + m + klen);
+            memcpy(idig, t, m * sizeof(mpz_dig_t));
+            mpn_add_fixed(idig + m, idig + m, ilen - m, t + m, klen);
+            return;
+        }
+
+        // z0 = j0 * k0 and z2 = j1 * k1 go straight into the low and high halves of i
+        mpn_mul_full(idig, jdig, m, kdig, m, scratch);
+        mpn_mul_full(idig + 2 * m, jdig + m, jlen - m, kdig + m, klen - m, scratch);
+
+        // z1 = (j0 + j1) * (k0 + k1) - z0 - z2
+        mpz_dig_t *sj = scratch;
+        mpz_dig_t *sk = sj + m + 1;
+        mpz_dig_t *z1 = sk + m + 1;
+        sj[m] = mpn_add_fixed(sj, jdig, m, jdig + m, jlen - m);
+        if (jdig == kdig) {
+            sk = sj;
+        } else {
+            sk[m] = mpn_add_fixed(sk, kdig, m, kdig + m, klen - m);
+        }
+        mpn_mul_full(z1, sj, m + 1, sk, m + 1, z1 + 2 * m + 2);
+        mpn_sub_fixed(z1, z1, 2 * m + 2, idig, 2 * m);
+        mpn_sub_fixed(z1, z1, 2 * m + 2, idig + 2 * m, ilen - 2 * m);
+
+        // i += z1 * B^m; the top digits of z1 beyond the length of i are zero
+        mp_uint_t z1len = 2 * m + 2;
+        if (z1len > ilen - m) {
+            z1len = ilen - m;
+        }
+        mpn_add_fixed(idig + m, idig + m, ilen - m, z1, z1len);
+        return;
+    }
+    #else
+    (void)scratch;
+    #endif
+
+    if (jdig == kdig && jlen == klen) {
+        mpn_sqr(idig, jdig, jlen);
+    } else {
+        memset(idig, 0, (jlen + klen) * sizeof(mpz_dig_t));
+        mpn_mul(idig, jdig, jlen, kdig, klen);
+    }
+}
+
 /* natural_div - quo * den + new_num = old_num (ie num is replaced with rem)
    assumes den != 0
    assumes num_dig has enough memory to be extended by 1 digit
@@ -869,14 +1054,222 @@ typedef uint32_t mp_float_int_t;
 }
 #endif
 
+// returns the value of the char c as a digit, or 36 if it is not a digit
+STATIC mp_uint_t mpz_digit_value(mp_uint_t c) {
+    if ('0' <= c && c <= '9') {
+        return c - '0';
+    } else if ('A' <= c && c <= 'Z') {
+        return c - ('A' - 10);
+    } else if ('a' <= c && c <= 'z') {
+        return c - ('a' - 10);
+    } else {
+        return 36;
+    }
+}
+
+// returns the number of bits per char if base is a power of 2, 0 otherwise
+STATIC mp_uint_t mpz_base_bits(mp_uint_t base) {
+    mp_uint_t bits = 0;
+    while ((1u << bits) < base) {
+        ++bits;
+    }
+    return (1u << bits) == base ? bits : 0;
+}
+
+// returns base ** k for the largest k such that it fits in a digit
+STATIC mpz_dig_t mpz_base_chunk(mp_uint_t base, mp_uint_t *k) {
+    mpz_dbl_dig_t chunk = base;
+    *k = 1;
+    while (chunk * base <= DIG_MASK) {
+        chunk *= base;
+        *k += 1;
+    }
+    return chunk;
+}
+
+/* sets z to the value of the len chars at str, which are all valid digits
+   converts a whole digit's worth of chars (k of them) at a time
+*/
+STATIC void mpz_set_from_digits(mpz_t *z, const char *str, mp_uint_t len, mp_uint_t base) {
+    mp_uint_t k;
+    mpz_base_chunk(base, &k);
+    mpz_need_dig(z, len / k + 1);
+    z->len = 0;
+    // the first group is short so the rest are all k chars
+    mp_uint_t n = len % k;
+    if (n == 0) {
+        n = k;
+    }
+    for (const char *top = str + len; str < top; n = k) {
+        mpz_dig_t mul = 1;
+        mpz_dig_t val = 0;
+        for (; n > 0; --n, ++str) {
+            mul *= base;
+            val = val * base + mpz_digit_value((byte)*str);
+        }
+        z->len = mpn_mul_dig_add_dig(z->dig, z->len, mul, val);
+    }
+}
+
+/* sets z to the value of the len chars at str, which are all valid digits
+   assumes base is 1 << bits; takes linear time
+*/
+STATIC void mpz_set_from_digits_pow2(mpz_t *z, const char *str, mp_uint_t len, mp_uint_t bits) {
+    mpz_need_dig(z, (len * bits + DIG_SIZE - 1) / DIG_SIZE);
+    mpz_dig_t *d = z->dig;
+    mpz_dbl_dig_t acc = 0;
+    mp_uint_t nacc = 0;
+    for (const char *cur = str + len; cur > str;) {
+        acc |= (mpz_dbl_dig_t)mpz_digit_value((byte)*--cur) << nacc;
+        nacc += bits;
+        if (nacc >= DIG_SIZE) {
+            *d++ = acc & DIG_MASK;
+            acc >>= DIG_SIZE;
+            nacc -= DIG_SIZE;
+        }
+    }
+    if (nacc > 0) {
+        *d++ = acc;
+    }
+    z->len = mpn_remove_trailing_zeros(z->dig, d);
+}
+
+#if MICROPY_OPT_MPZ_KARATSUBA
+
+/* computes dest = floor(B ** (2 * d->len) / d) where B = DIG_BASE
+   assumes d > 0
+   uses a Newton step on the reciprocal of the top half of d, so that the
+   cost is a few multiplications rather than a long division
+*/
+STATIC void mpz_recip(mpz_t *dest, const mpz_t *d) {
+    mp_uint_t dlen = d->len;
+    mpz_t t, e;
+    mpz_init_zero(&t);
+    mpz_init_zero(&e);
+    mpz_set_from_int(&e, 1);
+    mpz_shl_inpl(&e, &e, 2 * dlen * DIG_SIZE);
+
+    if (dlen < MPZ_KARATSUBA_THRESHOLD || dlen < 8) {
+        // small enough for long division (and h below would not be less than dlen)
+        mpz_divmod_inpl(dest, &t, &e, d);
+    } else {
+        // starting point from the top h digits of d, good to about h digits
+        mp_uint_t h = dlen / 2 + 2;
+        mpz_shr_inpl(&t, d, (dlen - h) * DIG_SIZE);
+        mpz_recip(dest, &t);
+        mpz_shl_inpl(dest, dest, (dlen - h) * DIG_SIZE);
+
+        // dest += dest * (B ** 2n - d * dest) / B ** 2n
+        mpz_mul_inpl(&t, d, dest);
+        mpz_sub_inpl(&t, &e, &t);
+        mpz_mul_inpl(&t, &t, dest);
+        mpz_shr_inpl(&t, &t, 2 * dlen * DIG_SIZE);
+        mpz_add_inpl(dest, dest, &t);
+
+        // correct the last few units so that 0 <= B ** 2n - d * dest < d
+        mpz_t one;
+        mpz_init_from_int(&one, 1);
+        mpz_mul_inpl(&t, d, dest);
+        mpz_sub_inpl(&e, &e, &t);
+        while (e.neg && e.len != 0) {
+            mpz_sub_inpl(dest, dest, &one);
+            mpz_add_inpl(&e, &e, d);
+        }
+        while (mpz_cmp(&e, d) >= 0) {
+            mpz_add_inpl(dest, dest, &one);
+            mpz_sub_inpl(&e, &e, d);
+        }
+        mpz_deinit(&one);
+    }
+
+    mpz_deinit(&t);
+    mpz_deinit(&e);
+}
+
+/* computes quo, rem such that quo * d + rem = x and 0 <= rem < d
+   assumes 0 <= x < B ** (2 * d->len) and v = mpz_recip(d)
+*/
+STATIC void mpz_divmod_recip(mpz_t *quo, mpz_t *rem, const mpz_t *x, const mpz_t *d, const mpz_t *v) {
+    // this estimate of the quotient is at most 2 too small
+    mpz_mul_inpl(quo, x, v);
+    mpz_shr_inpl(quo, quo, 2 * d->len * DIG_SIZE);
+    mpz_mul_inpl(rem, quo, d);
+    mpz_sub_inpl(rem, x, rem);
+    if (mpz_cmp(rem, d) >= 0) {
+        mpz_t one;
+        mpz_init_from_int(&one, 1);
+        do {
+            mpz_add_inpl(quo, quo, &one);
+            mpz_sub_inpl(rem, rem, d);
+        } while (mpz_cmp(rem, d) >= 0);
+        mpz_deinit(&one);
+    }
+}
+
+/* sets z to the value of the len chars at str, which are all valid digits
+   pows[j] is base ** (k << j) and len <= 2 * (k << j)
+   the string is split in two, each half converted recursively and then
+   combined with one (Karatsuba) multiplication by a power of the base
+*/
+STATIC void mpz_set_from_digits_dc(mpz_t *z, const char *str, mp_uint_t len, mp_uint_t base, mp_uint_t k, const mpz_t *pows, int j) {
+    while (j >= 0 && len <= k << j) {
+        --j;
+    }
+    if (j < 0 || len < MPZ_STR_DC_THRESHOLD * k) {
+        mpz_set_from_digits(z, str, len, base);
+        return;
+    }
+    mp_uint_t m = k << j;
+    mpz_t lo;
+    mpz_init_zero(&lo);
+    mpz_set_from_digits_dc(z, str, len - m, base, k, pows, j - 1);
+    mpz_set_from_digits_dc(&lo, str + len - m, m, base, k, pows, j - 1);
+    mpz_mul_inpl(z, z, &pows[j]);
+    mpz_add_inpl(z, z, &lo);
+    mpz_deinit(&lo);
+}
+
+#endif
+
 // returns number of bytes from str that were processed
 mp_uint_t mpz_set_from_str(mpz_t *z, const char *str, mp_uint_t len, bool neg, mp_uint_t base) {
-    assert(base < 36);
+    assert(base <= 36);
 
+    // find the extent of the valid digits
     const char *cur = str;
     const char *top = str + len;
-
-    mpz_need_dig(z, len * 8 / DIG_SIZE + 1);
+    for (; cur < top; ++cur) { // XXX UTF8 next char
+        if (mpz_digit_value((byte)*cur) >= base) {
+            break;
+        }
+    }
+    len = cur - str;
+
+    mp_uint_t bits = mpz_base_bits(base);
+    mp_uint_t k;
+    mpz_dig_t chunk = mpz_base_chunk(base, &k);
+    (void)chunk;
+    if (bits != 0) {
+        mpz_set_from_digits_pow2(z, str, len, bits);
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    } else if (len >= MPZ_STR_DC_THRESHOLD * k) {
+        // pows[j] = base ** (k << j)
+        mpz_t pows[BITS_PER_WORD];
+        mpz_init_from_int(&pows[0], chunk);
+        int j = 0;
+        while (2 * (k << j) < len) {
+            mpz_init_zero(&pows[j + 1]);
+            mpz_mul_inpl(&pows[j + 1], &pows[j], &pows[j]);
+            ++j;
+        }
+        mpz_set_from_digits_dc(z, str, len, base, k, pows, j);
+        for (; j >= 0; --j) {
+            mpz_deinit(&pows[j]);
+        }
+    #endif
+    } else {
+        mpz_set_from_digits(z, str, len, base);
+    }
 
     if (neg) {
         z->neg = 1;
@@ -884,26 +1277,46 @@ mp_uint_t mpz_set_from_str(mpz_t *z, const char *str, mp_uint_t len, bool neg, m
         z->neg = 0;
     }
 
-    z->len = 0;
-    for (; cur < top; ++cur) { // XXX UTF8 next char
-        //mp_uint_t v = char_to_numeric(cur#); // XXX UTF8 get char
-        mp_uint_t v = *cur;
-        if ('0' <= v && v <= '9') {
-            v -= '0';
-        } else if ('A' <= v && v <= 'Z') {
-            v -= 'A' - 10;
-        } else if ('a' <= v && v <= 'z') {
-            v -= 'a' - 10;
-        } else {
-            break;
+    return len;
+}
+
+/* sets z to the value of the len bytes at buf
+   if is_signed is set the bytes are taken as a two's complement number
+*/
+void mpz_set_from_bytes(mpz_t *z, bool big_endian, bool is_signed, mp_uint_t len, const byte *buf) {
+    int delta = 1;
+    if (big_endian) {
+        delta = -1;
+        buf += len - 1;
+    }
+    bool neg = is_signed && len > 0 && (buf[delta * (mp_int_t)(len - 1)] & 0x80) != 0;
+
+    mpz_need_dig(z, (len * 8 + DIG_SIZE - 1) / DIG_SIZE);
+    mpz_dig_t *d = z->dig;
+    mpz_dbl_dig_t acc = 0;
+    mpz_dbl_dig_t carry = 1;
+    mp_uint_t nacc = 0;
+    for (; len > 0; --len, buf += delta) {
+        mpz_dbl_dig_t val = *buf;
+        if (neg) {
+            // negate, to get the magnitude
+            carry += (byte)~val;
+            val = carry & 0xff;
+            carry >>= 8;
         }
-        if (v >= base) {
-            break;
+        acc |= val << nacc;
+        nacc += 8;
+        if (nacc >= DIG_SIZE) {
+            *d++ = acc & DIG_MASK;
+            acc >>= DIG_SIZE;
+            nacc -= DIG_SIZE;
         }
-        z->len = mpn_mul_dig_add_dig(z->dig, z->len, base, v);
     }
-
-    return cur - str;
+    if (nacc > 0) {
+        *d++ = acc;
+    }
+    z->len = mpn_remove_trailing_zeros(z->dig, d);
+    z->neg = neg;
 }
 
 bool mpz_is_zero(const mpz_t *z) {
@@ -1315,8 +1728,16 @@ void mpz_mul_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs) {
     }
 
     mpz_need_dig(dest, lhs->len + rhs->len); // min mem l+r-1, max mem l+r
-    memset(dest->dig, 0, dest->alloc * sizeof(mpz_dig_t));
-    dest->len = mpn_mul(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len);
+    mp_uint_t scratch_len = mpn_mul_scratch(lhs->len, rhs->len);
+    mpz_dig_t *scratch = NULL;
+    if (scratch_len > 0) {
+        scratch = m_new(mpz_dig_t, scratch_len);
+    }
+    mpn_mul_full(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len, scratch);
+    dest->len = mpn_remove_trailing_zeros(dest->dig, dest->dig + lhs->len + rhs->len);
+    if (scratch != NULL) {
+        m_del(mpz_dig_t, scratch, scratch_len);
+    }
 
     if (lhs->neg == rhs->neg) {
         dest->neg = 0;
@@ -1361,47 +1782,172 @@ void mpz_pow_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs) {
     mpz_free(n);
 }
 
-#if 0
-these functions are unused
+#if MICROPY_PY_BUILTINS_POW3
 
-/* computes dest = (lhs ** rhs) % mod
+/* computes i = t / B^mlen mod m (Montgomery reduction)
+   t has 2 * mlen + 1 digits and is destroyed; i gets mlen digits (not normalised)
+   assumes m is odd and normalised; assumes t < m * B^mlen; minv = -1/m mod B
+*/
+STATIC void mpn_redc(mpz_dig_t *idig, mpz_dig_t *tdig, const mpz_dig_t *mdig, mp_uint_t mlen, mpz_dig_t minv) {
+    for (mp_uint_t a = 0; a < mlen; ++a) {
+        // add u * m * B^a so that digit a of t becomes zero
+        mpz_dig_t u = ((mpz_dbl_dig_t)tdig[a] * (mpz_dbl_dig_t)minv) & DIG_MASK;
+        mpz_dig_t *td = tdig + a;
+        mpz_dbl_dig_t carry = 0;
+        for (mp_uint_t b = 0; b < mlen; ++b, ++td) {
+            carry += (mpz_dbl_dig_t)*td + (mpz_dbl_dig_t)u * (mpz_dbl_dig_t)mdig[b];
+            *td = carry & DIG_MASK;
+            carry >>= DIG_SIZE;
+        }
+        for (; carry != 0; ++td) {
+            carry += *td;
+            *td = carry & DIG_MASK;
+            carry >>= DIG_SIZE;
+        }
+    }
+
+    // the result t / B^mlen is less than 2 * m
+    tdig += mlen;
+    int cmp = tdig[mlen] != 0;
+    for (mp_uint_t a = mlen; cmp == 0 && a-- > 0;) {
+        if (tdig[a] != mdig[a]) {
+            cmp = tdig[a] > mdig[a] ? 1 : -1;
+        }
+    }
+    if (cmp >= 0) {
+        mpn_sub_fixed(tdig, tdig, mlen, mdig, mlen);
+    }
+    memcpy(idig, tdig, mlen * sizeof(mpz_dig_t));
+}
+
+/* computes i = j * k / B^mlen mod m (Montgomery multiplication)
+   j, k, i have mlen digits and j, k < m; can have i, j, k the same
+   t is scratch of 2 * mlen + 1 digits followed by mpn_mul_scratch(mlen, mlen) digits
+*/
+STATIC void mpn_montmul(mpz_dig_t *idig, const mpz_dig_t *jdig, const mpz_dig_t *kdig, const mpz_dig_t *mdig, mp_uint_t mlen, mpz_dig_t minv, mpz_dig_t *tdig) {
+    mpn_mul_full(tdig, jdig, mlen, kdig, mlen, tdig + 2 * mlen + 1);
+    tdig[2 * mlen] = 0;
+    mpn_redc(idig, tdig, mdig, mlen, minv);
+}
+
+/* copies z into i, zero padding it to len digits
+   assumes z->len <= len
+*/
+STATIC void mpn_set_padded(mpz_dig_t *idig, mp_uint_t len, const mpz_t *z) {
+    memcpy(idig, z->dig, z->len * sizeof(mpz_dig_t));
+    memset(idig + z->len, 0, (len - z->len) * sizeof(mpz_dig_t));
+}
+
+/* computes dest = (lhs ** rhs) % mod, with the sign of the result following Python
    can have dest, lhs, rhs the same; mod can't be the same as dest
+   assumes rhs >= 0 and mod != 0
+   if mod is odd the powering is done in Montgomery form, which replaces the
+   long division after each multiplication with a cheaper reduction step
 */
 void mpz_pow3_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs, const mpz_t *mod) {
-    if (lhs->len == 0 || rhs->neg != 0) {
-        mpz_set_from_int(dest, 0);
-        return;
+    assert(!mpz_is_zero(mod) && !rhs->neg);
+
+    // compute abs(lhs) ** rhs % abs(mod) and fix up the signs at the end
+    mpz_t labs = *lhs;
+    labs.neg = 0;
+    mpz_t mabs = *mod;
+    mabs.neg = 0;
+    bool neg = lhs->neg && rhs->len > 0 && (rhs->dig[0] & 1) != 0;
+
+    mpz_t x, r, t, quo;
+    mpz_init_zero(&x);
+    mpz_init_zero(&r);
+    mpz_init_zero(&t);
+    mpz_init_zero(&quo);
+    mpz_divmod_inpl(&quo, &x, &labs, &mabs);
+
+    mp_uint_t nbits = 0;
+    if (rhs->len > 0) {
+        nbits = (rhs->len - 1) * DIG_SIZE;
+        for (mpz_dig_t d = rhs->dig[rhs->len - 1]; d != 0; d >>= 1) {
+            ++nbits;
+        }
     }
+    #define RHS_BIT(b) ((rhs->dig[(b) / DIG_SIZE] >> ((b) % DIG_SIZE)) & 1)
 
-    if (rhs->len == 0) {
-        mpz_set_from_int(dest, 1);
-        return;
-    }
+    if ((mabs.dig[0] & 1) != 0 && (mabs.len > 1 || mabs.dig[0] != 1)) {
+        mp_uint_t n = mabs.len;
 
-    mpz_t *x = mpz_clone(lhs);
-    mpz_t *n = mpz_clone(rhs);
-    mpz_t quo; mpz_init_zero(&quo);
+        // minv = -1/m mod B, by Newton iteration (m * m = 1 mod 8 for odd m)
+        mpz_dbl_dig_t m0 = mabs.dig[0];
+        mpz_dbl_dig_t inv = m0;
+        for (int bits = 3; bits < DIG_SIZE; bits *= 2) {
+            inv = (inv * (2 - m0 * inv)) & DIG_MASK;
+        }
+        mpz_dig_t minv = (0 - inv) & DIG_MASK;
+
+        mp_uint_t buf_len = 4 * n + 1 + mpn_mul_scratch(n, n);
+        mpz_dig_t *buf = m_new(mpz_dig_t, buf_len);
+        mpz_dig_t *xm = buf;
+        mpz_dig_t *acc = buf + n;
+        mpz_dig_t *tdig = buf + 2 * n;
+
+        // convert x and 1 to Montgomery form, x * R % m and R % m with R = B^n
+        mpz_shl_inpl(&t, &x, n * DIG_SIZE);
+        mpz_divmod_inpl(&quo, &r, &t, &mabs);
+        mpn_set_padded(xm, n, &r);
+        mpz_set_from_int(&t, 1);
+        mpz_shl_inpl(&t, &t, n * DIG_SIZE);
+        mpz_divmod_inpl(&quo, &r, &t, &mabs);
+        mpn_set_padded(acc, n, &r);
+
+        for (mp_uint_t b = nbits; b-- > 0;) {
+            mpn_montmul(acc, acc, acc, mabs.dig, n, minv, tdig);
+            if (RHS_BIT(b)) {
+                mpn_montmul(acc, acc, xm, mabs.dig, n, minv, tdig);
+            }
+        }
 
-    mpz_set_from_int(dest, 1);
+        // convert back out of Montgomery form
+        memcpy(tdig, acc, n * sizeof(mpz_dig_t));
+        memset(tdig + n, 0, (n + 1) * sizeof(mpz_dig_t));
+        mpn_redc(acc, tdig, mabs.dig, n, minv);
+        mpz_need_dig(&r, n);
+        memcpy(r.dig, acc, n * sizeof(mpz_dig_t));
+        r.len = mpn_remove_trailing_zeros(r.dig, r.dig + n);
+        r.neg = 0;
 
-    while (n->len > 0) {
-        if ((n->dig[0] & 1) != 0) {
-            mpz_mul_inpl(dest, dest, x);
-            mpz_divmod_inpl(&quo, dest, dest, mod);
+        m_del(mpz_dig_t, buf, buf_len);
+    } else {
+        mpz_set_from_int(&t, 1);
+        mpz_divmod_inpl(&quo, &r, &t, &mabs);
+        for (mp_uint_t b = nbits; b-- > 0;) {
+            mpz_mul_inpl(&t, &r, &r);
+            mpz_divmod_inpl(&quo, &r, &t, &mabs);
+            if (RHS_BIT(b)) {
+                mpz_mul_inpl(&t, &r, &x);
+                mpz_divmod_inpl(&quo, &r, &t, &mabs);
+            }
         }
-        n->len = mpn_shr(n->dig, n->dig, n->len, 1);
-        if (n->len == 0) {
-            break;
+    }
+
+    #undef RHS_BIT
+
+    // Python semantics: the result is zero or has the same sign as mod
+    if (r.len != 0) {
+        if (neg != mod->neg) {
+            mpz_sub_inpl(&r, &mabs, &r);
         }
-        mpz_mul_inpl(x, x, x);
-        mpz_divmod_inpl(&quo, x, x, mod);
+        r.neg = mod->neg;
     }
+    mpz_set(dest, &r);
 
+    mpz_deinit(&x);
+    mpz_deinit(&r);
+    mpz_deinit(&t);
     mpz_deinit(&quo);
-    mpz_free(x);
-    mpz_free(n);
 }
 
+#endif
+
+#if 0
+these functions are unused
+
 /* computes gcd(z1, z2)
    based on Knuth's modified gcd algorithm (I think?)
    gcd(z1, z2) >= 0
@@ -1589,37 +2135,60 @@ bool mpz_as_uint_checked(const mpz_t *i, mp_uint_t *value) {
     return true;
 }
 
-// writes at most len bytes to buf (so buf should be zeroed before calling)
-void mpz_as_bytes(const mpz_t *z, bool big_endian, mp_uint_t len, byte *buf) {
+/* writes z to the len bytes at buf in two's complement, truncating it if needed
+   returns true if the value fits, as a signed number if as_signed is set,
+   otherwise as an unsigned one
+*/
+bool mpz_as_bytes(const mpz_t *z, bool big_endian, bool as_signed, mp_uint_t len, byte *buf) {
     byte *b = buf;
     if (big_endian) {
         b += len;
     }
-    mpz_dig_t *zdig = z->dig;
+    const mpz_dig_t *zdig = z->dig;
+    const mpz_dig_t *ztop = zdig + z->len;
     int bits = 0;
     mpz_dbl_dig_t d = 0;
     mpz_dbl_dig_t carry = 1;
-    for (mp_uint_t zlen = z->len; zlen > 0; --zlen) {
-        bits += DIG_SIZE;
-        d = (d << DIG_SIZE) | *zdig++;
-        for (; bits >= 8; bits -= 8, d >>= 8) {
-            mpz_dig_t val = d;
-            if (z->neg) {
-                val = (~val & 0xff) + carry;
-                carry = val >> 8;
-            }
-            if (big_endian) {
-                *--b = val;
-                if (b == buf) {
-                    return;
-                }
+    byte val = 0;
+    for (mp_uint_t n = len; n > 0; --n) {
+        if (bits < 8) {
+            if (zdig < ztop) {
+                d |= (mpz_dbl_dig_t)*zdig++ << bits;
+                bits += DIG_SIZE;
             } else {
-                *b++ = val;
-                if (b == buf + len) {
-                    return;
-                }
+                bits = 8;
             }
         }
+        val = (byte)d;
+        d >>= 8;
+        bits -= 8;
+        if (z->neg) {
+            carry += (byte)~val;
+            val = carry;
+            carry >>= 8;
+        }
+        if (big_endian) {
+            *--b = val;
+        } else {
+            *b++ = val;
+        }
+    }
+
+    // check that no bits of the magnitude were left over
+    if (d != 0) {
+        return false;
+    }
+    for (; zdig < ztop; ++zdig) {
+        if (*zdig != 0) {
+            return false;
+        }
+    }
+
+    // check the sign is representable
+    if (z->neg && z->len != 0) {
+        return as_signed && len > 0 && (val & 0x80) != 0;
+    } else {
+        return !as_signed || len == 0 || (val & 0x80) == 0;
     }
 }
 
@@ -1649,6 +2218,106 @@ char *mpz_as_str(const mpz_t *i, mp_uint_t base) {
 }
 #endif
 
+/* converts a number to chars, least significant first, and returns the end of them
+   dig is destroyed; zero pads the output to at least width chars
+*/
+STATIC char *mpn_as_str_rev(char *s, mpz_dig_t *dig, mp_uint_t len, mp_uint_t base, char base_char, mp_uint_t width) {
+    char *start = s;
+    mp_uint_t k;
+    mpz_dig_t chunk = mpz_base_chunk(base, &k);
+
+    while (len > 0 && dig[len - 1] == 0) {
+        --len;
+    }
+    while (len > 0) {
+        // divide by base ** k, giving the next k chars in the remainder
+        mpz_dig_t *d = dig + len;
+        mpz_dbl_dig_t a = 0;
+        while (--d >= dig) {
+            a = (a << DIG_SIZE) | *d;
+            *d = a / chunk;
+            a %= chunk;
+        }
+        if (dig[len - 1] == 0) {
+            --len;
+        }
+
+        for (mp_uint_t n = k; n > 0 && (len > 0 || a != 0); --n) {
+            mpz_dig_t c = a % base;
+            a /= base;
+            *s++ = c < 10 ? '0' + c : base_char + c - 10;
+        }
+    }
+    while ((mp_uint_t)(s - start) < width) {
+        *s++ = '0';
+    }
+    return s;
+}
+
+/* as mpn_as_str_rev, for base 1 << bits, in linear time
+   zero is converted to no chars
+*/
+STATIC char *mpn_as_str_rev_pow2(char *s, const mpz_dig_t *dig, mp_uint_t len, mp_uint_t bits, char base_char) {
+    char *start = s;
+    mpz_dig_t mask = (1 << bits) - 1;
+    mpz_dbl_dig_t acc = 0;
+    mp_uint_t nacc = 0;
+    for (const mpz_dig_t *top = dig + len; dig < top; ++dig) {
+        acc |= (mpz_dbl_dig_t)*dig << nacc;
+        nacc += DIG_SIZE;
+        for (; nacc >= bits; nacc -= bits) {
+            mpz_dig_t c = acc & mask;
+            acc >>= bits;
+            *s++ = c < 10 ? '0' + c : base_char + c - 10;
+        }
+    }
+    if (nacc > 0) {
+        *s++ = acc < 10 ? '0' + acc : base_char + acc - 10;
+    }
+    // remove leading zeros
+    while (s > start && s[-1] == '0') {
+        --s;
+    }
+    return s;
+}
+
+#if MICROPY_OPT_MPZ_KARATSUBA
+
+/* as mpn_as_str_rev, for big numbers
+   pows[j] is base ** (k << j), recips[j] is mpz_recip(pows[j]) and x < pows[j] ** 2
+   x is divided by pows[j] and each half converted recursively
+*/
+STATIC char *mpz_as_str_rev_dc(char *s, const mpz_t *x, mp_uint_t base, char base_char, mp_uint_t width, mp_uint_t k, const mpz_t *pows, const mpz_t *recips, int j) {
+    if (j < 0 || x->len < MPZ_STR_DC_THRESHOLD) {
+        mpz_dig_t *dig = m_new(mpz_dig_t, x->len);
+        memcpy(dig, x->dig, x->len * sizeof(mpz_dig_t));
+        s = mpn_as_str_rev(s, dig, x->len, base, base_char, width);
+        m_del(mpz_dig_t, dig, x->len);
+        return s;
+    }
+
+    mpz_t quo, rem;
+    mpz_init_zero(&quo);
+    mpz_init_zero(&rem);
+    mpz_divmod_recip(&quo, &rem, x, &pows[j], &recips[j]);
+
+    if (quo.len == 0) {
+        // x < pows[j] so it is just the low half
+        s = mpz_as_str_rev_dc(s, &rem, base, base_char, width, k, pows, recips, j - 1);
+    } else {
+        // the low half is exactly k << j chars
+        mp_uint_t m = k << j;
+        s = mpz_as_str_rev_dc(s, &rem, base, base_char, m, k, pows, recips, j - 1);
+        s = mpz_as_str_rev_dc(s, &quo, base, base_char, width > m ? width - m : 0, k, pows, recips, j - 1);
+    }
+
+    mpz_deinit(&quo);
+    mpz_deinit(&rem);
+    return s;
+}
+
+#endif
+
 // assumes enough space as calculated by mp_int_format_size
 // returns length of string, not including null byte
 mp_uint_t mpz_as_str_inpl(const mpz_t *i, mp_uint_t base, const char *prefix, char base_char, char comma, char *str) {
@@ -1673,48 +2342,58 @@ mp_uint_t mpz_as_str_inpl(const mpz_t *i, mp_uint_t base, const char *prefix, ch
         return s - str;
     }
 
-    // make a copy of mpz digits, so we can do the div/mod calculation
-    mpz_dig_t *dig = m_new(mpz_dig_t, ilen);
-    memcpy(dig, i->dig, ilen * sizeof(mpz_dig_t));
-
-    // convert
-    char *last_comma = str;
-    bool done;
-    do {
-        mpz_dig_t *d = dig + ilen;
-        mpz_dbl_dig_t a = 0;
-
-        // compute next remainder
-        while (--d >= dig) {
-            a = (a << DIG_SIZE) | *d;
-            *d = a / base;
-            a %= base;
-        }
-
-        // convert to character
-        a += '0';
-        if (a > '9') {
-            a += base_char - '9' - 1;
-        }
-        *s++ = a;
-
-        // check if number is zero
-        done = true;
-        for (d = dig; d < dig + ilen; ++d) {
-            if (*d != 0) {
-                done = false;
+    // convert, least significant char first
+    mp_uint_t bits = mpz_base_bits(base);
+    if (bits != 0) {
+        s = mpn_as_str_rev_pow2(s, i->dig, ilen, bits, base_char);
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    } else if (ilen >= MPZ_STR_DC_THRESHOLD) {
+        // pows[j] = base ** (k << j), up to the first one whose square exceeds i
+        mp_uint_t k;
+        mpz_t pows[BITS_PER_WORD];
+        mpz_t recips[BITS_PER_WORD];
+        mpz_t iabs = *i;
+        iabs.neg = 0;
+        mpz_init_from_int(&pows[0], mpz_base_chunk(base, &k));
+        int j = 0;
+        for (;;) {
+            mpz_init_zero(&pows[j + 1]);
+            mpz_mul_inpl(&pows[j + 1], &pows[j], &pows[j]);
+            if (mpz_cmp(&pows[j + 1], &iabs) > 0) {
+                mpz_deinit(&pows[j + 1]);
                 break;
             }
+            ++j;
+        }
+        for (int n = 0; n <= j; ++n) {
+            mpz_init_zero(&recips[n]);
+            mpz_recip(&recips[n], &pows[n]);
+        }
+        s = mpz_as_str_rev_dc(s, &iabs, base, base_char, 0, k, pows, recips, j);
+        for (; j >= 0; --j) {
+            mpz_deinit(&pows[j]);
+            mpz_deinit(&recips[j]);
         }
-        if (comma && (s - last_comma) == 3) {
-            *s++ = comma;
-            last_comma = s;
+    #endif
+    } else {
+        // make a copy of mpz digits, so we can do the div/mod calculation
+        mpz_dig_t *dig = m_new(mpz_dig_t, ilen);
+        memcpy(dig, i->dig, ilen * sizeof(mpz_dig_t));
+        s = mpn_as_str_rev(s, dig, ilen, base, base_char, 0);
+        m_del(mpz_dig_t, dig, ilen);
+    }
+
+    // insert a comma between each group of 3 chars, working backwards
+    if (comma) {
+        mp_uint_t n = s - str;
+        s += (n - 1) / 3;
+        for (mp_uint_t p = n; p-- > 0;) {
+            str[p + p / 3] = str[p];
+            if (p % 3 == 0 && p > 0) {
+                str[p + p / 3 - 1] = comma;
+            }
         }
     }
-    while (!done);
-
-    // free the copy of the digits array
-    m_del(mpz_dig_t, dig, ilen);
 
     if (prefix) {
         const char *p = &prefix[strlen(prefix)];
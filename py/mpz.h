@@ -54,6 +54,24 @@
   #endif
 #endif
 
+// Operands with at least this many digits are multiplied using Karatsuba's
+// method (if MICROPY_OPT_MPZ_KARATSUBA is enabled), smaller ones use the
+// schoolbook method.  Must be at least 4.
+#ifndef MPZ_KARATSUBA_THRESHOLD
+  #if MPZ_DIG_SIZE > 16
+    #define MPZ_KARATSUBA_THRESHOLD (32)
+  #else
+    #define MPZ_KARATSUBA_THRESHOLD (48)
+  #endif
+#endif
+
+// Numbers with at least this many digits are converted to and from strings
+// by splitting them in halves (if MICROPY_OPT_MPZ_KARATSUBA is enabled),
+// smaller ones a digit at a time.
+#ifndef MPZ_STR_DC_THRESHOLD
+#define MPZ_STR_DC_THRESHOLD (2 * MPZ_KARATSUBA_THRESHOLD)
+#endif
+
 #if MPZ_DIG_SIZE > 16
 typedef uint32_t mpz_dig_t;
 typedef uint64_t mpz_dbl_dig_t;
@@ -109,6 +127,7 @@ void mpz_set_from_ll(mpz_t *z, long long i, bool is_signed);
 void mpz_set_from_float(mpz_t *z, mp_float_t src);
 #endif
 mp_uint_t mpz_set_from_str(mpz_t *z, const char *str, mp_uint_t len, bool neg, mp_uint_t base);
+void mpz_set_from_bytes(mpz_t *z, bool big_endian, bool is_signed, mp_uint_t len, const byte *buf);
 
 bool mpz_is_zero(const mpz_t *z);
 int mpz_cmp(const mpz_t *lhs, const mpz_t *rhs);
@@ -122,6 +141,7 @@ void mpz_add_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs);
 void mpz_sub_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs);
 void mpz_mul_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs);
 void mpz_pow_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs);
+void mpz_pow3_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs, const mpz_t *mod);
 void mpz_and_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs);
 void mpz_or_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs);
 void mpz_xor_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs);
@@ -131,7 +151,7 @@ static inline size_t mpz_max_num_bits(const mpz_t *z) { return z->len * MPZ_DIG_
 mp_int_t mpz_hash(const mpz_t *z);
 bool mpz_as_int_checked(const mpz_t *z, mp_int_t *value);
 bool mpz_as_uint_checked(const mpz_t *z, mp_uint_t *value);
-void mpz_as_bytes(const mpz_t *z, bool big_endian, mp_uint_t len, byte *buf);
+bool mpz_as_bytes(const mpz_t *z, bool big_endian, bool as_signed, mp_uint_t len, byte *buf);
 #if MICROPY_PY_BUILTINS_FLOAT
 mp_float_t mpz_as_float(const mpz_t *z);
 #endif
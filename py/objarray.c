@@ -570,6 +570,13 @@ mp_uint_t mp_obj_array_len(mp_obj_t self_in) {
 }
 */
 
+#if MICROPY_PY_ARRAY_OPS
+// Create array of given typecode with n uninitialised elements
+mp_obj_t mp_obj_new_array(char typecode, mp_uint_t n) {
+    return MP_OBJ_FROM_PTR(array_new(typecode, n));
+}
+#endif
+
 #if MICROPY_PY_BUILTINS_BYTEARRAY
 mp_obj_t mp_obj_new_bytearray(mp_uint_t n, void *items) {
     mp_obj_array_t *o = array_new(BYTEARRAY_TYPECODE, n);
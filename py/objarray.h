@@ -40,4 +40,6 @@ typedef struct _mp_obj_array_t {
     void *items;
 } mp_obj_array_t;
 
+mp_obj_t mp_obj_new_array(char typecode, mp_uint_t n);
+
 #endif // __MICROPY_INCLUDED_PY_OBJARRAY_H__
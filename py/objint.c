@@ -380,54 +380,132 @@ mp_obj_t mp_obj_int_binary_op_extra_cases(mp_uint_t op, mp_obj_t lhs_in, mp_obj_
     return MP_OBJ_NULL; // op not supported
 }
 
+// returns true for 'big', false for 'little'
+STATIC bool int_get_byteorder(mp_obj_t byteorder_in) {
+    qstr byteorder = mp_obj_str_get_qstr(byteorder_in);
+    if (byteorder != MP_QSTR_little && byteorder != MP_QSTR_big) {
+        mp_raise_ValueError("byteorder must be either 'little' or 'big'");
+    }
+    return byteorder == MP_QSTR_big;
+}
+
 // this is a classmethod
-STATIC mp_obj_t int_from_bytes(size_t n_args, const mp_obj_t *args) {
-    // TODO: Support long ints
-    // TODO: Support byteorder param (assumes 'little' at the moment)
-    // TODO: Support signed param (assumes signed=False at the moment)
-    (void)n_args;
+STATIC mp_obj_t int_from_bytes(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    // Note: byteorder defaults to 'little', for compatibility with earlier versions
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_bytes, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_byteorder, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_QSTR(MP_QSTR_little)} },
+        { MP_QSTR_signed, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    bool big_endian = int_get_byteorder(args[1].u_obj);
+    bool is_signed = args[2].u_bool;
 
     // get the buffer info
     mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+    mp_get_buffer_raise(args[0].u_obj, &bufinfo, MP_BUFFER_READ);
+    const byte *buf = bufinfo.buf;
+    size_t len = bufinfo.len;
+
+    // strip leading bytes that only carry the sign, so that values with
+    // redundant padding don't needlessly take the long-int path
+    while (len > 0) {
+        const byte *msb = big_endian ? buf : buf + len - 1;
+        if (*msb == 0 && (!is_signed || len == 1 || (msb[big_endian ? 1 : -1] & 0x80) == 0)) {
+            // a zero byte is redundant unless it clears the sign of the next one
+        } else if (is_signed && *msb == 0xff && len > 1 && (msb[big_endian ? 1 : -1] & 0x80) != 0) {
+            // likewise for a 0xff byte in front of a negative value
+        } else {
+            break;
+        }
+        if (big_endian) {
+            buf += 1;
+        }
+        len -= 1;
+    }
 
-    // convert the bytes to an integer
-    mp_uint_t value = 0;
-    for (const byte* buf = (const byte*)bufinfo.buf + bufinfo.len - 1; buf >= (byte*)bufinfo.buf; buf--) {
-        value = (value << 8) | *buf;
+    if (len <= sizeof(long long)) {
+        if (len == 0) {
+            return MP_OBJ_NEW_SMALL_INT(0);
+        }
+        long long val = mp_binary_get_int(len, is_signed, big_endian, buf);
+        if (MP_SMALL_INT_MIN <= val && val <= MP_SMALL_INT_MAX && (is_signed || val >= 0)) {
+            return MP_OBJ_NEW_SMALL_INT(val);
+        } else if (is_signed) {
+            return mp_obj_new_int_from_ll(val);
+        } else {
+            return mp_obj_new_int_from_ull(val);
+        }
     }
 
-    return mp_obj_new_int_from_uint(value);
+    #if MICROPY_LONGINT_IMPL != MICROPY_LONGINT_IMPL_NONE
+    return mp_obj_int_from_bytes_impl(big_endian, is_signed, len, buf);
+    #else
+    mp_raise_msg(&mp_type_OverflowError, "small int overflow");
+    #endif
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(int_from_bytes_fun_obj, 2, 3, int_from_bytes);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(int_from_bytes_fun_obj, 2, int_from_bytes);
 STATIC MP_DEFINE_CONST_CLASSMETHOD_OBJ(int_from_bytes_obj, MP_ROM_PTR(&int_from_bytes_fun_obj));
 
-STATIC mp_obj_t int_to_bytes(size_t n_args, const mp_obj_t *args) {
-    // TODO: Support byteorder param (assumes 'little')
-    // TODO: Support signed param (assumes signed=False)
-    (void)n_args;
+STATIC mp_obj_t int_to_bytes(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    // Note: byteorder defaults to 'little', for compatibility with earlier versions
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_length, MP_ARG_INT, {.u_int = 1} },
+        { MP_QSTR_byteorder, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_QSTR(MP_QSTR_little)} },
+        { MP_QSTR_signed, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t self_in = pos_args[0];
+    if (args[0].u_int < 0) {
+        mp_raise_ValueError("length argument must be non-negative");
+    }
+    size_t len = args[0].u_int;
+    bool big_endian = int_get_byteorder(args[1].u_obj);
+    bool is_signed = args[2].u_bool;
 
-    mp_uint_t len = MP_OBJ_SMALL_INT_VALUE(args[1]);
+    if (!is_signed && mp_obj_int_sign(self_in) < 0) {
+        mp_raise_msg(&mp_type_OverflowError, "can't convert negative int to unsigned");
+    }
 
     vstr_t vstr;
     vstr_init_len(&vstr, len);
     byte *data = (byte*)vstr.buf;
-    memset(data, 0, len);
+    bool fits;
 
     #if MICROPY_LONGINT_IMPL != MICROPY_LONGINT_IMPL_NONE
-    if (!MP_OBJ_IS_SMALL_INT(args[0])) {
-        mp_obj_int_to_bytes_impl(args[0], false, len, data);
+    if (!MP_OBJ_IS_SMALL_INT(self_in)) {
+        fits = mp_obj_int_to_bytes_impl(self_in, big_endian, is_signed, len, data);
     } else
     #endif
     {
-        mp_int_t val = MP_OBJ_SMALL_INT_VALUE(args[0]);
-        mp_binary_set_int(MIN((size_t)len, sizeof(val)), false, data, val);
+        mp_int_t val = MP_OBJ_SMALL_INT_VALUE(self_in);
+        size_t n = MIN(len, sizeof(val));
+        byte *dest = big_endian ? data + len - n : data;
+        memset(data, val < 0 ? 0xff : 0, len);
+        mp_binary_set_int(n, big_endian, dest, val);
+        if (len >= sizeof(val)) {
+            fits = true;
+        } else if (len == 0) {
+            fits = val == 0;
+        } else {
+            // the value fits if it survives the round trip
+            fits = mp_binary_get_int(n, is_signed, big_endian, dest) == val;
+        }
+    }
+
+    if (!fits) {
+        vstr_clear(&vstr);
+        mp_raise_msg(&mp_type_OverflowError, "int too big to convert");
     }
 
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(int_to_bytes_obj, 2, 4, int_to_bytes);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(int_to_bytes_obj, 1, int_to_bytes);
 
 STATIC const mp_rom_map_elem_t int_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_from_bytes), MP_ROM_PTR(&int_from_bytes_obj) },
@@ -33,6 +33,7 @@
 #include "py/objint.h"
 #include "py/runtime0.h"
 #include "py/runtime.h"
+#include "py/binary.h"
 
 #if MICROPY_PY_BUILTINS_FLOAT
 #include <math.h>
@@ -53,10 +54,33 @@
 const mp_obj_int_t mp_maxsize_obj = {{&mp_type_int}, MP_SSIZE_MAX};
 #endif
 
-void mp_obj_int_to_bytes_impl(mp_obj_t self_in, bool big_endian, size_t len, byte *buf) {
+mp_obj_t mp_obj_int_from_bytes_impl(bool big_endian, bool is_signed, size_t len, const byte *buf) {
+    if (len > sizeof(long long)) {
+        nlr_raise(mp_obj_new_exception_msg_varg(&mp_type_OverflowError, "int too big to convert"));
+    }
+    long long val = mp_binary_get_int(len, is_signed, big_endian, buf);
+    if (is_signed) {
+        return mp_obj_new_int_from_ll(val);
+    } else {
+        return mp_obj_new_int_from_ull(val);
+    }
+}
+
+bool mp_obj_int_to_bytes_impl(mp_obj_t self_in, bool big_endian, bool as_signed, size_t len, byte *buf) {
     assert(MP_OBJ_IS_TYPE(self_in, &mp_type_int));
     mp_obj_int_t *self = self_in;
     long long val = self->val;
+    bool fits;
+    if (len >= sizeof(long long)) {
+        fits = as_signed || val >= 0;
+    } else if (len == 0) {
+        fits = val == 0;
+    } else if (as_signed) {
+        long long top = val >> (len * 8 - 1);
+        fits = top == 0 || top == -1;
+    } else {
+        fits = (val >> (len * 8)) == 0;
+    }
     if (big_endian) {
         byte *b = buf + len;
         while (b > buf) {
@@ -69,6 +93,7 @@ void mp_obj_int_to_bytes_impl(mp_obj_t self_in, bool big_endian, size_t len, byt
             val >>= 8;
         }
     }
+    return fits;
 }
 
 int mp_obj_int_sign(mp_obj_t self_in) {
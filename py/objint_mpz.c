@@ -107,10 +107,20 @@ char *mp_obj_int_formatted_impl(char **buf, size_t *buf_size, size_t *fmt_size,
     return str;
 }
 
-void mp_obj_int_to_bytes_impl(mp_obj_t self_in, bool big_endian, size_t len, byte *buf) {
+mp_obj_t mp_obj_int_from_bytes_impl(bool big_endian, bool is_signed, size_t len, const byte *buf) {
+    mp_obj_int_t *o = mp_obj_int_new_mpz();
+    mpz_set_from_bytes(&o->mpz, big_endian, is_signed, len, buf);
+    mp_int_t value;
+    if (mpz_as_int_checked(&o->mpz, &value) && MP_SMALL_INT_FITS(value)) {
+        return MP_OBJ_NEW_SMALL_INT(value);
+    }
+    return MP_OBJ_FROM_PTR(o);
+}
+
+bool mp_obj_int_to_bytes_impl(mp_obj_t self_in, bool big_endian, bool as_signed, size_t len, byte *buf) {
     assert(MP_OBJ_IS_TYPE(self_in, &mp_type_int));
     mp_obj_int_t *self = MP_OBJ_TO_PTR(self_in);
-    mpz_as_bytes(&self->mpz, big_endian, len, buf);
+    return mpz_as_bytes(&self->mpz, big_endian, as_signed, len, buf);
 }
 
 int mp_obj_int_sign(mp_obj_t self_in) {
@@ -322,6 +332,42 @@ mp_obj_t mp_obj_int_binary_op(mp_uint_t op, mp_obj_t lhs_in, mp_obj_t rhs_in) {
     }
 }
 
+#if MICROPY_PY_BUILTINS_POW3
+// computes pow(base, exponent, modulus) for int arguments
+mp_obj_t mp_obj_int_pow3(mp_obj_t base, mp_obj_t exponent, mp_obj_t modulus) {
+    mpz_t z_args[3];
+    mpz_dig_t z_args_dig[3][MPZ_NUM_DIG_FOR_INT];
+    const mpz_t *zargs[3];
+    mp_obj_t args[3] = {base, exponent, modulus};
+
+    for (int i = 0; i < 3; ++i) {
+        if (MP_OBJ_IS_SMALL_INT(args[i])) {
+            mpz_init_fixed_from_int(&z_args[i], z_args_dig[i], MPZ_NUM_DIG_FOR_INT, MP_OBJ_SMALL_INT_VALUE(args[i]));
+            zargs[i] = &z_args[i];
+        } else {
+            zargs[i] = &((mp_obj_int_t*)MP_OBJ_TO_PTR(args[i]))->mpz;
+        }
+    }
+
+    if (zargs[1]->neg) {
+        // negative exponent gives a float, so use the general case
+        return mp_binary_op(MP_BINARY_OP_MODULO, mp_binary_op(MP_BINARY_OP_POWER, base, exponent), modulus);
+    }
+    if (mpz_is_zero(zargs[2])) {
+        mp_raise_msg(&mp_type_ValueError, "pow() 3rd argument cannot be 0");
+    }
+
+    mp_obj_int_t *res = mp_obj_int_new_mpz();
+    mpz_pow3_inpl(&res->mpz, zargs[0], zargs[1], zargs[2]);
+
+    mp_int_t value;
+    if (mpz_as_int_checked(&res->mpz, &value) && MP_SMALL_INT_FITS(value)) {
+        return MP_OBJ_NEW_SMALL_INT(value);
+    }
+    return MP_OBJ_FROM_PTR(res);
+}
+#endif
+
 mp_obj_t mp_obj_new_int(mp_int_t value) {
     if (MP_SMALL_INT_FITS(value)) {
         return MP_OBJ_NEW_SMALL_INT(value);
@@ -29,6 +29,7 @@
 
 #include "py/nlr.h"
 #include "py/objlist.h"
+#include "py/objstr.h"
 #include "py/runtime0.h"
 #include "py/runtime.h"
 #include "py/stackctrl.h"
@@ -281,35 +282,246 @@ STATIC mp_obj_t list_pop(size_t n_args, const mp_obj_t *args) {
     return ret;
 }
 
-STATIC void mp_quicksort(mp_obj_t *head, mp_obj_t *tail, mp_obj_t key_fn, mp_obj_t binop_less_result) {
-    MP_STACK_CHECK();
-    while (head < tail) {
-        mp_obj_t *h = head - 1;
-        mp_obj_t *t = tail;
-        mp_obj_t v = key_fn == MP_OBJ_NULL ? tail[0] : mp_call_function_1(key_fn, tail[0]); // get pivot using key_fn
-        for (;;) {
-            do ++h; while (h < t && mp_binary_op(MP_BINARY_OP_LESS, key_fn == MP_OBJ_NULL ? h[0] : mp_call_function_1(key_fn, h[0]), v) == binop_less_result);
-            do --t; while (h < t && mp_binary_op(MP_BINARY_OP_LESS, v, key_fn == MP_OBJ_NULL ? t[0] : mp_call_function_1(key_fn, t[0])) == binop_less_result);
-            if (h >= t) break;
-            mp_obj_t x = h[0];
-            h[0] = t[0];
-            t[0] = x;
+// Stable natural merge sort.  An element is a group of `stride` objects (1 for
+// a plain sort, 2 for a (key, item) pair when a key function is given) and is
+// compared on its first object.  Existing runs in the input are found and
+// extended to SORT_MIN_RUN elements with binary insertion sort, then merged
+// pairwise bottom-up, so C stack usage is constant and sorted or reversed
+// input takes linear time.
+
+#define SORT_MIN_RUN (16)
+
+enum {
+    SORT_KIND_OBJ,
+    SORT_KIND_SMALL_INT,
+    SORT_KIND_STR,
+};
+
+typedef struct _list_sort_t {
+    mp_obj_t *base;
+    mp_obj_t *tmp;
+    size_t stride;
+    int kind;
+    bool reverse;
+    // During a merge, [hole, hole + (tmp_hi - tmp_lo)) in base are the slots
+    // still to be filled from tmp_lo..tmp_hi.  If a comparison raises, copying
+    // tmp back into the hole restores all the elements.
+    mp_obj_t *hole;
+    mp_obj_t *tmp_lo;
+    mp_obj_t *tmp_hi;
+} list_sort_t;
+
+STATIC bool list_sort_lt(list_sort_t *s, mp_obj_t a, mp_obj_t b) {
+    if (s->reverse) {
+        mp_obj_t t = a;
+        a = b;
+        b = t;
+    }
+    switch (s->kind) {
+        case SORT_KIND_SMALL_INT:
+            return MP_OBJ_SMALL_INT_VALUE(a) < MP_OBJ_SMALL_INT_VALUE(b);
+        case SORT_KIND_STR: {
+            GET_STR_DATA_LEN(a, a_data, a_len);
+            GET_STR_DATA_LEN(b, b_data, b_len);
+            return mp_seq_cmp_bytes(MP_BINARY_OP_LESS, a_data, a_len, b_data, b_len);
         }
-        mp_obj_t x = h[0];
-        h[0] = tail[0];
-        tail[0] = x;
-        // do the smaller recursive call first, to keep stack within O(log(N))
-        if (t - head < tail - h - 1) {
-            mp_quicksort(head, t, key_fn, binop_less_result);
-            head = h + 1;
-        } else {
-            mp_quicksort(h + 1, tail, key_fn, binop_less_result);
-            tail = t;
+        default:
+            return mp_obj_is_true(mp_binary_op(MP_BINARY_OP_LESS, a, b));
+    }
+}
+
+#define SORT_ELEM(s, i) (&(s)->base[(i) * (s)->stride])
+
+STATIC void list_sort_reverse(list_sort_t *s, size_t lo, size_t hi) {
+    while (lo + 1 < hi) {
+        mp_obj_t *a = SORT_ELEM(s, lo++);
+        mp_obj_t *b = SORT_ELEM(s, --hi);
+        for (size_t j = 0; j < s->stride; ++j) {
+            mp_obj_t t = a[j];
+            a[j] = b[j];
+            b[j] = t;
         }
     }
 }
 
-// TODO Python defines sort to be stable but ours is not
+// Return the length of the run starting at lo, reversing it if it's strictly
+// descending (strictly, so that reversing it keeps the sort stable).
+STATIC size_t list_sort_count_run(list_sort_t *s, size_t lo, size_t n) {
+    size_t hi = lo + 1;
+    if (hi == n) {
+        return 1;
+    }
+    if (list_sort_lt(s, SORT_ELEM(s, hi)[0], SORT_ELEM(s, lo)[0])) {
+        do {
+            ++hi;
+        } while (hi < n && list_sort_lt(s, SORT_ELEM(s, hi)[0], SORT_ELEM(s, hi - 1)[0]));
+        list_sort_reverse(s, lo, hi);
+    } else {
+        do {
+            ++hi;
+        } while (hi < n && !list_sort_lt(s, SORT_ELEM(s, hi)[0], SORT_ELEM(s, hi - 1)[0]));
+    }
+    return hi - lo;
+}
+
+// Sort [lo, hi) given that [lo, start) is already sorted.
+STATIC void list_sort_insertion(list_sort_t *s, size_t lo, size_t start, size_t hi) {
+    size_t st = s->stride;
+    for (size_t i = start; i < hi; ++i) {
+        // find the position after all elements not greater than element i
+        mp_obj_t *e = SORT_ELEM(s, i);
+        size_t l = lo;
+        size_t r = i;
+        while (l < r) {
+            size_t m = l + (r - l) / 2;
+            if (list_sort_lt(s, e[0], SORT_ELEM(s, m)[0])) {
+                r = m;
+            } else {
+                l = m + 1;
+            }
+        }
+        if (l < i) {
+            mp_obj_t key = e[0];
+            mp_obj_t item = e[st - 1];
+            memmove(SORT_ELEM(s, l + 1), SORT_ELEM(s, l), (i - l) * st * sizeof(mp_obj_t));
+            SORT_ELEM(s, l)[0] = key;
+            SORT_ELEM(s, l)[st - 1] = item;
+        }
+    }
+}
+
+// Merge the sorted ranges [lo, mid) and [mid, hi), copying the shorter one to
+// tmp so that tmp never needs more than half the elements.
+STATIC void list_sort_merge(list_sort_t *s, size_t lo, size_t mid, size_t hi) {
+    size_t st = s->stride;
+    if (!list_sort_lt(s, SORT_ELEM(s, mid)[0], SORT_ELEM(s, mid - 1)[0])) {
+        // already in order
+        return;
+    }
+    if (mid - lo <= hi - mid) {
+        // merge forwards from the start, with the left range in tmp
+        mp_obj_t *right = SORT_ELEM(s, mid);
+        mp_obj_t *right_top = SORT_ELEM(s, hi);
+        s->hole = SORT_ELEM(s, lo);
+        s->tmp_lo = s->tmp;
+        s->tmp_hi = s->tmp + (mid - lo) * st;
+        memcpy(s->tmp, s->hole, (mid - lo) * st * sizeof(mp_obj_t));
+        while (s->tmp_lo < s->tmp_hi && right < right_top) {
+            if (list_sort_lt(s, right[0], s->tmp_lo[0])) {
+                memcpy(s->hole, right, st * sizeof(mp_obj_t));
+                right += st;
+            } else {
+                memcpy(s->hole, s->tmp_lo, st * sizeof(mp_obj_t));
+                s->tmp_lo += st;
+            }
+            s->hole += st;
+        }
+    } else {
+        // merge backwards from the end, with the right range in tmp
+        mp_obj_t *left_bottom = SORT_ELEM(s, lo);
+        mp_obj_t *dest = SORT_ELEM(s, hi);
+        s->hole = SORT_ELEM(s, mid);
+        s->tmp_lo = s->tmp;
+        s->tmp_hi = s->tmp + (hi - mid) * st;
+        memcpy(s->tmp, s->hole, (hi - mid) * st * sizeof(mp_obj_t));
+        while (s->tmp_lo < s->tmp_hi && s->hole > left_bottom) {
+            dest -= st;
+            if (list_sort_lt(s, s->tmp_hi[-(mp_int_t)st], s->hole[-(mp_int_t)st])) {
+                s->hole -= st;
+                memcpy(dest, s->hole, st * sizeof(mp_obj_t));
+            } else {
+                s->tmp_hi -= st;
+                memcpy(dest, s->tmp_hi, st * sizeof(mp_obj_t));
+            }
+        }
+    }
+    // fill the hole with what's left in tmp
+    memcpy(s->hole, s->tmp_lo, (s->tmp_hi - s->tmp_lo) * sizeof(mp_obj_t));
+    s->tmp_lo = s->tmp_hi;
+}
+
+STATIC void list_sort_run(list_sort_t *s, size_t n, size_t *runs) {
+    // split into runs of at least SORT_MIN_RUN elements
+    size_t n_runs = 0;
+    for (size_t lo = 0; lo < n;) {
+        size_t len = list_sort_count_run(s, lo, n);
+        if (len < SORT_MIN_RUN) {
+            size_t hi = MIN(lo + SORT_MIN_RUN, n);
+            list_sort_insertion(s, lo, lo + len, hi);
+            len = hi - lo;
+        }
+        if (runs != NULL) {
+            runs[n_runs++] = lo;
+        }
+        lo += len;
+    }
+
+    // merge adjacent pairs of runs until one is left
+    while (n_runs > 1) {
+        size_t j = 0;
+        for (size_t i = 0; i < n_runs; i += 2) {
+            if (i + 1 < n_runs) {
+                list_sort_merge(s, runs[i], runs[i + 1], i + 2 < n_runs ? runs[i + 2] : n);
+            }
+            runs[j++] = runs[i];
+        }
+        n_runs = j;
+    }
+}
+
+STATIC void list_sort(mp_obj_t *base, size_t n, size_t stride, bool reverse) {
+    list_sort_t s;
+    s.base = base;
+    s.tmp = NULL;
+    s.stride = stride;
+    s.reverse = reverse;
+    s.hole = NULL;
+    s.tmp_lo = NULL;
+    s.tmp_hi = NULL;
+
+    // use a direct comparison if all keys are small ints, or all are str
+    s.kind = SORT_KIND_OBJ;
+    if (MP_OBJ_IS_SMALL_INT(base[0])) {
+        s.kind = SORT_KIND_SMALL_INT;
+    } else if (MP_OBJ_IS_STR(base[0])) {
+        s.kind = SORT_KIND_STR;
+    }
+    for (size_t i = 1; i < n && s.kind != SORT_KIND_OBJ; ++i) {
+        mp_obj_t k = base[i * stride];
+        if ((s.kind == SORT_KIND_SMALL_INT && !MP_OBJ_IS_SMALL_INT(k))
+            || (s.kind == SORT_KIND_STR && !MP_OBJ_IS_STR(k))) {
+            s.kind = SORT_KIND_OBJ;
+        }
+    }
+
+    size_t *runs = NULL;
+    size_t runs_alloc = 0;
+    size_t tmp_alloc = 0;
+    if (n > SORT_MIN_RUN) {
+        runs_alloc = n / SORT_MIN_RUN + 1;
+        runs = m_new(size_t, runs_alloc);
+        tmp_alloc = (n / 2) * stride;
+        s.tmp = m_new(mp_obj_t, tmp_alloc);
+    }
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        list_sort_run(&s, n, runs);
+        nlr_pop();
+    } else {
+        // a comparison raised; put back any elements that are in tmp
+        if (s.tmp_lo < s.tmp_hi) {
+            memcpy(s.hole, s.tmp_lo, (s.tmp_hi - s.tmp_lo) * sizeof(mp_obj_t));
+        }
+        m_del(size_t, runs, runs_alloc);
+        m_del(mp_obj_t, s.tmp, tmp_alloc);
+        nlr_jump(nlr.ret_val);
+    }
+
+    m_del(size_t, runs, runs_alloc);
+    m_del(mp_obj_t, s.tmp, tmp_alloc);
+}
+
 mp_obj_t mp_obj_list_sort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_key, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
@@ -327,9 +539,29 @@ mp_obj_t mp_obj_list_sort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_
     mp_obj_list_t *self = MP_OBJ_TO_PTR(pos_args[0]);
 
     if (self->len > 1) {
-        mp_quicksort(self->items, self->items + self->len - 1,
-                     args.key.u_obj == mp_const_none ? MP_OBJ_NULL : args.key.u_obj,
-                     args.reverse.u_bool ? mp_const_false : mp_const_true);
+        if (args.key.u_obj == mp_const_none) {
+            list_sort(self->items, self->len, 1, args.reverse.u_bool);
+        } else {
+            // call the key function once per element and sort (key, item) pairs
+            size_t n = self->len;
+            mp_obj_t *pairs = m_new(mp_obj_t, 2 * n);
+            for (size_t i = 0; i < n; ++i) {
+                pairs[2 * i] = mp_call_function_1(args.key.u_obj, self->items[i]);
+                pairs[2 * i + 1] = self->items[i];
+            }
+            nlr_buf_t nlr;
+            if (nlr_push(&nlr) == 0) {
+                list_sort(pairs, n, 2, args.reverse.u_bool);
+                nlr_pop();
+            } else {
+                m_del(mp_obj_t, pairs, 2 * n);
+                nlr_jump(nlr.ret_val);
+            }
+            for (size_t i = 0; i < n; ++i) {
+                self->items[i] = pairs[2 * i + 1];
+            }
+            m_del(mp_obj_t, pairs, 2 * n);
+        }
     }
 
     return mp_const_none;
@@ -88,12 +88,18 @@ void mp_str_print_json(const mp_print_t *print, const byte *str_data, size_t str
     // for JSON spec, see http://www.ietf.org/rfc/rfc4627.txt
     // if we are given a valid utf8-encoded string, we will print it in a JSON-conforming way
     mp_print_str(print, "\"");
+    const byte *run = str_data;
     for (const byte *s = str_data, *top = str_data + str_len; s < top; s++) {
+        if (*s >= 32 && *s != '"' && *s != '\\') {
+            // normal and utf-8 encoded chars are output in runs
+            continue;
+        }
+        if (s > run) {
+            print->print_strn(print->data, (const char*)run, s - run);
+        }
+        run = s + 1;
         if (*s == '"' || *s == '\\') {
             mp_printf(print, "\\%c", *s);
-        } else if (*s >= 32) {
-            // this will handle normal and utf-8 encoded chars
-            mp_printf(print, "%c", *s);
         } else if (*s == '\n') {
             mp_print_str(print, "\\n");
         } else if (*s == '\r') {
@@ -105,6 +111,9 @@ void mp_str_print_json(const mp_print_t *print, const byte *str_data, size_t str
             mp_printf(print, "\\u%04x", *s);
         }
     }
+    if (str_data + str_len > run) {
+        print->print_strn(print->data, (const char*)run, str_data + str_len - run);
+    }
     mp_print_str(print, "\"");
 }
 #endif
@@ -207,6 +216,11 @@ STATIC mp_obj_t bytes_make_new(const mp_obj_type_t *type_in, size_t n_args, size
         goto wrong_args;
     }
 
+    if (MP_OBJ_IS_TYPE(args[0], &mp_type_bytes)) {
+        // immutable, so no need to copy
+        return args[0];
+    }
+
     if (MP_OBJ_IS_SMALL_INT(args[0])) {
         uint len = MP_OBJ_SMALL_INT_VALUE(args[0]);
         vstr_t vstr;
@@ -249,28 +263,54 @@ wrong_args:
     mp_raise_TypeError("wrong number of arguments");
 }
 
+// Search using the Boyer-Moore-Horspool algorithm.  Skip distances are stored
+// in bytes to bound the stack usage; a shorter skip than possible is always safe.
+STATIC const byte *find_subbytes_horspool(const byte *haystack, size_t hlen, const byte *needle, size_t nlen) {
+    byte skip[256];
+    memset(skip, nlen < 255 ? nlen : 255, sizeof(skip));
+    for (size_t i = nlen > 256 ? nlen - 256 : 0; i < nlen - 1; ++i) {
+        skip[needle[i]] = nlen - 1 - i;
+    }
+    byte last = needle[nlen - 1];
+    for (const byte *p = haystack, *top = haystack + hlen - nlen; p <= top;) {
+        byte c = p[nlen - 1];
+        if (c == last && memcmp(p, needle, nlen - 1) == 0) {
+            return p;
+        }
+        p += skip[c];
+    }
+    return NULL;
+}
+
 // like strstr but with specified length and allows \0 bytes
-// TODO replace with something more efficient/standard
 const byte *find_subbytes(const byte *haystack, mp_uint_t hlen, const byte *needle, mp_uint_t nlen, mp_int_t direction) {
-    if (hlen >= nlen) {
-        mp_uint_t str_index, str_index_end;
-        if (direction > 0) {
-            str_index = 0;
-            str_index_end = hlen - nlen;
-        } else {
-            str_index = hlen - nlen;
-            str_index_end = 0;
+    if (hlen < nlen) {
+        return NULL;
+    }
+    if (nlen == 0) {
+        return direction > 0 ? haystack : haystack + hlen;
+    }
+    const byte *top = haystack + hlen - nlen; // last possible match position
+    byte first = needle[0];
+    if (direction > 0) {
+        if (nlen >= 4 && hlen - nlen >= 64) {
+            return find_subbytes_horspool(haystack, hlen, needle, nlen);
         }
-        for (;;) {
-            if (memcmp(&haystack[str_index], needle, nlen) == 0) {
-                //found
-                return haystack + str_index;
-            }
-            if (str_index == str_index_end) {
-                //not found
+        // let memchr (which is normally word-at-a-time) find candidates
+        for (const byte *p = haystack; p <= top; ++p) {
+            p = memchr(p, first, top - p + 1);
+            if (p == NULL) {
                 break;
             }
-            str_index += direction;
+            if (memcmp(p + 1, needle + 1, nlen - 1) == 0) {
+                return p;
+            }
+        }
+    } else {
+        for (size_t i = top - haystack + 1; i-- > 0;) {
+            if (haystack[i] == first && memcmp(haystack + i + 1, needle + 1, nlen - 1) == 0) {
+                return haystack + i;
+            }
         }
     }
     return NULL;
@@ -279,6 +319,84 @@ const byte *find_subbytes(const byte *haystack, mp_uint_t hlen, const byte *need
 // Note: this function is used to check if an object is a str or bytes, which
 // works because both those types use it as their binary_op method.  Revisit
 // MP_OBJ_IS_STR_OR_BYTES if this fact changes.
+#if MICROPY_PY_BUILTINS_STR_LAZY_CONCAT
+
+// results shorter than this are concatenated eagerly
+#define STR_LAZY_CONCAT_MIN_LEN (64)
+
+// estimated memory held by each piece of a chain: its lazy object and rhs
+#define STR_LAZY_CONCAT_PIECE_SIZE (sizeof(mp_obj_str_lazy_t) + sizeof(mp_obj_str_t))
+
+STATIC mp_obj_t str_lazy_concat(const mp_obj_type_t *type, mp_obj_t lhs_in, mp_obj_t rhs_in) {
+    GET_STR_LEN(lhs_in, lhs_len);
+    GET_STR_LEN(rhs_in, rhs_len);
+    if (rhs_len == 0) {
+        return lhs_in;
+    }
+    if (lhs_len == 0) {
+        return rhs_in;
+    }
+    if (lhs_len + rhs_len < STR_LAZY_CONCAT_MIN_LEN) {
+        return MP_OBJ_NULL;
+    }
+    // make sure rhs is flat, so that flattening never needs to recurse
+    GET_STR_DATA_LEN(rhs_in, rhs_data, rhs_len2);
+    (void)rhs_data;
+    (void)rhs_len2;
+    // Flatten lhs once the pieces would take more memory than the data, as
+    // for many short additions.  The chain then starts again from a longer
+    // string, so the copying stays linear in the final length.
+    mp_uint_t depth = 1;
+    if (!MP_OBJ_IS_QSTR(lhs_in) && MP_OBJ_STR_IS_LAZY((mp_obj_str_t*)MP_OBJ_TO_PTR(lhs_in))) {
+        depth += ((mp_obj_str_lazy_t*)MP_OBJ_TO_PTR(lhs_in))->depth;
+        if (depth * STR_LAZY_CONCAT_PIECE_SIZE > lhs_len + rhs_len) {
+            mp_obj_str_flatten(MP_OBJ_TO_PTR(lhs_in));
+            depth = 1;
+        }
+    }
+    mp_obj_str_lazy_t *o = m_new_obj(mp_obj_str_lazy_t);
+    o->base.base.type = type;
+    o->base.hash = 0;
+    o->base.len = lhs_len + rhs_len;
+    o->base.data = NULL;
+    o->lhs = lhs_in;
+    o->rhs = rhs_in;
+    o->depth = depth;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+// Copy all the pieces of a lazy str/bytes into a single buffer.  The chain of
+// lhs pointers is walked iteratively, filling the buffer from the end.
+const byte *mp_obj_str_flatten(mp_obj_str_t *self) {
+    size_t len = self->len;
+    byte *buf = m_new(byte, len + 1);
+    byte *top = buf + len;
+    *top = '\0';
+    mp_obj_str_lazy_t *node = (mp_obj_str_lazy_t*)self;
+    for (;;) {
+        GET_STR_DATA_LEN(node->rhs, rhs_data, rhs_len);
+        top -= rhs_len;
+        memcpy(top, rhs_data, rhs_len);
+        mp_obj_t lhs = node->lhs;
+        if (!MP_OBJ_IS_QSTR(lhs) && MP_OBJ_STR_IS_LAZY((mp_obj_str_t*)MP_OBJ_TO_PTR(lhs))) {
+            node = MP_OBJ_TO_PTR(lhs);
+        } else {
+            GET_STR_DATA_LEN(lhs, lhs_data, lhs_len);
+            assert(buf + lhs_len == top);
+            memcpy(buf, lhs_data, lhs_len);
+            break;
+        }
+    }
+    self->hash = qstr_compute_hash(buf, len);
+    self->data = buf;
+    // release the pieces so they can be reclaimed
+    ((mp_obj_str_lazy_t*)self)->lhs = MP_OBJ_NULL;
+    ((mp_obj_str_lazy_t*)self)->rhs = MP_OBJ_NULL;
+    return buf;
+}
+
+#endif
+
 mp_obj_t mp_obj_str_binary_op(mp_uint_t op, mp_obj_t lhs_in, mp_obj_t rhs_in) {
     // check for modulo
     if (op == MP_BINARY_OP_MODULO) {
@@ -301,6 +419,20 @@ mp_obj_t mp_obj_str_binary_op(mp_uint_t op, mp_obj_t lhs_in, mp_obj_t rhs_in) {
 
     // from now on we need lhs type and data, so extract them
     mp_obj_type_t *lhs_type = mp_obj_get_type(lhs_in);
+
+    #if MICROPY_PY_BUILTINS_STR_LAZY_CONCAT
+    // concatenating to a long str/bytes defers the copy, so the lhs data must
+    // not be extracted (which would flatten it)
+    if ((op == MP_BINARY_OP_ADD || op == MP_BINARY_OP_INPLACE_ADD)
+        && (lhs_type == &mp_type_str || lhs_type == &mp_type_bytes)
+        && lhs_type == mp_obj_get_type(rhs_in)) {
+        mp_obj_t res = str_lazy_concat(lhs_type, lhs_in, rhs_in);
+        if (res != MP_OBJ_NULL) {
+            return res;
+        }
+    }
+    #endif
+
     GET_STR_DATA_LEN(lhs_in, lhs_data, lhs_len);
 
     // check for multiply
@@ -402,6 +534,10 @@ STATIC mp_obj_t bytes_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
             if (!mp_seq_get_fast_slice_indexes(self_len, index, &slice)) {
                 mp_not_implemented("only slices with step=1 (aka None) are supported");
             }
+            if (slice.start == 0 && slice.stop == self_len) {
+                // immutable, so a full slice can be the object itself
+                return self_in;
+            }
             return mp_obj_new_str_of_type(type, self_data + slice.start, slice.stop - slice.start);
         }
 #endif
@@ -522,14 +658,12 @@ mp_obj_t mp_obj_str_split(size_t n_args, const mp_obj_t *args) {
 
         for (;;) {
             const byte *start = s;
-            for (;;) {
-                if (splits == 0 || s + sep_len > top) {
-                    s = top;
-                    break;
-                } else if (memcmp(s, sep_str, sep_len) == 0) {
-                    break;
-                }
-                s++;
+            s = NULL;
+            if (splits != 0) {
+                s = find_subbytes(start, top - start, (const byte*)sep_str, sep_len, 1);
+            }
+            if (s == NULL) {
+                s = top;
             }
             mp_obj_list_append(res, mp_obj_new_str_of_type(self_type, start, s - start));
             if (s >= top) {
@@ -621,16 +755,11 @@ STATIC mp_obj_t str_rsplit(size_t n_args, const mp_obj_t *args) {
         const byte *beg = s;
         const byte *last = s + len;
         for (;;) {
-            s = last - sep_len;
-            for (;;) {
-                if (splits == 0 || s < beg) {
-                    break;
-                } else if (memcmp(s, sep_str, sep_len) == 0) {
-                    break;
-                }
-                s--;
+            s = NULL;
+            if (splits != 0) {
+                s = find_subbytes(beg, last - beg, (const byte*)sep_str, sep_len, -1);
             }
-            if (s < beg || splits == 0) {
+            if (s == NULL) {
                 res->items[idx] = mp_obj_new_str_of_type(self_type, beg, last - beg);
                 break;
             }
@@ -893,7 +1022,7 @@ STATIC NORETURN void terse_str_format_value_error(void) {
 STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *arg_i, mp_uint_t n_args, const mp_obj_t *args, mp_map_t *kwargs) {
     vstr_t vstr;
     mp_print_t print;
-    vstr_init_print(&vstr, 16, &print);
+    vstr_init_print(&vstr, top - str + 16, &print);
 
     for (; str < top; str++) {
         if (*str == '}') {
@@ -909,7 +1038,12 @@ STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *ar
             }
         }
         if (*str != '{') {
-            vstr_add_byte(&vstr, *str);
+            // copy a run of literal characters in one go
+            const char *run = str;
+            while (str + 1 < top && str[1] != '{' && str[1] != '}') {
+                ++str;
+            }
+            vstr_add_strn(&vstr, run, str + 1 - run);
             continue;
         }
 
@@ -1052,6 +1186,11 @@ STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *ar
                 assert(conversion == 'r');
                 print_kind = PRINT_REPR;
             }
+            if (format_spec == NULL) {
+                // nothing else to apply, so print straight to the output
+                mp_obj_print_helper(&print, arg, print_kind);
+                continue;
+            }
             vstr_t arg_vstr;
             mp_print_t arg_print;
             vstr_init_print(&arg_vstr, 16, &arg_print);
@@ -1078,9 +1217,19 @@ STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *ar
             // precision   ::=  integer
             // type        ::=  "b" | "c" | "d" | "e" | "E" | "f" | "F" | "g" | "G" | "n" | "o" | "s" | "x" | "X" | "%"
 
-            // recursively call the formatter to format any nested specifiers
-            MP_STACK_CHECK();
-            vstr_t format_spec_vstr = mp_obj_str_format_helper(format_spec, str, arg_i, n_args, args, kwargs);
+            // a short specifier without nested fields is used as-is from a stack
+            // buffer, otherwise recursively call the formatter to format any
+            // nested specifiers
+            vstr_t format_spec_vstr;
+            char format_spec_buf[16];
+            size_t format_spec_len = str - format_spec;
+            if (format_spec_len < sizeof(format_spec_buf) && memchr(format_spec, '{', format_spec_len) == NULL) {
+                vstr_init_fixed_buf(&format_spec_vstr, sizeof(format_spec_buf), format_spec_buf);
+                vstr_add_strn(&format_spec_vstr, format_spec, format_spec_len);
+            } else {
+                MP_STACK_CHECK();
+                format_spec_vstr = mp_obj_str_format_helper(format_spec, str, arg_i, n_args, args, kwargs);
+            }
             const char *s = vstr_null_terminated_str(&format_spec_vstr);
             const char *stop = s + format_spec_vstr.len;
             if (isalignment(*s)) {
@@ -1351,12 +1500,17 @@ STATIC mp_obj_t str_modulo_format(mp_obj_t pattern, mp_uint_t n_args, const mp_o
     int arg_i = 0;
     vstr_t vstr;
     mp_print_t print;
-    vstr_init_print(&vstr, 16, &print);
+    vstr_init_print(&vstr, len + 16, &print);
 
     for (const byte *top = str + len; str < top; str++) {
         mp_obj_t arg = MP_OBJ_NULL;
         if (*str != '%') {
-            vstr_add_byte(&vstr, *str);
+            // copy a run of literal characters in one go
+            const byte *run = str;
+            while (str + 1 < top && str[1] != '%') {
+                ++str;
+            }
+            vstr_add_strn(&vstr, (const char*)run, str + 1 - run);
             continue;
         }
         if (++str >= top) {
@@ -1489,15 +1643,20 @@ not_enough_args:
             case 'r':
             case 's':
             {
-                vstr_t arg_vstr;
-                mp_print_t arg_print;
-                vstr_init_print(&arg_vstr, 16, &arg_print);
                 mp_print_kind_t print_kind = (*str == 'r' ? PRINT_REPR : PRINT_STR);
                 if (print_kind == PRINT_STR && is_bytes && MP_OBJ_IS_TYPE(arg, &mp_type_bytes)) {
                     // If we have something like b"%s" % b"1", bytes arg should be
                     // printed undecorated.
                     print_kind = PRINT_RAW;
                 }
+                if (prec < 0 && width == 0) {
+                    // no truncation or padding, so print straight to the output
+                    mp_obj_print_helper(&print, arg, print_kind);
+                    break;
+                }
+                vstr_t arg_vstr;
+                mp_print_t arg_print;
+                vstr_init_print(&arg_vstr, 16, &arg_print);
                 mp_obj_print_helper(&arg_print, arg, print_kind);
                 uint vlen = arg_vstr.len;
                 if (prec < 0) {
@@ -1669,13 +1828,13 @@ STATIC mp_obj_t str_count(size_t n_args, const mp_obj_t *args) {
 
     // count the occurrences
     mp_int_t num_occurrences = 0;
-    for (const byte *haystack_ptr = start; haystack_ptr + needle_len <= end;) {
-        if (memcmp(haystack_ptr, needle, needle_len) == 0) {
-            num_occurrences++;
-            haystack_ptr += needle_len;
-        } else {
-            haystack_ptr = utf8_next_char(haystack_ptr);
+    for (const byte *haystack_ptr = start; haystack_ptr < end;) {
+        haystack_ptr = find_subbytes(haystack_ptr, end - haystack_ptr, needle, needle_len, 1);
+        if (haystack_ptr == NULL) {
+            break;
         }
+        num_occurrences++;
+        haystack_ptr += needle_len;
     }
 
     return MP_OBJ_NEW_SMALL_INT(num_occurrences);
@@ -2074,7 +2233,7 @@ qstr mp_obj_str_get_qstr(mp_obj_t self_in) {
         return MP_OBJ_QSTR_VALUE(self_in);
     } else if (MP_OBJ_IS_TYPE(self_in, &mp_type_str)) {
         mp_obj_str_t *self = MP_OBJ_TO_PTR(self_in);
-        return qstr_from_strn((char*)self->data, self->len);
+        return qstr_from_strn((const char*)MP_OBJ_STR_DATA(self), self->len);
     } else {
         bad_implicit_conversion(self_in);
     }
@@ -2108,7 +2267,7 @@ const byte *mp_obj_str_get_data_no_check(mp_obj_t self_in, size_t *len) {
         return qstr_data(MP_OBJ_QSTR_VALUE(self_in), len);
     } else {
         *len = ((mp_obj_str_t*)self_in)->len;
-        return ((mp_obj_str_t*)self_in)->data;
+        return MP_OBJ_STR_DATA((mp_obj_str_t*)self_in);
     }
 }
 #endif
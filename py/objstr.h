@@ -38,6 +38,23 @@ typedef struct _mp_obj_str_t {
 
 #define MP_DEFINE_STR_OBJ(obj_name, str) mp_obj_str_t obj_name = {{&mp_type_str}, 0, sizeof(str) - 1, (const byte*)str}
 
+#if MICROPY_PY_BUILTINS_STR_LAZY_CONCAT
+// A lazily concatenated str/bytes has data==NULL (and len!=0) until its data
+// is first needed, at which point it is flattened into a single buffer.
+typedef struct _mp_obj_str_lazy_t {
+    mp_obj_str_t base;
+    mp_obj_t lhs; // may itself be lazy
+    mp_obj_t rhs; // always flat
+    mp_uint_t depth; // number of lazy objects in the chain, this one included
+} mp_obj_str_lazy_t;
+
+const byte *mp_obj_str_flatten(mp_obj_str_t *self);
+#define MP_OBJ_STR_IS_LAZY(o) ((o)->data == NULL && (o)->len != 0)
+#define MP_OBJ_STR_DATA(o) (MP_OBJ_STR_IS_LAZY(o) ? mp_obj_str_flatten(o) : (o)->data)
+#else
+#define MP_OBJ_STR_DATA(o) ((o)->data)
+#endif
+
 // use this macro to extract the string hash
 // warning: the hash can be 0, meaning invalid, and must then be explicitly computed from the data
 #define GET_STR_HASH(str_obj_in, str_hash) \
@@ -58,7 +75,7 @@ const byte *mp_obj_str_get_data_no_check(mp_obj_t self_in, size_t *len);
 #define GET_STR_DATA_LEN(str_obj_in, str_data, str_len) \
     const byte *str_data; size_t str_len; if (MP_OBJ_IS_QSTR(str_obj_in)) \
     { str_data = qstr_data(MP_OBJ_QSTR_VALUE(str_obj_in), &str_len); } \
-    else { str_len = ((mp_obj_str_t*)MP_OBJ_TO_PTR(str_obj_in))->len; str_data = ((mp_obj_str_t*)MP_OBJ_TO_PTR(str_obj_in))->data; }
+    else { str_len = ((mp_obj_str_t*)MP_OBJ_TO_PTR(str_obj_in))->len; str_data = MP_OBJ_STR_DATA((mp_obj_str_t*)MP_OBJ_TO_PTR(str_obj_in)); }
 #endif
 
 mp_obj_t mp_obj_str_make_new(const mp_obj_type_t *type_in, size_t n_args, size_t n_kw, const mp_obj_t *args);
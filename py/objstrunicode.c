@@ -207,6 +207,10 @@ STATIC mp_obj_t str_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
             if (pstop < pstart) {
                 return MP_OBJ_NEW_QSTR(MP_QSTR_);
             }
+            if (pstart == self_data && pstop == self_data + self_len) {
+                // immutable, so a full slice can be the object itself
+                return self_in;
+            }
             return mp_obj_new_str_of_type(type, (const byte *)pstart, pstop - pstart);
         }
 #endif
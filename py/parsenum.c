@@ -84,10 +84,10 @@ mp_obj_t mp_parse_num_integer(const char *restrict str_, size_t len, int base, m
         if (unichar_isdigit(dig) && (int)dig - '0' < base) {
             // 0-9 digit
             dig = dig - '0';
-        } else if (base == 16) {
+        } else if (base > 10) {
             dig |= 0x20;
-            if ('a' <= dig && dig <= 'f') {
-                // a-f hex digit
+            if ('a' <= dig && dig <= 'z' && (int)dig - 'a' + 10 < base) {
+                // a-z digit, eg a-f for hex
                 dig = dig - 'a' + 10;
             } else {
                 // unknown character
@@ -0,0 +1,94 @@
+# test element-wise array operations (MicroPython extension)
+
+try:
+    import array
+    array.add
+except (ImportError, AttributeError):
+    print("SKIP")
+    import sys
+    sys.exit()
+
+from array import array as arr
+
+# element-wise ops returning a new array
+a = arr('h', [1, -2, 300, -4000])
+b = arr('h', [10, 20, 30, 40])
+print(array.add(a, b))
+print(array.sub(a, b))
+print(array.mul(a, b))
+print(array.scale(a, 3))
+print(array.clip(a, -100, 100))
+
+# results wrap around like stores to an array element
+print(array.add(arr('B', [250, 5]), arr('B', [10, 10])))
+print(array.mul(arr('b', [100, -100]), arr('b', [2, 2])))
+print(array.add(arr('i', [2**31 - 1]), arr('i', [1])))
+print(array.sub(arr('Q', [0]), arr('Q', [1])))
+
+# clip bounds beyond the range of the element type saturate
+print(array.clip(bytearray([0, 10, 100, 200, 255]), 5, 300))
+print(array.clip(arr('h', [1, -30000, 30000]), -40000, 40000))
+print(array.clip(arr('B', [1, 200]), -5, -1))
+print(array.clip(arr('Q', [1, 2**64 - 1]), 2**63, 2**80))
+print(array.clip(arr('q', [1, -2**63]), -2**80, -5))
+
+# writing to an output array, including in place
+out = arr('h', [0] * 4)
+print(array.add(a, b, out) is out, out)
+print(array.scale(a, 2, a) is a, a)
+
+# bytearray and memoryview
+ba = bytearray(b'\x01\x02\x03\xff')
+print(array.add(ba, b'\x01\x01\x01\x01'))
+print(array.clip(ba, 2, 3, ba), ba)
+m = memoryview(arr('i', [5, 6, 7, 8]))[1:3]
+print(list(array.scale(m, -1, m)), array.sum(m))
+
+# reductions
+for tc in 'bBhHiIlLqQ':
+    x = arr(tc, [1, 2, 3, 100])
+    print(tc, array.sum(x), array.min(x), array.max(x), array.dot(x, x))
+x = arr('b', [-128, 0, 127, -1])
+print(array.sum(x), array.min(x), array.max(x), array.dot(x, x))
+x = arr('Q', [2**64 - 1, 5])
+print(array.min(x), array.max(x))
+x = arr('q', [2**62, 2**62, -5])
+print(array.sum(x))
+print(array.sum(bytearray(1000 * b'\xff')))
+print(array.sum(arr('i')))
+
+# floats
+try:
+    array.mean
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+f = arr('f', [1.5, -2.5, 4.0, 0.25])
+print(array.add(f, f))
+print(array.scale(f, 0.5))
+print(array.clip(f, -1, 1))
+
+# integers scaled by a float are rounded and saturated
+print(array.scale(arr('h', [1, -3, 1000, -1000]), 2.5))
+print(array.scale(arr('B', [1, 3, 200]), -0.5), array.scale(arr('B', [1, 3, 200]), 1.5))
+print(array.scale(bytearray([10, 20]), 0.3))
+print(array.sum(f), array.min(f), array.max(f), array.mean(f))
+d = arr('d', [1.0, 2.0, 3.0])
+print(array.dot(d, d), array.mean(d))
+print(array.mean(arr('H', [1, 2])))
+
+# errors
+for f, args in (
+    (array.add, (arr('h', [1]), arr('i', [1]))),
+    (array.add, (arr('h', [1]), arr('h', [1, 2]))),
+    (array.add, (arr('h', [1]), arr('h', [1]), b'\0\0')),
+    (array.sum, ([1, 2],)),
+    (array.sum, (1,)),
+    (array.min, (arr('i'),)),
+    (array.mean, (bytearray(),)),
+    ):
+    try:
+        f(*args)
+    except (TypeError, ValueError) as er:
+        print(type(er).__name__)
@@ -0,0 +1,16 @@
+# test builtin pow() with 3 integral arguments
+
+print(pow(3, 4, 7))
+print(pow(2, 10, 1000))
+print(pow(7, 1, 7))
+print(pow(0, 5, 7), pow(0, 0, 7))
+print(pow(3, 0, 1), pow(3, 0, 7), pow(5, 3, 1))
+
+# sign of the result follows the modulus
+print(pow(-2, 3, 5), pow(-2, 2, 5))
+print(pow(2, 3, -5), pow(-2, 3, -5), pow(3, 0, -7), pow(5, 3, -1))
+
+try:
+    pow(2, 3, 0)
+except (ValueError, ZeroDivisionError):
+    print("error")
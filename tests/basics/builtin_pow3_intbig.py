@@ -0,0 +1,15 @@
+# test builtin pow() with 3 integral arguments, some of them big
+
+# odd and even moduli take different paths internally
+for m in (2 ** 64 - 59, 2 ** 64, 10 ** 40 + 1, 10 ** 40, 3 ** 80, 2 ** 127 - 1):
+    print(pow(3, 10 ** 20, m), pow(12345678901234567890, 65537, m), pow(2 ** 200, 3, m))
+    print(pow(-(7 ** 50), 2 ** 70 + 1, m), pow(7 ** 50, 2 ** 70 + 1, -m), pow(-(7 ** 50), 2 ** 70, -m))
+
+# 1024-bit modulus
+m = 2 ** 1024 - 1093337
+print(pow(3, m - 1, m))
+print(pow(2 ** 1000 + 17, 2 ** 1023 + 12345, m))
+print(pow(2 ** 1000 + 17, 2 ** 1023 + 12345, m + 1))
+
+# small modulus with big arguments
+print(pow(10 ** 50, 10 ** 30, 97), pow(10 ** 50, 10 ** 30, 1))
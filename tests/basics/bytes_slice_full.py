@@ -0,0 +1,8 @@
+# full slices and copies of immutable objects don't need to copy the data
+
+b = b"0123456789" * 10
+print(b[:] is b, b[0:] is b, b[:len(b)] is b, b[1:] is b)
+print(bytes(b) is b, bytes(b) == b)
+
+s = "0123456789" * 10
+print(s[:] is s, s[0:] is s, s[1:] == s)
@@ -0,0 +1,20 @@
+# test multiplication of big ints large enough to use Karatsuba's method
+
+def check(a, b):
+    p = a * b
+    # verify using (a + b)^2 - (a - b)^2 = 4ab, which uses squaring
+    print(p % 1000000007, len(hex(p)), (a + b) * (a + b) - (a - b) * (a - b) == 4 * p)
+
+for n in (300, 1000, 1024, 2000, 5000, 12000):
+    a = 3 ** n
+    b = 7 ** (n // 2) + 1
+    check(a, a)
+    check(a, b)
+    check(b, a)
+    check(-a, b)
+    check(a, -a)
+    check(a, 7 ** n - 1)
+    c = (1 << n) - 1
+    check(c, c)
+    check(c, (1 << (n // 3)) - 1)
+    check(c + 2, (1 << n) + 1)
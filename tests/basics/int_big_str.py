@@ -0,0 +1,22 @@
+# test conversion of big ints to and from strings
+
+# sizes either side of the point where conversion switches algorithm
+for e in (100, 500, 1000, 2000, 4000):
+    for v in (10 ** e, 10 ** e - 1, 7 ** e, -(3 ** e), 2 ** (e * 3) + 1):
+        s = str(v)
+        print(len(s), s[:30], s[len(s) // 2:len(s) // 2 + 30], s[-30:])
+        print(int(s) == v, int(s + ' ') == v)
+        for base, fmt in ((2, '{:b}'), (8, '{:o}'), (16, '{:x}'), (16, '{:X}')):
+            s = fmt.format(v)
+            print(len(s), s[:12], s[-12:], int(s, base) == v)
+
+# other bases only parse
+for base in (3, 7, 12, 32, 36):
+    s = '1' + '0' * 800
+    v = int(s, base)
+    print(base, v == base ** 800, int(s + '1', base) == v * base + 1)
+print(int('zZ' * 300, 36) % 1000000007)
+
+# thousands separator
+for v in (123456, 123456789, 12345678901234567890, 123456789012345678901234567890, -123456789012345678901234567890, 10 ** 200):
+    print('{:,}'.format(v))
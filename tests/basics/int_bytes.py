@@ -5,3 +5,36 @@ print((2**64).to_bytes(9, "little"))
 print(int.from_bytes(b"\x00\x01\0\0\0\0\0\0", "little"))
 print(int.from_bytes(b"\x01\0\0\0\0\0\0\0", "little"))
 print(int.from_bytes(b"\x00\x01\0\0\0\0\0\0", "little"))
+
+# big endian
+print((10).to_bytes(1, "big"))
+print((111111).to_bytes(4, "big"))
+print((100).to_bytes(10, "big"))
+print(int.from_bytes(b"\x00\x01\0\0\0\0\0\0", "big"))
+print(int.from_bytes(b"\x01\0\0\0\0\0\0\0", "big"))
+
+# signed
+print((-1).to_bytes(1, "little", signed=True))
+print((-128).to_bytes(2, "big", signed=True))
+print((-300).to_bytes(10, "little", signed=True))
+print((127).to_bytes(1, "big", signed=True))
+print((0).to_bytes(0, "big"))
+print(int.from_bytes(b"\xff", "big", signed=True))
+print(int.from_bytes(b"\x80\x00", "big", signed=True))
+print(int.from_bytes(b"\x00\x80", "big", signed=True))
+print(int.from_bytes(b"\xff\xff\xff\x7f", "little", signed=True))
+print(int.from_bytes(b"", "big", signed=True))
+print(int.from_bytes(bytearray(b"\x12\x34"), "big"))
+
+# overflow
+for args in ((256, 1, False), (128, 1, True), (-129, 1, True), (1, 0, False), (-1, 4, False)):
+    try:
+        args[0].to_bytes(args[1], "big", signed=args[2])
+    except OverflowError:
+        print("OverflowError")
+
+# invalid byteorder
+try:
+    (1).to_bytes(1, "middle")
+except ValueError:
+    print("ValueError")
@@ -0,0 +1,35 @@
+print((2**64).to_bytes(9, "big"))
+print((2**64).to_bytes(16, "little"))
+print((-2**64).to_bytes(9, "big", signed=True))
+print((-2**64).to_bytes(12, "little", signed=True))
+print((2**100 - 1).to_bytes(13, "big"))
+print((-2**103).to_bytes(13, "big", signed=True))
+print((2**103 - 1).to_bytes(13, "big", signed=True))
+
+print(int.from_bytes(b"\x01" + b"\0" * 16, "big"))
+print(int.from_bytes(b"\x01" + b"\0" * 16, "little"))
+print(int.from_bytes(b"\xff" * 20, "big"))
+print(int.from_bytes(b"\xff" * 20, "big", signed=True))
+print(int.from_bytes(b"\x80" + b"\0" * 19, "big", signed=True))
+print(int.from_bytes(b"\0" * 19 + b"\x80", "little", signed=True))
+print(int.from_bytes(b"\0" * 12 + b"\x7f\xff", "big", signed=True))
+
+# round trip of a range of values, lengths and byte orders
+x = 1
+for i in range(64):
+    x = x * 0x1f3d5b79 + i
+    for v in (x, -x):
+        for order in ("little", "big"):
+            n = len(hex(v)) // 2 + 1
+            b = v.to_bytes(n, order, signed=True)
+            if int.from_bytes(b, order, signed=True) != v:
+                print("FAIL", v, order)
+            if v > 0 and int.from_bytes(v.to_bytes(n, order), order) != v:
+                print("FAIL", v, order)
+
+# overflow
+for args in ((2**64, 8, False), (2**63, 8, True), (-2**63 - 1, 8, True), (2**100, 12, False), (-2**100, 16, False)):
+    try:
+        args[0].to_bytes(args[1], "big", signed=args[2])
+    except OverflowError:
+        print("OverflowError")
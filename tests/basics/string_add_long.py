@@ -0,0 +1,32 @@
+# test concatenation of long str/bytes, including repeated in-place addition
+
+s = ""
+for i in range(200):
+    s += str(i) + ","
+print(len(s), s[:20], s[-20:])
+
+# intermediate values must be unaffected by later additions
+a = "x" * 60
+b = a + "y" * 10
+c = b + "z"
+print(a == "x" * 60, b == "x" * 60 + "y" * 10, c[-3:])
+
+# result used as dict key and in comparisons
+d = {c: 1}
+print(d["x" * 60 + "y" * 10 + "z"], hash(c) == hash("x" * 60 + "y" * 10 + "z"))
+print(c > b, c.startswith(b), c.find("yz"))
+
+# nested concatenations on both sides
+l = "a" * 40 + "b" * 40
+r = "c" * 40 + "d" * 40
+print(l + r == "a" * 40 + "b" * 40 + "c" * 40 + "d" * 40)
+
+# empty operands
+print(len("q" * 70 + ""), len("" + "q" * 70))
+
+# bytes
+b = b""
+for i in range(100):
+    b += bytes([i])
+print(len(b), b[:5], b[-5:], sum(b))
+print(b + b"!" * 64 == bytes(range(100)) + b"!" * 64)
@@ -0,0 +1,16 @@
+# test searching long strings, which uses a different algorithm for long needles
+
+s = "x" * 300 + "abcd" + "y" * 300 + "abcd"
+for n in ("abcd", "xabc", "dyyy", "y" * 299 + "abcd", "abce", "x" * 301):
+    print(s.find(n), s.rfind(n), s.count(n), len(s.split(n)), n in s)
+
+s = "hello world, " * 50 + "needle!" + "tail" * 40
+for n in ("needle!", "world, hello", "tailtail", "zzzz", "o"):
+    print(s.find(n), s.rfind(n), s.count(n), len(s.split(n)), len(s.rsplit(n, 3)))
+
+s = "a" * 100 + "b"
+print(s.find("aaaab"), s.find("aaaaaaaaab"), s.count("aa"), ("a" * 101) in s)
+
+b = bytes(range(256)) * 2
+print(b.find(bytes(range(10, 20))), b.rfind(bytes(range(10, 20))), b.count(b"\xfe\xff"))
+print(bytes(range(200, 210)) in bytearray(b))
@@ -0,0 +1,48 @@
+# test the Struct class, which compiles a format once
+try:
+    import ustruct as struct
+except:
+    import struct
+try:
+    struct.Struct
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+s = struct.Struct("<bI2h3sH")
+print(s.size, s.format)
+b = s.pack(-1, 0x12345678, 1, -2, b"ab", 0xffff)
+print(b)
+print(s.unpack(b))
+print(s.unpack_from(b"xx" + b, 2))
+print(s.unpack_from(b + b, -len(b)))
+
+# pack_into writes into a buffer in place
+buf = bytearray(2 + 2 * s.size)
+s.pack_into(buf, 2, 1, 2, 3, 4, b"xyzw", 5)
+s.pack_into(buf, -s.size, 6, 7, 8, 9, b"", 10)
+print(buf)
+
+# iter_unpack yields one tuple per record
+s = struct.Struct(">HB")
+for t in s.iter_unpack(b"\x01\x02\x03\x04\x05\x06"):
+    print(t)
+print(list(s.iter_unpack(b"")))
+
+# native format
+s = struct.Struct("i")
+print(s.unpack(s.pack(-12345)))
+
+# errors
+for f, args in (
+    (s.unpack, (b"\0",)),
+    (s.unpack_from, (b"\0\0\0\0", 1)),
+    (s.unpack_from, (b"\0\0\0\0", -5)),
+    (s.pack_into, (bytearray(3), 0, 1)),
+    (struct.Struct(">HB").iter_unpack, (b"\0",)),
+    ):
+    try:
+        f(*args)
+    except Exception as er:
+        print(type(er).__name__ in ("ValueError", "error"))
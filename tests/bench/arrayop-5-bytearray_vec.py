@@ -0,0 +1,13 @@
+# Array operation
+# Type: bytearray, inplace operation using the array module's element-wise
+# functions, which loop in C over the whole buffer.
+import bench
+import array
+
+def test(num):
+    ones = bytearray(b"\1" * 1000)
+    for i in iter(range(num//10000)):
+        arr = bytearray(b"\0" * 1000)
+        array.add(arr, ones, arr)
+
+bench.run(test)
@@ -0,0 +1,10 @@
+import bench
+
+def test(num):
+    a = 3 ** 6000
+    b = 7 ** 4000
+    for i in iter(range(num // 10000)):
+        a * b
+        a * a
+
+bench.run(test)
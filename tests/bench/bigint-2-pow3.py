@@ -0,0 +1,12 @@
+import bench
+
+def test(num):
+    # 1024-bit odd modulus, as in RSA verify / Diffie-Hellman
+    m = (1 << 1024) - 1093337
+    g = 3 ** 600
+    e = (1 << 1023) + 12345
+    for i in iter(range(num // 400000)):
+        pow(g, e, m)
+        pow(g, 65537, m)
+
+bench.run(test)
@@ -0,0 +1,10 @@
+import bench
+
+def test(num):
+    v = 7 ** 12000
+    for i in iter(range(num // 200000)):
+        s = str(v)
+        int(s)
+        int(hex(v), 16)
+
+bench.run(test)
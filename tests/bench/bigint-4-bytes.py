@@ -0,0 +1,12 @@
+import bench
+
+def test(num):
+    v = 7 ** 12000
+    n = len(hex(v)) // 2
+    for i in iter(range(num // 2000)):
+        b = v.to_bytes(n, "big")
+        int.from_bytes(b, "big")
+        b = (-v).to_bytes(n + 1, "little", signed=True)
+        int.from_bytes(b, "little", signed=True)
+
+bench.run(test)
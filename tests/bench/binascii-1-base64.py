@@ -0,0 +1,11 @@
+# Base64 encode and decode a kilobyte payload repeatedly, allocating the
+# result each time.
+import bench
+import ubinascii
+
+def test(num):
+    data = bytes(range(256)) * 4
+    for i in iter(range(num // 200)):
+        ubinascii.a2b_base64(ubinascii.b2a_base64(data)[:-1])
+
+bench.run(test)
@@ -0,0 +1,15 @@
+# Base64 encode and decode a kilobyte payload repeatedly, into preallocated
+# buffers.
+import bench
+import ubinascii
+
+def test(num):
+    data = bytes(range(256)) * 4
+    enc = bytearray(len(data) * 4 // 3 + 4)
+    dec = bytearray(len(data))
+    menc = memoryview(enc)
+    for i in iter(range(num // 200)):
+        n = ubinascii.b2a_base64_into(enc, data, newline=False)
+        ubinascii.a2b_base64_into(dec, menc[:n])
+
+bench.run(test)
@@ -0,0 +1,10 @@
+# Hex encode and decode a kilobyte payload repeatedly.
+import bench
+import ubinascii
+
+def test(num):
+    data = bytes(range(256)) * 4
+    for i in iter(range(num // 200)):
+        ubinascii.unhexlify(ubinascii.hexlify(data))
+
+bench.run(test)
@@ -0,0 +1,10 @@
+# CRC-32 of a few kilobytes of data, repeatedly.
+import bench
+import ubinascii
+
+def test(num):
+    data = bytes(range(256)) * 16
+    for i in iter(range(num // 200)):
+        ubinascii.crc32(data)
+
+bench.run(test)
@@ -0,0 +1,13 @@
+# CRC-16/CCITT-FALSE of a few kilobytes of data, repeatedly.
+import bench
+import ubinascii
+
+def test(num):
+    data = bytes(range(256)) * 16
+    crc = ubinascii.CRC(16, 0x1021, 0xffff)
+    for i in iter(range(num // 200)):
+        crc.reset()
+        crc.update(data)
+        crc.value()
+
+bench.run(test)
@@ -0,0 +1,10 @@
+# Hash a few kilobytes of data repeatedly.
+import bench
+import uhashlib
+
+def test(num):
+    data = bytes(range(256)) * 16
+    for i in iter(range(num // 2000)):
+        uhashlib.sha256(data).digest()
+
+bench.run(test)
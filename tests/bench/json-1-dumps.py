@@ -0,0 +1,10 @@
+# Serialise a list of records to a JSON string.
+import bench
+import ujson
+
+def test(num):
+    obj = [{"id": i, "name": "sensor %d" % i, "value": i * 3, "ok": True} for i in range(50)]
+    for i in iter(range(num // 5000)):
+        ujson.dumps(obj)
+
+bench.run(test)
@@ -0,0 +1,10 @@
+# Parse a JSON string holding a list of records.
+import bench
+import ujson
+
+def test(num):
+    s = ujson.dumps([{"id": i, "name": "sensor %d" % i, "value": i * 3, "ok": True} for i in range(50)])
+    for i in iter(range(num // 5000)):
+        ujson.loads(s)
+
+bench.run(test)
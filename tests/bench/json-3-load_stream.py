@@ -0,0 +1,11 @@
+# Parse a JSON document from a stream.
+import bench
+import ujson
+import uio
+
+def test(num):
+    s = ujson.dumps([{"id": i, "name": "sensor %d" % i, "value": i * 3, "ok": True} for i in range(50)])
+    for i in iter(range(num // 5000)):
+        ujson.load(uio.StringIO(s))
+
+bench.run(test)
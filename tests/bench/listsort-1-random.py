@@ -0,0 +1,12 @@
+import bench
+
+def test(num):
+    x = 1
+    l = []
+    for i in iter(range(1000)):
+        x = (x * 1103515245 + 12345) & 0x3fffffff
+        l.append(x)
+    for i in iter(range(num // 20000)):
+        sorted(l)
+
+bench.run(test)
@@ -0,0 +1,10 @@
+import bench
+
+def test(num):
+    l = list(range(1000))
+    r = l[::-1]
+    for i in iter(range(num // 20000)):
+        sorted(l)
+        sorted(r)
+
+bench.run(test)
@@ -0,0 +1,8 @@
+import bench
+
+def test(num):
+    l = [str(i % 97) for i in range(1000)]
+    for i in iter(range(num // 20000)):
+        sorted(l, key=len)
+
+bench.run(test)
@@ -0,0 +1,12 @@
+# Search a line with a pattern that makes backtracking take exponential
+# time, using the linear-time matcher.
+import bench
+import ure
+
+def test(num):
+    r = ure.compile("(a|aa)*b", ure.LINEAR)
+    s = "a" * 30
+    for i in iter(range(num // 2000)):
+        r.search(s)
+
+bench.run(test)
@@ -0,0 +1,11 @@
+# Rewrite fields in log-like lines with sub.
+import bench
+import ure
+
+def test(num):
+    r = ure.compile("([0-9]+)=([a-z]+)")
+    s = "".join("%d=val ok " % i for i in range(20))
+    for i in iter(range(num // 2000)):
+        r.sub(r"\2:\1", s)
+
+bench.run(test)
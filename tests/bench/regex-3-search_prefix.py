@@ -0,0 +1,12 @@
+# Search for a sentence in a buffer of NMEA-like lines, where the pattern
+# starts with a literal.
+import bench
+import ure
+
+def test(num):
+    r = ure.compile(r"\$GPRMC,(\d+),")
+    s = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\n" * 8 + "$GPRMC,123519,A\n"
+    for i in iter(range(num // 2000)):
+        r.search(s)
+
+bench.run(test)
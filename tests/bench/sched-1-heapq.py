@@ -0,0 +1,29 @@
+# Task switching of a scheduler in Python: 100 generator tasks sleep for a
+# few ticks each time they run, with the sleeping tasks kept in a uheapq
+# heap of tuples and the ready ones in a list.
+import bench
+import uheapq
+
+def task(i):
+    while True:
+        yield i % 5
+
+def test(num):
+    tasks = [task(i) for i in range(100)]
+    q = []
+    runq = []
+    n = 0
+    for t in tasks:
+        uheapq.heappush(q, (0, n, t))
+        n += 1
+    now = 0
+    for i in iter(range(num // 2000)):
+        while q and q[0][0] <= now:
+            runq.append(uheapq.heappop(q)[2])
+        while runq:
+            t = runq.pop(0)
+            uheapq.heappush(q, (now + next(t), n, t))
+            n += 1
+        now += 1
+
+bench.run(test)
@@ -0,0 +1,32 @@
+# As sched-1-heapq.py, with the sleeping tasks in a utimeq and the ready
+# ones in a runq, which allocate nothing per switch.
+import bench
+import utime
+import utimeq
+
+def task(i):
+    while True:
+        yield i % 5
+
+def test(num):
+    tasks = [task(i) for i in range(100)]
+    q = utimeq.utimeq(100)
+    runq = utimeq.runq(100)
+    item = [0, 0, 0]
+    ritem = [0, 0]
+    ticks_add = utime.ticks_add
+    ticks_diff = utime.ticks_diff
+    for t in tasks:
+        q.push(0, t, None)
+    now = 0
+    for i in iter(range(num // 2000)):
+        while q and ticks_diff(q.peektime(), now) <= 0:
+            q.pop(item)
+            runq.push(item[1], item[2])
+        while runq:
+            runq.pop(ritem)
+            t = ritem[0]
+            q.push(ticks_add(now, next(t)), t, None)
+        now = ticks_add(now, 1)
+
+bench.run(test)
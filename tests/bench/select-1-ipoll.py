@@ -0,0 +1,24 @@
+# Wait on many idle sockets, one of which is always readable, with poll()
+# and ipoll().
+import bench
+import usocket as socket
+import uselect as select
+
+def test(num):
+    p = select.poll()
+    socks = []
+    for i in range(200):
+        s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        p.register(s, select.POLLIN)
+        socks.append(s)
+    # a socket never connected is writable
+    p.modify(socks[100], select.POLLOUT)
+    for i in iter(range(num // 100)):
+        for t in p.poll(0):
+            pass
+        for t in p.ipoll(0):
+            pass
+    for s in socks:
+        s.close()
+
+bench.run(test)
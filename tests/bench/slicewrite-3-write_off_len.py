@@ -0,0 +1,11 @@
+import bench
+
+def test(num):
+    buf = bytes(65536)
+    f = open("/dev/null", "wb")
+    for i in iter(range(num // 2000)):
+        for off in range(0, 65536, 4096):
+            f.write(buf, off, 4096)
+    f.close()
+
+bench.run(test)
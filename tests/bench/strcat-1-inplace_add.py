@@ -0,0 +1,10 @@
+import bench
+
+def test(num):
+    for i in iter(range(num // 20000)):
+        s = ""
+        for j in range(1000):
+            s += "abcdefgh"
+        len(s)
+
+bench.run(test)
@@ -0,0 +1,10 @@
+import bench
+
+def test(num):
+    for i in iter(range(num // 20000)):
+        l = []
+        for j in range(1000):
+            l.append("abcdefgh")
+        s = "".join(l)
+
+bench.run(test)
@@ -0,0 +1,9 @@
+import bench
+
+def test(num):
+    s = "GET /index.html HTTP/1.1\r\nHost: example\r\n" * 100 + "X-Marker: end\r\n"
+    for i in iter(range(num // 2000)):
+        s.find("X-Marker:")
+        s.count("\r\n")
+
+bench.run(test)
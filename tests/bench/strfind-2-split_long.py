@@ -0,0 +1,9 @@
+import bench
+
+def test(num):
+    s = "field1,field2,field3,field4;" * 200
+    for i in iter(range(num // 10000)):
+        s.split(";")
+        s.split("field4;")
+
+bench.run(test)
@@ -0,0 +1,7 @@
+import bench
+
+def test(num):
+    for i in iter(range(num // 20)):
+        "t={} id={} v={:.2f} s={!r}".format(i, "node", 1.5, "ok")
+
+bench.run(test)
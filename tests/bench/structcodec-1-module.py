@@ -0,0 +1,13 @@
+# Pack and unpack records with the module-level functions, which parse the
+# format string on every call.
+import bench
+import ustruct
+
+def test(num):
+    fmt = "<HhIb4sf"
+    buf = bytearray(ustruct.calcsize(fmt))
+    for i in iter(range(num // 100)):
+        ustruct.pack_into(fmt, buf, 0, i & 0xffff, -1, i, 7, b"abcd", 1.5)
+        ustruct.unpack_from(fmt, buf)
+
+bench.run(test)
@@ -0,0 +1,13 @@
+# Pack and unpack records with a Struct object, which compiles the format
+# string once.
+import bench
+import ustruct
+
+def test(num):
+    s = ustruct.Struct("<HhIb4sf")
+    buf = bytearray(s.size)
+    for i in iter(range(num // 100)):
+        s.pack_into(buf, 0, i & 0xffff, -1, i, 7, b"abcd", 1.5)
+        s.unpack_from(buf)
+
+bench.run(test)
@@ -0,0 +1,12 @@
+# Unpack a buffer of consecutive records with Struct.iter_unpack.
+import bench
+import ustruct
+
+def test(num):
+    s = ustruct.Struct("<HhIb4sf")
+    buf = s.pack(1, -1, 2, 7, b"abcd", 1.5) * 100
+    for i in iter(range(num // 10000)):
+        for rec in s.iter_unpack(buf):
+            pass
+
+bench.run(test)
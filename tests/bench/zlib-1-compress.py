@@ -0,0 +1,10 @@
+# Compress a few kilobytes of log-like text.
+import bench
+import uzlib
+
+def test(num):
+    data = b"".join(b"%d: sensor %d reading %d ok\n" % (i, i % 7, i * 3) for i in range(200))
+    for i in iter(range(num // 10000)):
+        uzlib.compress(data)
+
+bench.run(test)
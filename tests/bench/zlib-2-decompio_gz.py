@@ -0,0 +1,27 @@
+# Decompress a 2MB gzip stream through DecompIO, 10 times.
+import bench
+import uzlib
+import uio
+
+block = b"".join(b"%d: sensor %d reading %d ok\n" % (i, i % 7, i * 3 % 1000) for i in range(2000))
+packed = uio.BytesIO()
+out = uzlib.CompIO(packed, 15 + 16)
+for i in range(40):
+    out.write(block)
+out.close()
+size = len(block) * 40
+
+def test(num):
+    buf = bytearray(4096)
+    for i in iter(range(num // 2000000)):
+        packed.seek(0)
+        inp = uzlib.DecompIO(packed, 15 + 16)
+        n = 0
+        while True:
+            sz = inp.readinto(buf)
+            if not sz:
+                break
+            n += sz
+        assert n == size
+
+bench.run(test)
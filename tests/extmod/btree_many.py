@@ -0,0 +1,53 @@
+# test batched puts and gets, bulk loading and scanning into a buffer
+try:
+    import btree
+    import uos
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+FNAME = "_btree_many.db"
+
+f = open(FNAME, "w+b")
+db = btree.open(f, pagesize=512)
+
+# put_many takes any iterable of pairs
+print(db.put_many([(b"b", b"2"), (b"a", b"1")]))
+print(db.put_many((b"k%d" % i, b"v%d" % i) for i in range(3)))
+print(db.get_many([b"a", b"b", b"k1", b"x"]))
+print(db.get_many(iter([b"x", b"k2"]), b"dflt"))
+try:
+    db.put_many([(b"x",)])
+except ValueError:
+    print("ValueError")
+db.close()
+
+# bulk load of sorted keys, enough to fill several pages
+db = btree.open(f, pagesize=512)
+print(db.load((b"%04d" % i, b"val%d" % i) for i in range(1000)))
+print(db[b"0000"], db[b"0999"], db.get(b"1000"))
+print(len(list(db.keys())))
+try:
+    db.load([(b"9000", b""), (b"8000", b"")])
+except ValueError:
+    print("ValueError")
+print(db[b"9000"], b"8000" in db)
+
+# scan into a preallocated buffer
+buf = bytearray(16)
+for kl, vl in db.scan_into(buf, b"0010", b"0013"):
+    print(kl, vl, buf[:kl], buf[kl:kl + vl])
+for kl, vl in db.scan_into(buf, b"0998", None, btree.DESC):
+    print(kl, vl, buf[:kl], buf[kl:kl + vl])
+    if buf[:kl] == b"0996":
+        break
+try:
+    for x in db.scan_into(bytearray(4)):
+        pass
+except ValueError:
+    print("ValueError")
+
+db.close()
+f.close()
+uos.remove(FNAME)
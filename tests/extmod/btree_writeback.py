@@ -0,0 +1,41 @@
+# test the write-back buffer and I/O statistics of btree
+try:
+    import btree
+    import uos
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+FNAME = "_btree_wb.db"
+
+f = open(FNAME, "w+b")
+db = btree.open(f, pagesize=512, cachesize=4096, writeback=4096)
+for i in range(500):
+    db[b"%04d" % (i * 7 % 500)] = b"value%d" % i
+cached, maxcache, reads, writes, write_ops, pending = db.stats()
+print(cached <= maxcache, pending <= 8)
+db.flush()
+cached, maxcache, reads, writes, write_ops, pending = db.stats()
+# pages written back may be gathered into fewer writes
+print(pending, writes > 0, write_ops <= writes)
+print(db[b"0123"], len(list(db.keys())))
+db.close()
+
+# read back without write-back buffer
+db = btree.open(f, pagesize=512)
+print(db[b"0000"], db[b"0499"], len(list(db.values())))
+print(db.stats()[2] > 0)
+db.close()
+
+# the file object may be moved while the db is open
+db = btree.open(f, pagesize=512, writeback=4096)
+for i in range(100):
+    db[b"k%03d" % i] = b"v%d" % i
+    f.seek(0)
+db.flush()
+f.seek(0)
+print(db[b"k000"], db[b"k099"], db[b"0123"], len(list(db.keys())))
+db.close()
+f.close()
+uos.remove(FNAME)
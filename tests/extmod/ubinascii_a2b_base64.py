@@ -32,3 +32,7 @@ try:
     print(binascii.a2b_base64(b'ab=cdef='))
 except ValueError:
     print("ValueError")
+try:
+    print(binascii.a2b_base64(b'ab=c'))
+except ValueError:
+    print("ValueError")
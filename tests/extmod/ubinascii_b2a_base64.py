@@ -15,3 +15,7 @@ print(binascii.b2a_base64(b'\x00\x01\x02\x03\x04\x05\x06\x07'))
 print(binascii.b2a_base64(b'\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f'))
 print(binascii.b2a_base64(b'\x7f\x80\xff'))
 print(binascii.b2a_base64(b'1234ABCDabcd'))
+
+print(binascii.b2a_base64(b'', newline=False))
+print(binascii.b2a_base64(b'f', newline=False))
+print(binascii.b2a_base64(b'foobar', newline=False))
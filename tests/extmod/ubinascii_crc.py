@@ -0,0 +1,58 @@
+try:
+    import ubinascii as binascii
+except ImportError:
+    import binascii
+try:
+    binascii.CRC
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+# check values for b"123456789" from the catalogue of parametrised CRCs
+params = [
+    ("CRC-32", 32, 0x04c11db7, 0xffffffff, True, True, 0xffffffff),
+    ("CRC-32/MPEG-2", 32, 0x04c11db7, 0xffffffff, False, False, 0),
+    ("CRC-32C", 32, 0x1edc6f41, 0xffffffff, True, True, 0xffffffff),
+    ("CRC-16/CCITT-FALSE", 16, 0x1021, 0xffff, False, False, 0),
+    ("CRC-16/XMODEM", 16, 0x1021, 0, False, False, 0),
+    ("CRC-16/KERMIT", 16, 0x1021, 0, True, True, 0),
+    ("CRC-16/ARC", 16, 0x8005, 0, True, True, 0),
+    ("CRC-12/UMTS", 12, 0x80f, 0, False, True, 0),
+    ("CRC-8", 8, 0x07, 0, False, False, 0),
+    ("CRC-8/MAXIM", 8, 0x31, 0, True, True, 0),
+    ("CRC-7", 7, 0x09, 0, False, False, 0),
+    ("CRC-5/USB", 5, 0x05, 0x1f, True, True, 0x1f),
+    ("CRC-4/ITU", 4, 0x3, 0, True, True, 0),
+    ("CRC-3/ROHC", 3, 0x3, 0x7, True, True, 0),
+]
+for name, *args in params:
+    crc = binascii.CRC(*args)
+    crc.update(b"123456789")
+    print(name, hex(crc.value()))
+
+# incremental updates, any buffer, reset
+crc = binascii.CRC(16, 0x1021, 0xffff)
+crc.update(b"1234")
+crc.update(bytearray(b"567"))
+crc.update(memoryview(b"x89")[1:])
+print(hex(crc.value()))
+crc.reset()
+print(hex(crc.value()))
+crc.update(b"")
+print(hex(crc.value()))
+
+# keyword arguments, matches crc32
+crc = binascii.CRC(width=32, poly=0x04c11db7, init=0xffffffff, refin=True, refout=True, xorout=0xffffffff)
+data = bytes(range(256)) * 2
+crc.update(data)
+print(crc.value() == binascii.crc32(data))
+
+try:
+    binascii.CRC(33, 1)
+except ValueError:
+    print("ValueError")
+try:
+    binascii.CRC(0, 1)
+except ValueError:
+    print("ValueError")
@@ -18,3 +18,9 @@ print(hex(binascii.crc32(b' over the lazy dog', binascii.crc32(b'The quick brown
 print(hex(binascii.crc32(b'\x00' * 16, binascii.crc32(b'\x00' * 16))))
 print(hex(binascii.crc32(b'\xff' * 16, binascii.crc32(b'\xff' * 16))))
 print(hex(binascii.crc32(bytes(range(16, 32)), binascii.crc32(bytes(range(16))))))
+
+# lengths around the 8-byte step, at unaligned offsets
+data = bytes(range(256)) * 4
+for i in range(1, 20, 3):
+    print(hex(binascii.crc32(memoryview(data)[i:i + 7 * i])))
+print(hex(binascii.crc32(bytearray(data))))
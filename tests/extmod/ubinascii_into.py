@@ -0,0 +1,60 @@
+try:
+    import ubinascii as binascii
+except ImportError:
+    import binascii
+try:
+    binascii.hexlify_into
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+buf = bytearray(32)
+mv = memoryview(buf)
+
+n = binascii.hexlify_into(buf, b'\x7f\x80\xff')
+print(n, buf[:n])
+n = binascii.hexlify_into(mv[4:], b'\x01\x02\x03', ':')
+print(n, buf[4:4 + n])
+print(binascii.hexlify_into(buf, b''), binascii.hexlify_into(buf, b'', ':'))
+print(binascii.hexlify(b'', ':'))
+
+n = binascii.unhexlify_into(buf, b'7F80ff')
+print(n, buf[:n])
+n = binascii.unhexlify_into(mv[8:], bytearray(b'0102'))
+print(n, buf[8:8 + n])
+
+n = binascii.b2a_base64_into(buf, b'foob')
+print(n, buf[:n])
+n = binascii.b2a_base64_into(mv[16:], b'foobar', newline=False)
+print(n, buf[16:16 + n])
+
+n = binascii.a2b_base64_into(buf, b'Zm9vYg==')
+print(n, buf[:n])
+n = binascii.a2b_base64_into(mv[4:], b'Zm9vYmFy')
+print(n, buf[4:4 + n])
+
+# output buffer too small, nothing is written
+buf = bytearray(b'........')
+for f, arg in ((binascii.hexlify_into, b'12345'), (binascii.unhexlify_into, b'00' * 9),
+        (binascii.b2a_base64_into, b'123456'), (binascii.a2b_base64_into, b'Zm9vYmFyZm9v')):
+    try:
+        f(buf, arg)
+    except ValueError as e:
+        print('ValueError', e)
+print(buf)
+
+# input errors, as for the functions returning bytes
+for f, arg in ((binascii.unhexlify_into, b'123'), (binascii.unhexlify_into, b'1g'),
+        (binascii.a2b_base64_into, b'abc'), (binascii.a2b_base64_into, b'ab*d'),
+        (binascii.a2b_base64_into, b'ab=cdef=')):
+    try:
+        f(bytearray(16), arg)
+    except ValueError as e:
+        print('ValueError', e)
+
+# the output must be writable
+try:
+    binascii.hexlify_into(b'1234', b'1')
+except TypeError:
+    print('TypeError')
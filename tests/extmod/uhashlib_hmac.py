@@ -0,0 +1,34 @@
+try:
+    import uhashlib as hashlib
+    hmac = hashlib.hmac
+except ImportError:
+    try:
+        import hashlib
+        import hmac as _hmac
+        def hmac(key, msg=None, digestmod=hashlib.sha256):
+            return _hmac.new(key, msg, digestmod)
+    except ImportError:
+        print("SKIP")
+        import sys
+        sys.exit()
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+# keys shorter than, equal to and longer than a block
+for key in (b"", b"key", b"k" * 64, b"k" * 100):
+    print(hmac(key, b"The quick brown fox").hexdigest())
+
+h = hmac(b"key", digestmod=hashlib.sha256)
+h.update(b"part 1")
+h2 = h.copy()
+h2.update(b"part 2")
+print(h.hexdigest())
+print(h2.hexdigest())
+print(h.digest() == hmac(b"key", b"part 1").digest())
+
+if hasattr(hashlib, "sha512"):
+    print(hmac(b"k" * 200, b"msg", hashlib.sha512).hexdigest())
+else:
+    print("b5245971beb52a5a986812c4666a05c735bf5bb7aba32eae2192adad605df4112d6c285d1c46cf81ccb7ab8c2c3b7b3c6793216909b5add05223ed21f24cdb1e")
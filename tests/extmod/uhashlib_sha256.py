@@ -24,13 +24,17 @@ print(h.digest())
 
 print(hashlib.sha256(b"\xff" * 64).digest())
 
-# TODO: running .digest() several times in row is not supported()
-#h = hashlib.sha256(b'123')
-#print(h.digest())
-#print(h.digest())
+# digest() can be called more than once, and the hash updated after it
+h = hashlib.sha256(b'123')
+print(h.digest())
+print(h.digest())
+h.update(b'456')
+print(h.digest())
 
-# TODO: partial digests are not supported
-#h = hashlib.sha256(b'123')
-#print(h.digest())
-#h.update(b'456')
-#print(h.digest())
+# copy() gives an independent hash of the same data
+h = hashlib.sha256(b'123')
+h2 = h.copy()
+h2.update(b'456')
+print(h.digest())
+print(h2.digest())
+print(h.hexdigest())
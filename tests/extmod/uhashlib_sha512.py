@@ -0,0 +1,35 @@
+try:
+    import uhashlib as hashlib
+except ImportError:
+    try:
+        import hashlib
+    except ImportError:
+        # This is neither uPy, nor cPy, so must be uPy with
+        # uhashlib module disabled.
+        print("SKIP")
+        import sys
+        sys.exit()
+
+try:
+    hashlib.sha512
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+print(hashlib.sha512().digest())
+print(hashlib.sha512(b"123").digest())
+
+# lengths around the padding boundaries, fed in pieces
+for n in (111, 112, 127, 128, 129, 1000):
+    data = bytes(i & 0xff for i in range(n))
+    h = hashlib.sha512()
+    h.update(data[:n // 3])
+    h.update(data[n // 3:])
+    print(n, h.hexdigest())
+
+h = hashlib.sha512(b"abc")
+h2 = h.copy()
+h2.update(b"def")
+print(h.hexdigest())
+print(h2.hexdigest())
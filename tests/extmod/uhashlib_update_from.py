@@ -0,0 +1,43 @@
+# test hashing data read from a stream
+try:
+    import uhashlib
+    import uio
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+data = bytes(range(256)) * 20
+
+h = uhashlib.sha256()
+print(h.update_from(uio.BytesIO(data)))
+print(h.digest() == uhashlib.sha256(data).digest())
+
+# only nbytes are read
+s = uio.BytesIO(data)
+h = uhashlib.sha256(b"x")
+print(h.update_from(s, 1000))
+print(h.digest() == uhashlib.sha256(b"x" + data[:1000]).digest())
+print(s.read(2))
+
+# short stream
+print(uhashlib.sha256().update_from(uio.BytesIO(b"abc"), 10))
+
+try:
+    uhashlib.sha256().update_from(1)
+except OSError:
+    print("OSError")
+
+# a hash object isn't a stream
+for h in (uhashlib.sha256(), getattr(uhashlib, "sha512", uhashlib.sha256)()):
+    try:
+        uhashlib.sha256().update_from(h)
+    except OSError:
+        print("OSError")
+try:
+    import ujson
+    ujson.load(uhashlib.sha256())
+except ImportError:
+    print("OSError")
+except OSError:
+    print("OSError")
@@ -0,0 +1,30 @@
+try:
+    from uio import StringIO
+    import ujson as json
+except:
+    from io import StringIO
+    import json
+
+s = StringIO()
+json.dump(False, s)
+print(s.getvalue())
+
+s = StringIO()
+json.dump({"a": (2, [3, None]), "b": "x\ny\"z"}, s)
+print(s.getvalue())
+
+# output larger than the internal buffer, and a long string that is
+# written through without buffering
+obj = [{"id": i, "name": "item%d" % i, "neg": -i, "tags": ["a", "b"]} for i in range(50)]
+obj.append("\t" + "x" * 1000 + "\\")
+s = StringIO()
+json.dump(obj, s)
+print(s.getvalue() == json.dumps(obj))
+print(len(s.getvalue()))
+print(json.loads(s.getvalue()) == obj)
+
+# dump to a stream that already has data, and nested small ints
+s = StringIO()
+s.write("data=")
+json.dump([0, -1, 123456789, -987654321], s)
+print(s.getvalue())
@@ -0,0 +1,39 @@
+# test incremental parsing with ujson.iterload
+try:
+    from uio import StringIO
+    import ujson as json
+    json.iterload
+except (ImportError, AttributeError):
+    print("SKIP")
+    import sys
+    sys.exit()
+
+def events(s):
+    for ev in json.iterload(StringIO(s)):
+        print(ev)
+
+events('1')
+events(' "abc" ')
+events('[]')
+events('{}')
+events('{"a": [1, 2.5, {"b": null}], "c": {"d": true}, "e": "f"}')
+events('[[{"x": []}], false]')
+
+# several documents in one stream
+events('{"n": 1}\n{"n": 2}\n')
+
+# a large document is processed in pieces
+n = 0
+for ev, val in json.iterload(StringIO('[' + ', '.join('{"id": %d}' % i for i in range(500)) + ']')):
+    if ev == "value":
+        n += val
+print(n)
+
+# errors
+for s in ('[1', '{"a": 1', '[}', '{"a"]', '{1: 2}', '{[]: 1}', ']', 'nul'):
+    try:
+        for ev in json.iterload(StringIO(s)):
+            pass
+        print("no error", s)
+    except ValueError:
+        print("ValueError", s)
@@ -9,3 +9,10 @@ print(json.load(StringIO('null')))
 print(json.load(StringIO('"abc\\u0064e"')))
 print(json.load(StringIO('[false, true, 1, -2]')))
 print(json.load(StringIO('{"a":true}')))
+
+# documents longer than the read buffer, with strings and escapes spanning
+# the boundaries between reads
+doc = '[' + ', '.join('{"key%d": "%s\\n%s", "n": %d}' % (i, "v" * i, "w" * (i % 7), i * 1001) for i in range(60)) + ']'
+obj = json.load(StringIO(doc))
+print(len(obj), obj[0], obj[59]["n"], obj[59]["key59"] == "v" * 59 + "\n" + "w" * 3)
+print(json.load(StringIO(' "' + 'x' * 200 + '" ')) == 'x' * 200)
@@ -32,3 +32,7 @@ try:
     json.loads('')
 except ValueError:
     print('ValueError')
+
+# integers around the small-int limits
+for n in (1073741823, 1073741824, -1073741824, 4611686018427387903, 4611686018427387904, -4611686018427387905, 10 ** 25):
+    print(json.loads(str(n)) == n, json.loads('[%d]' % n)[0] == n)
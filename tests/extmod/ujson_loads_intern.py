@@ -0,0 +1,29 @@
+# test interning of dict keys by ujson
+try:
+    import ujson as json
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+doc = '{"ujson_intern_test_key": [1, {"ujson_intern_test_key2": "ujson_intern_test_val"}]}'
+d1 = json.loads(doc, intern_keys=True)
+d2 = json.loads(doc, intern_keys=True)
+print(d1 == d2, d1)
+k1 = list(d1.keys())[0]
+k2 = list(d2.keys())[0]
+print(k1 is k2)
+print(list(d1[k1][1].keys())[0] is list(d2[k2][1].keys())[0])
+
+# values are not interned
+print(d1[k1][1]["ujson_intern_test_key2"] is d2[k2][1]["ujson_intern_test_key2"])
+
+# by default keys are not interned
+d3 = json.loads('{"ujson_intern_test_key3": 1}')
+d4 = json.loads('{"ujson_intern_test_key3": 1}')
+print(list(d3.keys())[0] is list(d4.keys())[0])
+
+try:
+    json.loads('{}', True)
+except TypeError:
+    print("TypeError")
@@ -0,0 +1,32 @@
+try:
+    import ure as re
+except ImportError:
+    import re
+
+try:
+    re.finditer
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+def f(it):
+    return [m.group(0) for m in it]
+
+print(f(re.finditer('a.', 'banana')))
+print(f(re.finditer('z', 'banana')))
+print(f(re.finditer('^a', 'aaa')))
+print(f(re.finditer('x*', 'axbxx')))
+print(f(re.finditer('', '')))
+print([m.group(1) for m in re.compile(r'(\d+)').finditer('a1b22c333')])
+
+it = re.finditer('a', 'ab')
+print(next(it).group(0))
+try:
+    next(it)
+except StopIteration:
+    print('StopIteration')
+
+# after an empty match, a non-empty one may start at the same position
+print([m.group(0) for m in re.finditer('|a', 'ab')])
+print([m.group(0) for m in re.finditer(r'\s*|\S', 'a b')])
@@ -0,0 +1,48 @@
+# test the linear-time matcher selected with ure.LINEAR
+import ure
+
+try:
+    ure.LINEAR
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+def groups(m, n):
+    return m and [m.group(i) for i in range(n)]
+
+# the matches are the same as those of the backtracking matcher
+for pat, n, s in (
+    ('(a|aa)*b', 2, 'aaab'),
+    (r'(\w+)@(\w+)', 3, 'x foo@bar y'),
+    ('a(b*)c', 2, 'xabbbcz'),
+    ('a(b*?)(b*)c', 3, 'abbc'),
+    ('(a)|(b)', 3, 'cb'),
+    ('^ab|b', 1, 'cab'),
+    ('a*?', 1, 'aa'),
+    ('[0-9]+$', 1, 'a12b345'),
+    ('x', 1, 'abc'),
+):
+    m1 = ure.compile(pat).search(s)
+    m2 = ure.compile(pat, ure.LINEAR).search(s)
+    print(groups(m2, n), groups(m1, n) == groups(m2, n))
+
+r = ure.compile('(a+)b', ure.LINEAR)
+print(groups(r.match('aab'), 2), r.match('caab'))
+print(ure.compile(' +', ure.LINEAR).split('a b  c'))
+
+# these take exponential time, or overflow the stack, when backtracking
+print(ure.compile('(a|aa)*b', ure.LINEAR).search('a' * 40))
+print(groups(ure.compile('(a*)*', ure.LINEAR).search('b'), 1))
+print(len(ure.compile('(ab)*', ure.LINEAR).match('ab' * 5000).group(0)))
+
+# empty matches give the same results as with the backtracking matcher
+for pat, s in (('|a', 'ab'), (r'\s*|\S', 'a b'), ('x*', 'abxd'), ('a*?', 'aa')):
+    r1 = ure.compile(pat)
+    r2 = ure.compile(pat, ure.LINEAR)
+    print(r2.sub('-', s), r1.sub('-', s) == r2.sub('-', s),
+        [m.group(0) for m in r1.finditer(s)] == [m.group(0) for m in r2.finditer(s)])
+
+# bitmap classes in a repeated group
+print(ure.compile('(?:[abcd][abcd][abcd][abcd])*x', ure.LINEAR).search('abcdabcdx').group(0))
+print(ure.compile('(' + '[a-z0-9_.]' * 10 + ')+!', ure.LINEAR).search('--' + 'ab' * 10 + '!').group(0))
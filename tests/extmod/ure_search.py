@@ -0,0 +1,42 @@
+# test search with patterns that start with a literal or a set of bytes
+try:
+    import ure as re
+except ImportError:
+    import re
+
+def s(pat, string):
+    m = re.search(pat, string)
+    print(pat, m and m.group(0))
+
+# literal prefix
+s('GET /', 'POST /x GET /index.html')
+s('GET /(\\w+)', 'GETT GET / GET /a')
+s('abc+', 'ab abcabccc')
+s('ab*', 'xxbba')
+s('ab?c', 'xxacxabc')
+s('(ab)+', 'aababab')
+s('aa', 'a')
+s('aa', 'xa')
+s('\\$GPRMC,', '$GPGGA,1$GPRMC,2')
+
+# set of first bytes
+s('a|b', 'xxbxa')
+s('[0-9]+', 'abc 123')
+s('\\d+', 'abc 123')
+s('\\s', 'ab c')
+s('(x|[yz])\\d', 'x y1')
+s('[^a]+', 'aaabca')
+s('a*b', 'aaac b')
+s('^a', 'ba')
+s('a$', 'aba')
+
+# classes with many ranges are compiled to a bitmap
+s('[a-cx-z0-9_]+', '-- yb_9w')
+s('[^a-bd-ex-y0-2]+', 'abcfz3a')
+s('[a-bd-eg-hj-k]', 'cfik')
+s('[\x01-\x08b-c\x0e-\x1fq]+', 'a\x05\x1fb')
+
+# bitmap classes in a repeated group, where they would make the loop's jumps
+# too long
+s('(?:[abcd][abcd][abcd][abcd])*x', 'abcdabcdx')
+s('(' + '[a-z0-9_.]' * 10 + ')+!', '--' + 'ab' * 10 + '!')
@@ -0,0 +1,51 @@
+try:
+    import ure as re
+except ImportError:
+    import re
+
+try:
+    re.sub
+except AttributeError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+print(re.sub('a', 'b', 'banana'))
+print(re.sub('a', 'b', 'banana', 2))
+print(re.sub('z', 'b', 'banana'))
+print(re.compile('n').sub('N', 'banana'))
+print(re.sub(b'a', b'o', b'banana'))
+
+# group references and escapes in the template
+print(re.sub('(a)(n)', r'\2\1', 'banana'))
+print(re.sub('(a)(n)', r'\g<2>\g<1>', 'banana'))
+print(re.sub('a', r'[\\]', 'banana'))
+print(repr(re.sub('a', r'\n\t', 'banana')))
+print(re.sub('(b)|(n)', r'<\1\2>', 'banana'))
+
+# callable replacement
+print(re.sub('a(n?)', lambda m: m.group(1).upper() + '_', 'banana'))
+
+# empty matches
+print(re.sub('x*', '-', 'abxd'))
+print(re.sub('', '-', 'abc'))
+print(re.sub('^', '>', 'abc'))
+print(re.sub('$', '<', 'abc'))
+print(re.sub('a*', '-', 'baac'))
+
+# after an empty match, a non-empty one may start at the same position
+print(re.sub('|a', '-', 'ab'))
+print(re.sub(r'\s*|\S', r'<\g<0>>', 'a b'))
+print(re.sub('(a)|b?', r'[\1]', 'xab'))
+
+# count
+print(re.sub('a', 'b', 'aaa', 0))
+print(re.sub('a', 'b', 'aaa', 2))
+print(re.sub('a', 'b', 'aaa', -1))
+
+# bad group reference
+for repl in (r'\2', r'\g<x>', r'\g<>'):
+    try:
+        re.sub('(a)', repl, 'a')
+    except Exception as e:
+        print('error')
@@ -0,0 +1,129 @@
+# test utimeq and runq
+try:
+    import utimeq
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+try:
+    from utime import ticks_add, ticks_diff
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+MAX = ticks_add(0, -1)
+
+q = utimeq.utimeq(10)
+print(bool(q), len(q))
+item = [0, 0, 0]
+
+# ordered by time
+for t in (5, 1, 9, 3, 7):
+    q.push(t, t * 10, "a%d" % t)
+print(bool(q), len(q), q.peektime())
+while q:
+    print(q.pop(item))
+print(len(q))
+
+# the same times are taken in the order pushed
+for i in range(6):
+    q.push(100 + i % 2, i, None)
+while q:
+    q.pop(item)
+    print(item[0], item[1])
+
+# times wrap around
+for t in (ticks_add(MAX, -1), 1, MAX, 0, ticks_add(MAX, -10), 10):
+    q.push(t, t, None)
+while q:
+    q.pop(item)
+    print(ticks_diff(item[0], MAX))
+
+# remove takes off the earliest entry for a callback
+cb1, cb2 = object(), object()
+for t, cb in ((4, cb1), (2, cb2), (1, cb1), (3, cb2)):
+    q.push(t, cb, t)
+print(q.remove(cb1), q.remove(cb2), q.remove(cb2), q.remove(cb2))
+while q:
+    q.pop(item)
+    print(item[0], item[1] is cb1, item[2])
+
+# a longer run against a sorted list
+import urandom
+urandom.seed(1)
+q = utimeq.utimeq(100)
+ref = []
+for i in range(100):
+    t = urandom.getrandbits(8)
+    q.push(t, i, None)
+    ref.append((t, i))
+for i in range(0, 100, 7):
+    q.remove(i)
+    ref.remove([r for r in ref if r[1] == i][0])
+ref.sort()
+out = []
+while q:
+    q.pop(item)
+    out.append((item[0], item[1]))
+print(out == ref)
+
+# errors
+q = utimeq.utimeq(1)
+q.push(0, 0, 0)
+try:
+    q.push(0, 0, 0)
+except IndexError:
+    print("IndexError")
+q.pop(item)
+for f in (q.peektime, lambda: q.pop(item)):
+    try:
+        f()
+    except IndexError:
+        print("IndexError")
+q.push(0, 0, 0)
+try:
+    q.pop([0, 0])
+except ValueError:
+    print("ValueError")
+try:
+    q.pop((0, 0, 0))
+except TypeError:
+    print("TypeError")
+
+# runq is first in, first out, and wraps around its buffer
+r = utimeq.runq(4)
+print(bool(r), len(r))
+item = [0, 0]
+for i in range(6):
+    r.push(i, -i)
+    if i % 2:
+        r.push(i, None)
+    print(r.pop(item), len(r))
+while r:
+    print(r.pop(item))
+for i in range(4):
+    r.push(i, i)
+try:
+    r.push(5, 5)
+except IndexError:
+    print("IndexError")
+for i in range(4):
+    r.pop(item)
+try:
+    r.pop(item)
+except IndexError:
+    print("IndexError")
+
+# bad capacities
+for cls in (utimeq.utimeq, utimeq.runq):
+    try:
+        cls(-1)
+    except ValueError:
+        print("ValueError")
+    try:
+        cls(2**40)
+    except (MemoryError, OverflowError):
+        print("too large")
+    print(len(cls(0)))
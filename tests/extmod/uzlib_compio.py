@@ -0,0 +1,73 @@
+try:
+    import uzlib
+    import uio as io
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+if not hasattr(uzlib, "CompIO"):
+    print("SKIP")
+    import sys
+    sys.exit()
+
+DATA = b'The quick brown fox jumps over the lazy dog. ' * 40 + bytes(range(256))
+
+def compress(data, chunk, *args):
+    buf = io.BytesIO()
+    out = uzlib.CompIO(buf, *args)
+    for i in range(0, len(data), chunk):
+        out.write(data[i:i + chunk])
+    out.close()
+    return buf.getvalue()
+
+# zlib stream, written in chunks of different sizes
+for chunk in (1, 13, 1000, 5000):
+    packed = compress(DATA, chunk)
+    print(chunk, len(packed) < len(DATA), uzlib.decompress(packed) == DATA)
+
+# raw deflate and gzip, all levels
+for wbits in (-9, -12, 9 + 16, 15 + 16):
+    for level in (0, 1, 9):
+        packed = compress(DATA, 100, wbits, level)
+        inp = uzlib.DecompIO(io.BytesIO(packed), wbits)
+        print(wbits, level, inp.read() == DATA)
+
+# gzip header
+print(compress(b'', 1, 31)[:4])
+
+# flush makes everything written so far decompressible
+buf = io.BytesIO()
+out = uzlib.CompIO(buf, -10)
+out.write(b'hello ')
+out.flush()
+out.write(b'world')
+out.flush()
+inp = uzlib.DecompIO(io.BytesIO(buf.getvalue()), -10)
+print(inp.read(11))
+out.close()
+print(bytes(uzlib.decompress(buf.getvalue(), -10)))
+
+# context manager, the destination stream isn't closed
+buf = io.BytesIO()
+with uzlib.CompIO(buf) as out:
+    out.write(DATA)
+print(uzlib.decompress(buf.getvalue()) == DATA)
+
+# write after close
+out.close()
+try:
+    out.write(b'x')
+except OSError:
+    print('OSError')
+
+# bad arguments
+for args in ((8,), (16,), (-16,), (15, 10), (15, -2)):
+    try:
+        uzlib.CompIO(io.BytesIO(), *args)
+    except ValueError:
+        print('ValueError')
+try:
+    uzlib.compress(b'', 6, 40)
+except ValueError:
+    print('ValueError')
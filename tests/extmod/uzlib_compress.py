@@ -0,0 +1,54 @@
+try:
+    import zlib
+except ImportError:
+    try:
+        import uzlib as zlib
+    except ImportError:
+        print("SKIP")
+        import sys
+        sys.exit()
+
+if not hasattr(zlib, "compress"):
+    print("SKIP")
+    import sys
+    sys.exit()
+
+PATTERNS = [
+    b'',
+    b'a',
+    b'hello',
+    b'0' * 100,
+    bytes(range(256)) * 8,
+    b'abcabcabd' * 300,
+    b'The quick brown fox jumps over the lazy dog. ' * 50,
+]
+
+# pseudo-random data, which doesn't compress well
+x = 1
+l = []
+for i in range(3000):
+    x = (x * 1103515245 + 12345) & 0x7fffffff
+    l.append(x >> 16 & 0xff)
+PATTERNS.append(bytes(l))
+
+for data in PATTERNS:
+    packed = zlib.compress(data)
+    assert zlib.decompress(packed) == data
+    print(len(data), len(packed) < len(data) + 16)
+
+# all levels, zlib and raw deflate with different window sizes
+for data in PATTERNS[4:]:
+    for level in (0, 1, 6, 9):
+        for wbits in (9, 12, 15, -9, -15):
+            packed = zlib.compress(data, level, wbits)
+            assert zlib.decompress(packed, wbits) == data, (level, wbits)
+    print(len(data))
+
+# matches longer than the window must not be used
+data = b'x' * 300 + bytes(range(256)) * 4 + b'x' * 300
+for wbits in (9, 10, -9):
+    assert zlib.decompress(zlib.compress(data, 9, wbits), wbits) == data
+print(len(data))
+
+# compressed data decompresses with zlib too
+print(bytes(zlib.decompress(zlib.compress(b'hello world'))))
@@ -30,3 +30,11 @@ try:
     print(inp.read())
 except OSError as e:
     print(repr(e))
+
+# The source stream is read in blocks, the unused part of the last one is
+# given back at the end of compressed data
+buf = io.BytesIO(b'x\x9c30\xa0=\x00\x00\xb3q\x12\xc1' + b'trailing data')
+inp = zlib.DecompIO(buf)
+print(len(inp.read()))
+print(buf.seek(0, 1))
+print(buf.read())
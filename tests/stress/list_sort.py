@@ -4,3 +4,23 @@ l.sort()
 print(l[0], l[-1])
 l.sort(reverse=True)
 print(l[0], l[-1])
+
+# already sorted, reverse sorted and many duplicates
+l = list(range(5000))
+print(sorted(l) == l, sorted(l, reverse=True) == l[::-1])
+l = list(range(5000, 0, -1))
+print(sorted(l) == l[::-1], sorted(l, reverse=True) == l)
+l = [i % 3 for i in range(5000)]
+print(sorted(l)[1666:1668], sorted(l, reverse=True)[1666:1668])
+
+# stability with a key, including with reverse
+l = [(i % 7, i) for i in range(3000)]
+s = sorted(l, key=lambda x: x[0])
+print(all(s[i][1] < s[i + 1][1] for i in range(len(s) - 1) if s[i][0] == s[i + 1][0]))
+s = sorted(l, key=lambda x: x[0], reverse=True)
+print(all(s[i][1] < s[i + 1][1] for i in range(len(s) - 1) if s[i][0] == s[i + 1][0]))
+print(s[0], s[-1])
+
+# strings
+l = [str(i) for i in range(2000)]
+print(sorted(l)[:3], sorted(l, reverse=True)[:3])
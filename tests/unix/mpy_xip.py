@@ -0,0 +1,73 @@
+# test importing a .mpy file, which the unix port maps and executes in place
+import sys
+try:
+    import uos
+    open('/proc/self/maps').close()
+except (ImportError, OSError):
+    print("SKIP")
+    sys.exit()
+
+# compiled by mpy-cross -mcache-lookup-bc from:
+#   def double_plus_one(x):
+#       return x * 2 + 1
+#   class XipThing:
+#       def describe(self):
+#           return "xip_" + str(double_plus_one(3))
+#   greeting = "hello from xip"
+#   consts = (1.5, 2**70, b"bytes_xip")
+MPY = (
+    b'M\x00\x03\x1f7\x03\x00\x00\x00\x00\x00\x0b\t\x00\xf4\x00fk %\x00\x00\xff`\x03$\xf5\x00 `\x04\x16'
+    b'\xf7\x00d\x02$\xf7\x00\x17\x00$\xfb\x00\x17\x01\x82\x14\x80F\xe2\x17\x02P\x03$\xfc\x00\x11[\x08<mo'
+    b'dule>\txipmod.py\x0fdouble_plus_one\x08'
+    b'XipThing\x08XipThing\x08greeting\x06const'
+    b's\x03\x02s\x0ehello from xipf\x031.5b\tbytes_'
+    b'xip\x15\x03\x00\x00\x01\x00\x00\x08\xf5\x00\xf4\x00!\x00\x00\xff\xb0\x82\xde\x81\xdc[\x0fdouble'
+    b'_plus_one\txipmod.py\x00\x00\x01x$\x01\x00\x00\x00\x00\x00\t\xf7'
+    b'\x00\xf4\x00n \x00\x00\xff\x1cQ\x00\x00$P\x00\x16\xf7\x00$U\x00`\x00$\xf8\x00\x11[\x08Xip'
+    b'Thing\txipmod.py\x08__name__\n__modul'
+    b'e__\x08XipThing\x0c__qualname__\x08descri'
+    b'be\x00\x01"\x05\x00\x00\x01\x00\x00\t\xf8\x00\xf4\x00a@\x00\x00\xff\x16\xfa\x00\x1d\xe1\x00\x00\x1d\xf5\x00\x00'
+    b'\x83d\x01d\x01\xdc[\x08describe\txipmod.py\x04xip_\x03'
+    b'str\x0fdouble_plus_one\x00\x00\x04self'
+)
+
+def write(name, data):
+    with open(name + '.mpy', 'wb') as f:
+        f.write(data)
+
+def maps():
+    with open('/proc/self/maps') as f:
+        return len(f.readlines())
+
+sys.path.insert(0, '')
+
+write('mpy_xip_a', MPY)
+try:
+    import mpy_xip_a
+except ValueError:
+    # .mpy made for a different small int size or feature set
+    uos.unlink('mpy_xip_a.mpy')
+    print("SKIP")
+    sys.exit()
+print(mpy_xip_a.XipThing().describe(), mpy_xip_a.greeting, mpy_xip_a.consts)
+
+# the same code loaded again, now with its qstrs already interned
+write('mpy_xip_b', MPY)
+import mpy_xip_b
+import gc
+gc.collect()
+print(mpy_xip_b.double_plus_one(20), mpy_xip_a.double_plus_one(-1))
+
+# a truncated file raises, and its mapping is released
+write('mpy_xip_c', MPY[:200])
+n = maps()
+for i in range(20):
+    try:
+        import mpy_xip_c
+    except ValueError as er:
+        err = er
+    sys.modules.pop('mpy_xip_c', None)
+print(err, maps() - n)
+
+for name in ('mpy_xip_a', 'mpy_xip_b', 'mpy_xip_c'):
+    uos.unlink(name + '.mpy')
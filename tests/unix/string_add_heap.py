@@ -0,0 +1,10 @@
+# test that many short in-place additions to a long str/bytes fit in the heap
+s = ""
+for i in range(100000):
+    s += "ab"
+print(len(s), s[-4:], s.count("ba"))
+
+b = b"x" * 100
+for i in range(50000):
+    b += bytes([i & 0xff])
+print(len(b), b[-3:])
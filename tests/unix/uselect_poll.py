@@ -0,0 +1,84 @@
+# test unix uselect.poll with enough sockets registered to use epoll
+try:
+    import usocket as socket, uselect as select
+except ImportError:
+    print("SKIP")
+    import sys
+    sys.exit()
+
+PORT = 18700
+
+def addr(i):
+    return socket.getaddrinfo("127.0.0.1", PORT + i)[0][-1]
+
+def make(n):
+    socks = []
+    for i in range(n):
+        s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        s.bind(addr(i))
+        socks.append(s)
+    return socks
+
+def test(n):
+    socks = make(n)
+    fds = [s.fileno() for s in socks]
+    p = select.poll()
+    for s in socks:
+        print(p.register(s, select.POLLIN), end=" ")
+    print()
+    # registering again only modifies
+    print(p.register(socks[0], select.POLLIN))
+
+    # nothing ready
+    print(p.poll(0))
+    print(list(p.ipoll(0)))
+
+    # make two sockets readable
+    tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    for i in (1, n - 1):
+        tx.sendto(b"x", addr(i))
+    tx.close()
+
+    # ipoll yields the same tuple each time
+    ready = []
+    last = None
+    for t in p.ipoll(100):
+        if last is not None:
+            print(t is last)
+        last = t
+        ready.append(fds.index(t[0]))
+    print(sorted(ready))
+    print(sorted(fds.index(fd) for fd, ev in p.poll(0)))
+
+    # one-shot disables the sockets that were returned
+    print(sorted(fds.index(fd) for fd, ev in p.poll(0, 1)))
+    print(p.poll(0))
+    p.modify(socks[1], select.POLLIN)
+    print([fds.index(fd) for fd, ev in p.poll(0)])
+
+    # unregistered sockets aren't returned
+    p.unregister(socks[1])
+    print(p.poll(0))
+
+    # sockets closed while registered are reported as invalid
+    socks[2].close()
+    print([(fds.index(fd), ev) for fd, ev in p.poll(0)])
+    print([(fds.index(fd), ev) for fd, ev in p.poll()])
+    p.unregister(fds[2])
+    print(p.poll(0))
+
+    # one-shot with several closed sockets returns them all
+    socks[0].close()
+    socks[3].close()
+    print(sorted((fds.index(fd), ev) for fd, ev in p.poll(0, 1)))
+    # poll() still reports them, as it ignores the events asked for
+    print(sorted((fds.index(fd), ev) for fd, ev in p.poll(0)))
+    p.unregister(fds[0])
+    p.unregister(fds[3])
+    print(p.poll(0))
+
+    for s in socks:
+        s.close()
+
+test(4)
+test(40)
@@ -30,8 +30,14 @@
 #if MICROPY_PY_USELECT
 
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <poll.h>
+#if MICROPY_PY_USELECT_EPOLL
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#endif
 
 #include "py/runtime.h"
 #include "py/obj.h"
@@ -47,13 +53,37 @@ extern const mp_obj_type_t mp_type_socket;
 // Flags for poll()
 #define FLAG_ONESHOT (1)
 
+// fds below this are found through a table instead of by searching entries
+#define POLL_SLOTS_MAX_FD (65536)
+
+// values of epfd besides an epoll fd
+#define EPOLL_NOT_STARTED (-1)
+#define EPOLL_UNUSABLE (-2)
+
 /// \class Poll - poll class
 
 typedef struct _mp_obj_poll_t {
     mp_obj_base_t base;
-    unsigned short alloc;
-    unsigned short len;
+    mp_uint_t alloc;
+    mp_uint_t len;
     struct pollfd *entries;
+    // for each fd below slots_len, 1 + index of its entry, or 0 if none
+    mp_uint_t *slots;
+    mp_uint_t slots_len;
+    // results of the last wait still to be iterated
+    int iter_cnt;
+    mp_uint_t iter_idx;
+    int flags;
+    // callee-owned tuple returned by ipoll
+    mp_obj_t ret_tuple;
+    #if MICROPY_PY_USELECT_EPOLL
+    int epfd;
+    mp_uint_t ep_alloc;
+    struct epoll_event *ep_events;
+    // the results to iterate are in ep_events, even if epoll is given up
+    // meanwhile
+    bool iter_epoll;
+    #endif
 } mp_obj_poll_t;
 
 STATIC int get_fd(mp_obj_t fdlike) {
@@ -72,6 +102,109 @@ STATIC int get_fd(mp_obj_t fdlike) {
     return fd;
 }
 
+// Returns the entry of fd, or NULL if it isn't registered
+STATIC struct pollfd *poll_find(mp_obj_poll_t *self, int fd) {
+    if (fd >= 0 && fd < POLL_SLOTS_MAX_FD) {
+        if ((mp_uint_t)fd < self->slots_len && self->slots[fd] != 0) {
+            return &self->entries[self->slots[fd] - 1];
+        }
+        return NULL;
+    }
+    struct pollfd *entry = self->entries;
+    for (mp_uint_t i = 0; i < self->len; i++, entry++) {
+        if (entry->fd == fd) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+STATIC void poll_set_slot(mp_obj_poll_t *self, int fd, mp_uint_t slot) {
+    if (fd < 0 || fd >= POLL_SLOTS_MAX_FD) {
+        return;
+    }
+    if ((mp_uint_t)fd >= self->slots_len) {
+        mp_uint_t new_len = fd + 16;
+        self->slots = m_renew(mp_uint_t, self->slots, self->slots_len, new_len);
+        memset(self->slots + self->slots_len, 0, (new_len - self->slots_len) * sizeof(*self->slots));
+        self->slots_len = new_len;
+    }
+    self->slots[fd] = slot;
+}
+
+#if MICROPY_PY_USELECT_EPOLL
+
+STATIC void poll_epoll_stop(mp_obj_poll_t *self, int state) {
+    if (self->epfd >= 0) {
+        close(self->epfd);
+    }
+    self->epfd = state;
+}
+
+// Add, modify or delete the epoll registration of an entry.  The POLL*
+// flags have the same values as the EPOLL* ones.  If epoll can't watch the
+// fd, as for regular files, go back to poll(), which can.
+STATIC void poll_epoll_ctl(mp_obj_poll_t *self, int op, struct pollfd *entry) {
+    if (self->epfd < 0) {
+        return;
+    }
+    struct epoll_event ev;
+    ev.events = entry->events;
+    ev.data.u64 = (uint64_t)(entry - self->entries) << 32 | (uint32_t)entry->fd;
+    if (epoll_ctl(self->epfd, op, entry->fd, &ev) == -1) {
+        if (op == EPOLL_CTL_DEL) {
+            // the fd may have been closed already, which unregisters it
+            return;
+        }
+        if (op == EPOLL_CTL_MOD && errno == ENOENT
+            && epoll_ctl(self->epfd, EPOLL_CTL_ADD, entry->fd, &ev) == 0) {
+            return;
+        }
+        if (errno == EBADF || errno == ENOENT) {
+            // a closed fd, which poll_epoll_find_closed reports
+            return;
+        }
+        poll_epoll_stop(self, EPOLL_UNUSABLE);
+    }
+}
+
+// The kernel drops an fd from the epoll set when it's closed, while poll()
+// reports it with POLLNVAL.  Look for registered fds which were closed
+// before a wait would sleep, so that they are reported as by poll(), and
+// return how many were found.
+STATIC int poll_epoll_find_closed(mp_obj_poll_t *self) {
+    int n = 0;
+    struct pollfd *entry = self->entries;
+    for (mp_uint_t i = 0; i < self->len; i++, entry++) {
+        if (entry->fd != -1 && fcntl(entry->fd, F_GETFD) == -1 && errno == EBADF) {
+            struct epoll_event *ev = &self->ep_events[n++];
+            ev->events = POLLNVAL;
+            ev->data.u64 = (uint64_t)i << 32 | (uint32_t)entry->fd;
+        }
+    }
+    return n;
+}
+
+STATIC void poll_epoll_start(mp_obj_poll_t *self) {
+    self->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (self->epfd == -1) {
+        self->epfd = EPOLL_UNUSABLE;
+        return;
+    }
+    struct pollfd *entry = self->entries;
+    for (mp_uint_t i = 0; i < self->len && self->epfd >= 0; i++, entry++) {
+        if (entry->fd != -1) {
+            poll_epoll_ctl(self, EPOLL_CTL_ADD, entry);
+        }
+    }
+}
+
+#else
+
+#define poll_epoll_ctl(self, op, entry)
+
+#endif
+
 /// \method register(obj[, eventmask])
 STATIC mp_obj_t poll_register(size_t n_args, const mp_obj_t *args) {
     mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -84,17 +217,19 @@ STATIC mp_obj_t poll_register(size_t n_args, const mp_obj_t *args) {
         flags = POLLIN | POLLOUT;
     }
 
-    struct pollfd *free_slot = NULL;
+    struct pollfd *entry = poll_find(self, fd);
+    if (entry != NULL) {
+        entry->events = flags;
+        poll_epoll_ctl(self, EPOLL_CTL_MOD, entry);
+        return mp_const_false;
+    }
 
-    struct pollfd *entry = self->entries;
-    for (int i = 0; i < self->len; i++, entry++) {
-        int entry_fd = entry->fd;
-        if (entry_fd == fd) {
-            entry->events = flags;
-            return mp_const_false;
-        }
-        if (entry_fd == -1) {
+    struct pollfd *free_slot = NULL;
+    entry = self->entries;
+    for (mp_uint_t i = 0; i < self->len; i++, entry++) {
+        if (entry->fd == -1) {
             free_slot = entry;
+            break;
         }
     }
 
@@ -109,6 +244,15 @@ STATIC mp_obj_t poll_register(size_t n_args, const mp_obj_t *args) {
     free_slot->fd = fd;
     free_slot->events = flags;
     free_slot->revents = 0;
+    poll_set_slot(self, fd, free_slot - self->entries + 1);
+
+    #if MICROPY_PY_USELECT_EPOLL
+    if (self->epfd == EPOLL_NOT_STARTED && self->len > MICROPY_PY_USELECT_EPOLL_THRESHOLD) {
+        poll_epoll_start(self);
+    } else {
+        poll_epoll_ctl(self, EPOLL_CTL_ADD, free_slot);
+    }
+    #endif
     return mp_const_true;
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_register_obj, 2, 3, poll_register);
@@ -116,14 +260,13 @@ MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_register_obj, 2, 3, poll_register);
 /// \method unregister(obj)
 STATIC mp_obj_t poll_unregister(mp_obj_t self_in, mp_obj_t obj_in) {
     mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
-    struct pollfd *entries = self->entries;
     int fd = get_fd(obj_in);
-    for (int i = self->len - 1; i >= 0; i--) {
-        if (entries->fd == fd) {
-            entries->fd = -1;
-            break;
-        }
-        entries++;
+    struct pollfd *entry = poll_find(self, fd);
+    if (entry != NULL) {
+        poll_epoll_ctl(self, EPOLL_CTL_DEL, entry);
+        entry->fd = -1;
+        entry->revents = 0;
+        poll_set_slot(self, fd, 0);
     }
 
     // TODO raise KeyError if obj didn't exist in map
@@ -134,14 +277,10 @@ MP_DEFINE_CONST_FUN_OBJ_2(poll_unregister_obj, poll_unregister);
 /// \method modify(obj, eventmask)
 STATIC mp_obj_t poll_modify(mp_obj_t self_in, mp_obj_t obj_in, mp_obj_t eventmask_in) {
     mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
-    struct pollfd *entries = self->entries;
-    int fd = get_fd(obj_in);
-    for (int i = self->len - 1; i >= 0; i--) {
-        if (entries->fd == fd) {
-            entries->events = mp_obj_get_int(eventmask_in);
-            break;
-        }
-        entries++;
+    struct pollfd *entry = poll_find(self, get_fd(obj_in));
+    if (entry != NULL) {
+        entry->events = mp_obj_get_int(eventmask_in);
+        poll_epoll_ctl(self, EPOLL_CTL_MOD, entry);
     }
 
     // TODO raise KeyError if obj didn't exist in map
@@ -149,14 +288,14 @@ STATIC mp_obj_t poll_modify(mp_obj_t self_in, mp_obj_t obj_in, mp_obj_t eventmas
 }
 MP_DEFINE_CONST_FUN_OBJ_3(poll_modify_obj, poll_modify);
 
-/// \method poll([timeout])
-/// Timeout is in milliseconds.
-STATIC mp_obj_t poll_poll(size_t n_args, const mp_obj_t *args) {
+// Work out the timeout (it's given already in ms) and flags of poll or
+// ipoll, and wait.  Returns the number of ready fds, which are then
+// iterated by poll_iter_next.
+STATIC int poll_poll_internal(size_t n_args, const mp_obj_t *args) {
     mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
 
-    // work out timeout (it's given already in ms)
     int timeout = -1;
-    int flags = 0;
+    self->flags = 0;
     if (n_args >= 2) {
         if (args[1] != mp_const_none) {
             mp_int_t timeout_i = mp_obj_get_int(args[1]);
@@ -165,46 +304,158 @@ STATIC mp_obj_t poll_poll(size_t n_args, const mp_obj_t *args) {
             }
         }
         if (n_args >= 3) {
-            flags = mp_obj_get_int(args[2]);
+            self->flags = mp_obj_get_int(args[2]);
         }
     }
 
-    int n_ready = poll(self->entries, self->len, timeout);
+    self->iter_cnt = 0;
+    self->iter_idx = 0;
+
+    int n_ready;
+    #if MICROPY_PY_USELECT_EPOLL
+    self->iter_epoll = self->epfd >= 0;
+    if (self->epfd >= 0) {
+        if (self->ep_alloc < self->len) {
+            self->ep_events = m_renew(struct epoll_event, self->ep_events, self->ep_alloc, self->alloc);
+            self->ep_alloc = self->alloc;
+        }
+        // only look for closed fds, and then sleep, if nothing is ready
+        n_ready = epoll_wait(self->epfd, self->ep_events, self->ep_alloc, 0);
+        if (n_ready == 0) {
+            n_ready = poll_epoll_find_closed(self);
+            if (n_ready == 0 && timeout != 0) {
+                n_ready = epoll_wait(self->epfd, self->ep_events, self->ep_alloc, timeout);
+            }
+        }
+    } else
+    #endif
+    {
+        n_ready = poll(self->entries, self->len, timeout);
+    }
     RAISE_ERRNO(n_ready, errno);
+
+    self->iter_cnt = n_ready;
+    return n_ready;
+}
+
+// Get the next ready fd of the last wait and its events; returns false when
+// there are no more.  Entries unregistered meanwhile are skipped.
+STATIC bool poll_iter_next(mp_obj_poll_t *self, int *fd, int *revents) {
+    while (self->iter_cnt > 0) {
+        struct pollfd *entry;
+        #if MICROPY_PY_USELECT_EPOLL
+        if (self->iter_epoll) {
+            struct epoll_event *ev = &self->ep_events[self->iter_idx++];
+            self->iter_cnt--;
+            entry = &self->entries[ev->data.u64 >> 32];
+            if (entry->fd != (int)(uint32_t)ev->data.u64) {
+                continue;
+            }
+            *revents = ev->events;
+        } else
+        #endif
+        {
+            if (self->iter_idx >= self->len) {
+                break;
+            }
+            entry = &self->entries[self->iter_idx++];
+            if (entry->revents == 0) {
+                continue;
+            }
+            self->iter_cnt--;
+            if (entry->fd == -1) {
+                continue;
+            }
+            *revents = entry->revents;
+        }
+        *fd = entry->fd;
+        if (self->flags & FLAG_ONESHOT) {
+            entry->events = 0;
+            poll_epoll_ctl(self, EPOLL_CTL_MOD, entry);
+        }
+        return true;
+    }
+    self->iter_cnt = 0;
+    return false;
+}
+
+/// \method poll([timeout])
+/// Timeout is in milliseconds.
+STATIC mp_obj_t poll_poll(size_t n_args, const mp_obj_t *args) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    int n_ready = poll_poll_internal(n_args, args);
     if (n_ready == 0) {
         return mp_const_empty_tuple;
     }
 
     mp_obj_list_t *ret_list = MP_OBJ_TO_PTR(mp_obj_new_list(n_ready, NULL));
-    int ret_i = 0;
-    struct pollfd *entries = self->entries;
-    for (int i = 0; i < self->len; i++, entries++) {
-        if (entries->revents != 0) {
-            mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(2, NULL));
-            t->items[0] = MP_OBJ_NEW_SMALL_INT(entries->fd);
-            t->items[1] = MP_OBJ_NEW_SMALL_INT(entries->revents);
-            ret_list->items[ret_i++] = MP_OBJ_FROM_PTR(t);
-            if (flags & FLAG_ONESHOT) {
-                entries->events = 0;
-            }
-        }
+    int ret_i = 0, fd, revents;
+    while (poll_iter_next(self, &fd, &revents)) {
+        mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(2, NULL));
+        t->items[0] = MP_OBJ_NEW_SMALL_INT(fd);
+        t->items[1] = MP_OBJ_NEW_SMALL_INT(revents);
+        ret_list->items[ret_i++] = MP_OBJ_FROM_PTR(t);
     }
+    ret_list->len = ret_i;
 
     return MP_OBJ_FROM_PTR(ret_list);
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_poll_obj, 1, 3, poll_poll);
 
+/// \method ipoll([timeout[, flags]])
+/// Like poll, but returns an iterator which yields the same tuple each time,
+/// updated for the next ready fd, so nothing is allocated per call.
+STATIC mp_obj_t poll_ipoll(size_t n_args, const mp_obj_t *args) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    if (self->ret_tuple == MP_OBJ_NULL) {
+        self->ret_tuple = mp_obj_new_tuple(2, NULL);
+    }
+
+    poll_poll_internal(n_args, args);
+    return args[0];
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_ipoll_obj, 1, 3, poll_ipoll);
+
+STATIC mp_obj_t poll_iternext(mp_obj_t self_in) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
+    int fd, revents;
+    if (!poll_iter_next(self, &fd, &revents)) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    mp_obj_tuple_t *t = MP_OBJ_TO_PTR(self->ret_tuple);
+    t->items[0] = MP_OBJ_NEW_SMALL_INT(fd);
+    t->items[1] = MP_OBJ_NEW_SMALL_INT(revents);
+    return MP_OBJ_FROM_PTR(t);
+}
+
+#if MICROPY_PY_USELECT_EPOLL
+STATIC mp_obj_t poll_del(mp_obj_t self_in) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
+    poll_epoll_stop(self, EPOLL_UNUSABLE);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(poll_del_obj, poll_del);
+#endif
+
 STATIC const mp_rom_map_elem_t poll_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_register), MP_ROM_PTR(&poll_register_obj) },
     { MP_ROM_QSTR(MP_QSTR_unregister), MP_ROM_PTR(&poll_unregister_obj) },
     { MP_ROM_QSTR(MP_QSTR_modify), MP_ROM_PTR(&poll_modify_obj) },
     { MP_ROM_QSTR(MP_QSTR_poll), MP_ROM_PTR(&poll_poll_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ipoll), MP_ROM_PTR(&poll_ipoll_obj) },
+    #if MICROPY_PY_USELECT_EPOLL
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&poll_del_obj) },
+    #endif
 };
 STATIC MP_DEFINE_CONST_DICT(poll_locals_dict, poll_locals_dict_table);
 
 STATIC const mp_obj_type_t mp_type_poll = {
     { &mp_type_type },
     .name = MP_QSTR_poll,
+    .getiter = mp_identity,
+    .iternext = poll_iternext,
     .locals_dict = (void*)&poll_locals_dict,
 };
 
@@ -213,11 +464,26 @@ STATIC mp_obj_t select_poll(size_t n_args, const mp_obj_t *args) {
     if (n_args > 0) {
         alloc = mp_obj_get_int(args[0]);
     }
+    #if MICROPY_PY_USELECT_EPOLL
+    // the finaliser closes the epoll fd
+    mp_obj_poll_t *poll = m_new_obj_with_finaliser(mp_obj_poll_t);
+    poll->epfd = EPOLL_NOT_STARTED;
+    poll->ep_alloc = 0;
+    poll->ep_events = NULL;
+    poll->iter_epoll = false;
+    #else
     mp_obj_poll_t *poll = m_new_obj(mp_obj_poll_t);
+    #endif
     poll->base.type = &mp_type_poll;
     poll->entries = m_new(struct pollfd, alloc);
     poll->alloc = alloc;
     poll->len = 0;
+    poll->slots = NULL;
+    poll->slots_len = 0;
+    poll->iter_cnt = 0;
+    poll->iter_idx = 0;
+    poll->flags = 0;
+    poll->ret_tuple = MP_OBJ_NULL;
     return MP_OBJ_FROM_PTR(poll);
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_select_poll_obj, 0, 1, select_poll);